@@ -0,0 +1,82 @@
+/*
+  Common helpers for benchmarks.
+ */
+#ifndef GOB_JSON_BENCH_COMMON_HPP
+#define GOB_JSON_BENCH_COMMON_HPP
+
+#include <gob_json.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+
+namespace bench {
+
+using goblib::json::ElementPath;
+using goblib::json::ElementValue;
+
+// Handler that does nothing. (Measure the parser and the source only)
+struct NullHandler : public goblib::json::Handler
+{
+    virtual void startDocument() override {}
+    virtual void endDocument() override {}
+    virtual void startObject(const ElementPath& ) override {}
+    virtual void endObject(const ElementPath& ) override {}
+    virtual void startArray(const ElementPath& ) override {}
+    virtual void endArray(const ElementPath& ) override {}
+    virtual void value(const ElementPath& , const ElementValue& ) override {}
+    virtual void whitespace(const char/*ch*/) override {}
+};
+
+// Size from environment variable in MiB.
+inline size_t envMiB(const char* name, const size_t def)
+{
+    auto s = std::getenv(name);
+    return (s && *s) ? static_cast<size_t>(std::strtoul(s, nullptr, 10)) : def;
+}
+
+// Array of records until the size reaches bytes.
+inline std::string makeRecords(const size_t bytes)
+{
+    std::string s("[");
+    s.reserve(bytes + 256);
+    for(unsigned i = 0; s.size() < bytes; ++i)
+    {
+        if(i) { s += ','; }
+        s += R"({"id":)" + std::to_string(i) + R"(,"name":"item)" + std::to_string(i)
+                + R"(","price":)" + std::to_string(i % 1000) + R"(.25,"tags":["a","b"],"active":true})";
+    }
+    s += ']';
+    return s;
+}
+
+// Temporary file removed on destruction.
+class TempFile
+{
+  public:
+    explicit TempFile(const size_t bytes)
+    {
+        char tmp[] = "/tmp/gob_json_benchXXXXXX";
+        int fd = mkstemp(tmp);
+        if(fd < 0) { return; }
+        path = tmp;
+        // Write by block to generate multi-GB files without holding them in memory.
+        auto block = makeRecords(1024 * 1024);
+        block.front() = ' ';
+        block.back() = ',';
+        bool ok = (::write(fd, "[", 1) == 1);
+        for(size_t written = 1; ok && written + block.size() < bytes; written += block.size())
+        {
+            ok = (::write(fd, block.data(), block.size()) == (ssize_t)block.size());
+        }
+        ok = ok && ::write(fd, "null]", 5) == 5;
+        ::close(fd);
+        if(!ok) { unlink(path.c_str()); path.clear(); }
+    }
+    ~TempFile() { if(!path.empty()) { unlink(path.c_str()); } }
+
+    std::string path;
+};
+
+}
+#endif
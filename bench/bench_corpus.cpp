@@ -0,0 +1,355 @@
+/*
+  Corpus throughput. Reports bytes/s and events/s.
+
+  Corpora
+  - Standard: twitter.json, canada.json, citm_catalog.json, gsoc-2018.json
+    Loaded from GOB_JSON_BENCH_CORPUS_DIR (default bench/data), skipped if not exists.
+  - Synthetic: records, deep nesting (GOB_JSON_PARSER_STACK_MAX_DEPTH), long strings (GOB_JSON_PARSER_BUFFER_MAX_LENGTH)
+
+  Handlers
+  - Raw: counts events only
+  - Element: binds to Element table
+  - Delegate: DelegateHandler with pooled delegaters
+  - Validate: StreamingParser::validate (no handler)
+  - Minify / Pretty: StreamingFormatter to a sink that discards the output
+
+  Reference points if the headers are available
+  - nlohmann/json (DOM and SAX)
+  - ArduinoJson (DOM)
+  - json-streaming-parser2 (The original of this library)
+ */
+#include <benchmark/benchmark.h>
+#include <gob_json.hpp>
+#include <gob_json_element.hpp>
+#include <gob_json_delegate_handler.hpp>
+#include <gob_json_formatter.hpp>
+#include "bench_common.hpp"
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <utility>
+
+#if defined(__has_include)
+# if __has_include(<nlohmann/json.hpp>)
+#   include <nlohmann/json.hpp>
+#   define BENCH_NLOHMANN 1
+# endif
+# if __has_include(<ArduinoJson.h>)
+#   include <ArduinoJson.h>
+#   define BENCH_ARDUINOJSON 1
+# endif
+# if __has_include(<JsonStreamingParser2.h>)
+#   include <JsonStreamingParser2.h>
+#   define BENCH_ORIGINAL 1
+# endif
+#endif
+
+using goblib::json::ElementPath;
+using goblib::json::ElementValue;
+using goblib::json::Element;
+using goblib::json::ElementBase;
+
+namespace
+{
+// ----------------------------------------------------------------------------
+// Corpora
+std::string loadFile(const std::string& path)
+{
+    std::ifstream ifs(path, std::ios::binary);
+    if(!ifs) { return std::string(); }
+    std::ostringstream oss;
+    oss << ifs.rdbuf();
+    return oss.str();
+}
+
+std::string makeDeep(const size_t bytes)
+{
+    // Leaf numbers do not use the stack, so nesting can reach the max depth.
+    const int depth = GOB_JSON_PARSER_STACK_MAX_DEPTH - 1;
+    std::string unit;
+    for(int i = 1; i < depth; ++i) { unit += '['; }
+    unit += "1,2";
+    for(int i = 1; i < depth; ++i) { unit += ']'; }
+    std::string s("[");
+    while(s.size() < bytes) { s += unit; s += ','; }
+    s.back() = ']';
+    return s;
+}
+
+std::string makeLongStrings(const size_t bytes)
+{
+    // Longest strings that fit in the token buffer, with some escapes.
+    const size_t len = GOB_JSON_PARSER_BUFFER_MAX_LENGTH - 8;
+    std::string str;
+    for(size_t i = 0; str.size() < len; ++i) { str += (i % 64 == 63) ? "\\n" : std::string(1, 'a' + i % 26); }
+    std::string s("[");
+    while(s.size() < bytes) { s += '"' + str + "\","; }
+    s.back() = ']';
+    return s;
+}
+
+std::string makeEscapedStrings(const size_t bytes)
+{
+    // Japanese text from ASCII-only encoders, every character as \uXXXX and some surrogate pairs.
+    const char* units[] = { "\\u543e", "\\u8f29", "\\u306f", "\\u732b", "\\u3067", "\\u3042", "\\u308b", "\\u3002", "\\ud83d\\ude3a" };
+    std::string str;
+    for(size_t i = 0; str.size() < GOB_JSON_PARSER_BUFFER_MAX_LENGTH; ++i) { str += units[i % 9]; }
+    std::string s("[");
+    while(s.size() < bytes) { s += "{\"text\":\"" + str + "\"},"; }
+    s.back() = ']';
+    return s;
+}
+
+using Corpus = std::pair<std::string, std::string>; // name, data
+const std::vector<Corpus>& corpora()
+{
+    static std::vector<Corpus> v;
+    if(!v.empty()) { return v; }
+    auto dir = std::getenv("GOB_JSON_BENCH_CORPUS_DIR");
+    std::string base = (dir && *dir) ? dir : "bench/data";
+    for(auto name : { "twitter.json", "canada.json", "citm_catalog.json", "gsoc-2018.json" })
+    {
+        auto data = loadFile(base + "/" + name);
+        if(!data.empty()) { v.emplace_back(name, std::move(data)); }
+    }
+    const size_t sz = bench::envMiB("GOB_JSON_BENCH_SYNTHETIC_MIB", 4) * 1024 * 1024;
+    v.emplace_back("records", bench::makeRecords(sz));
+    v.emplace_back("deep", makeDeep(sz));
+    v.emplace_back("long_string", makeLongStrings(sz));
+    v.emplace_back("escaped_string", makeEscapedStrings(sz));
+    return v;
+}
+
+// ----------------------------------------------------------------------------
+// Handlers
+struct RawHandler : public goblib::json::Handler
+{
+    virtual void startDocument() override { ++events; }
+    virtual void endDocument() override { ++events; }
+    virtual void startObject(const ElementPath& ) override { ++events; }
+    virtual void endObject(const ElementPath& ) override { ++events; }
+    virtual void startArray(const ElementPath& ) override { ++events; }
+    virtual void endArray(const ElementPath& ) override { ++events; }
+    virtual void value(const ElementPath& , const ElementValue& ) override { ++events; }
+    virtual void whitespace(const char) override {}
+    size_t events{};
+};
+
+// Binds record members (bench::makeRecords), other keys are looked up and ignored.
+struct ElementHandler : public RawHandler
+{
+    virtual void value(const ElementPath& path, const ElementValue& value) override
+    {
+        ++events;
+        Element<decltype(id)>     e_id     { "id", &id };
+        Element<decltype(name)>   e_name   { "name", &name };
+        Element<decltype(price)>  e_price  { "price", &price };
+        Element<decltype(tags)>   e_tags   { "tags", &tags };
+        Element<decltype(active)> e_active { "active", &active };
+        ElementBase* tbl[] = { &e_id, &e_name, &e_price, &e_tags, &e_active };
+        const char* key = path.getIndex() < 0 ? path.getKey() : (path.getParent() ? path.getParent()->getKey() : "");
+        for(auto& e : tbl) { if(*e == key) { e->store(value, path.getIndex()); return; } }
+    }
+    virtual void startObject(const ElementPath& ) override { ++events; tags.clear(); }
+
+    uint64_t id{};
+    char name[32]{};
+    float price{};
+    std::vector<goblib::json::string_t> tags;
+    bool active{};
+};
+
+// Delegater per object in pool
+struct DelegateBenchHandler : public goblib::json::DelegateHandler
+{
+    struct ObjectDelegater : Delegater
+    {
+        explicit ObjectDelegater(DelegateBenchHandler& h) : _h(h) {}
+        virtual Delegater* startObject(const ElementPath& ) override { return _h.create(); }
+        DelegateBenchHandler& _h;
+    };
+    Delegater* create()
+    {
+        ++events;
+        return pool.available() ? static_cast<Delegater*>(pool.create(*this)) : Delegater::ignore();
+    }
+    virtual void startObject(const ElementPath& path) override
+    {
+        if(path.getCount() == 0) { pushDelegater(create()); return; }
+        DelegateHandler::startObject(path);
+    }
+    virtual void endObject(const ElementPath& path) override { ++events; DelegateHandler::endObject(path); }
+    virtual void startArray(const ElementPath& path) override { ++events; DelegateHandler::startArray(path); }
+    virtual void endArray(const ElementPath& path) override { ++events; DelegateHandler::endArray(path); }
+    virtual void value(const ElementPath& path, const ElementValue& value) override
+    {
+        ++events;
+        DelegateHandler::value(path, value);
+    }
+    goblib::json::DelegaterPool<ObjectDelegater, GOB_JSON_PARSER_STACK_MAX_DEPTH> pool;
+    size_t events{};
+};
+
+// ----------------------------------------------------------------------------
+template<class H> void BM_Parse(benchmark::State& state, const Corpus* corpus)
+{
+    const auto& data = corpus->second;
+    H handler;
+    goblib::json::StreamingParser parser(&handler);
+    for(auto _ : state)
+    {
+        parser.reset();
+        parser.parse(data.data(), data.size());
+        if(parser.hasError()) { state.SkipWithError("parse error"); break; }
+    }
+    state.SetBytesProcessed(state.iterations() * data.size());
+    state.counters["events"] = benchmark::Counter(handler.events, benchmark::Counter::kIsRate);
+}
+
+// Grammar only (StreamingParser::validate)
+void BM_Validate(benchmark::State& state, const Corpus* corpus)
+{
+    const auto& data = corpus->second;
+    for(auto _ : state)
+    {
+        if(!goblib::json::StreamingParser::validate(data.data(), data.size())) { state.SkipWithError("invalid"); break; }
+    }
+    state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+// Reformat only (StreamingFormatter)
+template<goblib::json::FormatStyle Style> void BM_Format(benchmark::State& state, const Corpus* corpus)
+{
+    struct NullSink : goblib::json::Sink
+    {
+        virtual bool write(const char*, size_t len) override { written += len; return true; }
+        size_t written{};
+    } sink;
+    const auto& data = corpus->second;
+    goblib::json::StreamingFormatter fmt(Style, &sink);
+    for(auto _ : state)
+    {
+        fmt.reset();
+        fmt.parse(data.data(), data.size());
+        if(!fmt.flush()) { state.SkipWithError("format error"); break; }
+    }
+    state.SetBytesProcessed(state.iterations() * data.size());
+    benchmark::DoNotOptimize(sink.written);
+}
+
+#if defined(BENCH_NLOHMANN)
+struct NlohmannSax : nlohmann::json_sax<nlohmann::json>
+{
+    bool null() override { ++events; return true; }
+    bool boolean(bool) override { ++events; return true; }
+    bool number_integer(number_integer_t) override { ++events; return true; }
+    bool number_unsigned(number_unsigned_t) override { ++events; return true; }
+    bool number_float(number_float_t, const string_t&) override { ++events; return true; }
+    bool string(string_t&) override { ++events; return true; }
+    bool binary(binary_t&) override { ++events; return true; }
+    bool start_object(std::size_t) override { ++events; return true; }
+    bool key(string_t&) override { return true; }
+    bool end_object() override { ++events; return true; }
+    bool start_array(std::size_t) override { ++events; return true; }
+    bool end_array() override { ++events; return true; }
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception&) override { return false; }
+    size_t events{};
+};
+void BM_NlohmannDom(benchmark::State& state, const Corpus* corpus)
+{
+    const auto& data = corpus->second;
+    for(auto _ : state)
+    {
+        auto j = nlohmann::json::parse(data, nullptr, false);
+        benchmark::DoNotOptimize(j);
+    }
+    state.SetBytesProcessed(state.iterations() * data.size());
+}
+void BM_NlohmannSax(benchmark::State& state, const Corpus* corpus)
+{
+    const auto& data = corpus->second;
+    NlohmannSax sax;
+    for(auto _ : state) { nlohmann::json::sax_parse(data, &sax); }
+    state.SetBytesProcessed(state.iterations() * data.size());
+    state.counters["events"] = benchmark::Counter(sax.events, benchmark::Counter::kIsRate);
+}
+#endif
+
+#if defined(BENCH_ARDUINOJSON)
+void BM_ArduinoJson(benchmark::State& state, const Corpus* corpus)
+{
+    const auto& data = corpus->second;
+    for(auto _ : state)
+    {
+# if ARDUINOJSON_VERSION_MAJOR >= 7
+        JsonDocument doc;
+# else
+        DynamicJsonDocument doc(data.size() * 4);
+# endif
+        auto err = deserializeJson(doc, data.data(), data.size(), DeserializationOption::NestingLimit(64));
+        benchmark::DoNotOptimize(err);
+    }
+    state.SetBytesProcessed(state.iterations() * data.size());
+}
+#endif
+
+#if defined(BENCH_ORIGINAL)
+struct OriginalHandler : public JsonHandler
+{
+    void startDocument() override { ++events; }
+    void endDocument() override { ++events; }
+    void startObject(ElementPath) override { ++events; }
+    void endObject(ElementPath) override { ++events; }
+    void startArray(ElementPath) override { ++events; }
+    void endArray(ElementPath) override { ++events; }
+    void value(ElementPath, ElementValue) override { ++events; }
+    void whitespace(char) override {}
+    size_t events{};
+};
+void BM_Original(benchmark::State& state, const Corpus* corpus)
+{
+    const auto& data = corpus->second;
+    OriginalHandler handler;
+    JsonStreamingParser parser;
+    parser.setHandler(&handler);
+    for(auto _ : state)
+    {
+        parser.reset();
+        for(auto c : data) { parser.parse(c); }
+    }
+    state.SetBytesProcessed(state.iterations() * data.size());
+    state.counters["events"] = benchmark::Counter(handler.events, benchmark::Counter::kIsRate);
+}
+#endif
+
+int registerAll()
+{
+    for(auto& c : corpora())
+    {
+        auto reg = [&c](const char* kind, void(*fn)(benchmark::State&, const Corpus*))
+        {
+            benchmark::RegisterBenchmark((std::string(kind) + "/" + c.first).c_str(), fn, &c)->Unit(benchmark::kMillisecond);
+        };
+        reg("gob_json_raw", BM_Parse<RawHandler>);
+        reg("gob_json_element", BM_Parse<ElementHandler>);
+        reg("gob_json_delegate", BM_Parse<DelegateBenchHandler>);
+        reg("gob_json_validate", BM_Validate);
+        reg("gob_json_minify", BM_Format<goblib::json::FormatStyle::Minify>);
+        reg("gob_json_pretty", BM_Format<goblib::json::FormatStyle::Pretty>);
+#if defined(BENCH_NLOHMANN)
+        reg("nlohmann_dom", BM_NlohmannDom);
+        reg("nlohmann_sax", BM_NlohmannSax);
+#endif
+#if defined(BENCH_ARDUINOJSON)
+        reg("arduinojson", BM_ArduinoJson);
+#endif
+#if defined(BENCH_ORIGINAL)
+        reg("json_streaming_parser2", BM_Original);
+#endif
+    }
+    return 0;
+}
+const int registered = registerAll();
+//
+}
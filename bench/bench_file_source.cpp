@@ -0,0 +1,61 @@
+/*
+  MappedFileSource vs read() loop.
+  File size: GOB_JSON_BENCH_FILE_MIB (default 256). Use e.g. 4096 for multi-GB input.
+ */
+#include <benchmark/benchmark.h>
+#include <gob_json_file_source.hpp>
+#include "bench_common.hpp"
+#include <fcntl.h>
+#include <vector>
+
+namespace
+{
+const bench::TempFile& file()
+{
+    static bench::TempFile f(bench::envMiB("GOB_JSON_BENCH_FILE_MIB", 256) * 1024 * 1024);
+    return f;
+}
+
+void BM_ReadLoop(benchmark::State& state)
+{
+    std::vector<char> buf(state.range(0));
+    bench::NullHandler handler;
+    goblib::json::StreamingParser parser(&handler);
+    size_t total{};
+    for(auto _ : state)
+    {
+        int fd = ::open(file().path.c_str(), O_RDONLY);
+        if(fd < 0) { state.SkipWithError("open"); break; }
+        parser.reset();
+        ssize_t sz;
+        while((sz = ::read(fd, buf.data(), buf.size())) > 0)
+        {
+            parser.parse(buf.data(), sz);
+            total += sz;
+        }
+        ::close(fd);
+    }
+    state.SetBytesProcessed(total);
+}
+BENCHMARK(BM_ReadLoop)->Arg(4096)->Arg(64 * 1024)->Arg(1024 * 1024)->Unit(benchmark::kMillisecond);
+
+void BM_MappedFile(benchmark::State& state)
+{
+    bench::NullHandler handler;
+    goblib::json::StreamingParser parser(&handler);
+    goblib::json::MappedFileSource src(state.range(0) * 1024 * 1024);
+    src.setHugePages(state.range(1) != 0);
+    size_t total{};
+    for(auto _ : state)
+    {
+        if(!src.open(file().path.c_str())) { state.SkipWithError("open"); break; }
+        parser.reset();
+        src.parse(parser);
+        total += src.size();
+        src.close();
+    }
+    state.SetBytesProcessed(total);
+}
+BENCHMARK(BM_MappedFile)->Args({64, 0})->Args({256, 0})->Args({256, 1})->Unit(benchmark::kMillisecond);
+//
+}
@@ -0,0 +1,8 @@
+/*
+  Benchmarks for native build.
+  pio run -e native_bench -t exec
+  or ./program --benchmark_filter=<regex>
+ */
+#include <benchmark/benchmark.h>
+
+BENCHMARK_MAIN();
@@ -0,0 +1,67 @@
+/*
+  PipelineHandler vs direct handler with expensive work per value.
+  Arg: work per value (iterations of hashing)
+ */
+#include <benchmark/benchmark.h>
+#include <gob_json_pipeline_handler.hpp>
+#include "bench_common.hpp"
+
+namespace
+{
+const std::string& input()
+{
+    static std::string s = bench::makeRecords(1024 * 1024);
+    return s;
+}
+
+// Stand-in for DB writes, compression...
+struct ExpensiveHandler : public bench::NullHandler
+{
+    explicit ExpensiveHandler(const int w) : work(w) {}
+    virtual void value(const bench::ElementPath& , const bench::ElementValue& v) override
+    {
+        uint64_t h = hash;
+        const char* s = v.isString() ? v.getString() : (v.hasRaw() ? v.getRaw() : "");
+        for(int i = 0; i < work; ++i)
+        {
+            for(const char* p = s; *p; ++p) { h = (h ^ (uint8_t)*p) * 0x100000001b3ULL; }
+        }
+        hash = h;
+    }
+    int work{};
+    uint64_t hash{0xcbf29ce484222325ULL};
+};
+
+void BM_Direct(benchmark::State& state)
+{
+    ExpensiveHandler handler(state.range(0));
+    goblib::json::StreamingParser parser(&handler);
+    for(auto _ : state)
+    {
+        parser.reset();
+        parser.parse(input().data(), input().size());
+    }
+    benchmark::DoNotOptimize(handler.hash);
+    state.SetBytesProcessed(state.iterations() * input().size());
+}
+BENCHMARK(BM_Direct)->Arg(0)->Arg(8)->Arg(32)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+void BM_Pipeline(benchmark::State& state)
+{
+    ExpensiveHandler handler(state.range(0));
+    goblib::json::PipelineHandler pipe(&handler, state.range(1));
+    goblib::json::StreamingParser parser(&pipe);
+    for(auto _ : state)
+    {
+        parser.reset();
+        parser.parse(input().data(), input().size());
+        pipe.drain();
+    }
+    benchmark::DoNotOptimize(handler.hash);
+    state.SetBytesProcessed(state.iterations() * input().size());
+    state.counters["stalls"] = pipe.getStallCount();
+}
+BENCHMARK(BM_Pipeline)->Args({0, 16 * 1024})->Args({8, 16 * 1024})->Args({32, 16 * 1024})->Args({32, 256 * 1024})
+->Unit(benchmark::kMillisecond)->UseRealTime();
+//
+}
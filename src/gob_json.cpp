@@ -4,12 +4,71 @@
  */
 #include "gob_json.hpp"
 #include "internal/gob_json_log.hpp"
+#include "internal/gob_json_swar.hpp"
+#if GOB_JSON_STATS
+#include "internal/gob_json_stats.hpp"
+#endif
 #include <cstring>
 #include <cassert>
 #include <algorithm>
 #include <cmath>
 #include <cinttypes> 
 
+namespace
+{
+// Hex digit value, 0xFF if not a hex digit
+constexpr uint8_t X = 0xFF;
+constexpr uint8_t hexTable[256] =
+{
+    X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,X, X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,
+    X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,X, 0,1,2,3,4,5,6,7,8,9,X,X,X,X,X,X,
+    X,10,11,12,13,14,15,X,X,X,X,X,X,X,X,X, X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,
+    X,10,11,12,13,14,15,X,X,X,X,X,X,X,X,X, X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,
+    X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,X, X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,
+    X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,X, X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,
+    X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,X, X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,
+    X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,X, X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,
+};
+
+// 4 hex digits to the value, -1 if any of them is not a hex digit
+inline int32_t hex4(const char* p)
+{
+    const uint8_t a = hexTable[(uint8_t)p[0]], b = hexTable[(uint8_t)p[1]];
+    const uint8_t c = hexTable[(uint8_t)p[2]], d = hexTable[(uint8_t)p[3]];
+    if((a | b | c | d) & 0xF0) { return -1; }
+    return (a << 12) | (b << 8) | (c << 4) | d;
+}
+
+// Escaped character of the 2 character escape sequences, 0 if not one of them
+inline char simpleEscape(const char c)
+{
+    switch(c)
+    {
+    case '"': case '\\': case '/': return c;
+    case 'b': return 0x08;
+    case 'f': return '\f';
+    case 'n': return '\n';
+    case 'r': return '\r';
+    case 't': return '\t';
+    default:  return 0;
+    }
+}
+
+// UTF-32 to UTF-8, returns the length
+inline uint8_t toUtf8(uint32_t cp, char* out)
+{
+    if(cp < 0x80)    { out[0] = (char)cp; return 1; }
+    if(cp < 0x800)   { out[0] = (char)(0xC0 | (cp >> 6));  out[1] = (char)(0x80 | (cp & 0x3F)); return 2; }
+    if(cp < 0x10000) { out[0] = (char)(0xE0 | (cp >> 12)); out[1] = (char)(0x80 | ((cp >> 6) & 0x3F)); out[2] = (char)(0x80 | (cp & 0x3F)); return 3; }
+    out[0] = (char)(0xF0 | (cp >> 18));
+    out[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (cp & 0x3F));
+    return 4;
+}
+//
+}
+
 namespace goblib { namespace json {
 
 // Size of array.
@@ -24,12 +83,61 @@ void StreamingParser::reset()
     unicodeBufferPos = 0;
     characterCounter = 0;
     stackPos = 0;
+    path = ElementPath{};
+    if(activeSink) { activeSink->clear(); } // Partial batch of the abandoned array
+    activeSink = nullptr;
+    utf8.reset();
+}
+
+bool StreamingParser::addNumberSink(const char* pattern, NumberSink* sink)
+{
+    assert(pattern && sink);
+    for(auto& b : numberSinks)
+    {
+        if(!b.sink) { b.pattern = pattern; b.sink = sink; return true; }
+    }
+    GOB_JSON_LOGE("No room for number sink [%s]", pattern);
+    return false;
 }
 
+void StreamingParser::clearNumberSinks()
+{
+    for(auto& b : numberSinks) { b = NumberSinkBinding{}; }
+    activeSink = nullptr;
+}
+
+#if GOB_JSON_STATS
+# define GOB_JSON_STAT(expr) do { expr; } while(0)
+// Call the handler with counting and timing.
+# define GOB_JSON_DISPATCH(ev, call) \
+do \
+{ \
+    const auto t0_ = stats::ticks(); \
+    call; \
+    stats.handlerTicks += stats::elapsed(t0_, stats::ticks()); \
+    ++stats.events[ParserStats::ev]; \
+}while(0)
+
+const char* StreamingParser::getStateName(const size_t index)
+{
+    static constexpr const char* names[ParserStats::STATE_MAX] =
+    {
+        "ERROR", "DONE", "START_DOCUMENT", "IN_ARRAY", "IN_OBJECT", "END_KEY", "AFTER_KEY", "IN_STRING",
+        "START_ESCAPE", "UNICODE", "IN_NUMBER", "IN_TRUE", "IN_FALSE", "IN_NULL", "AFTER_VALUE", "UNICODE_SURROGATE",
+    };
+    static_assert((int)State::UNICODE_SURROGATE + 2 == ParserStats::STATE_MAX, "Mismatch number of states");
+    return index < ParserStats::STATE_MAX ? names[index] : "?";
+}
+#else
+# define GOB_JSON_STAT(expr) do {} while(0)
+# define GOB_JSON_DISPATCH(ev, call) call
+#endif
+
 #define PARSE_ERROR(estr, ch, pos, path) \
 do \
 {  \
     GOB_JSON_LOGE("%s at <%c>:0x%x pos:%zu [%s]", estr, ch, ch, pos, path.toString().c_str()); \
+    if(activeSink) { activeSink->flush(); activeSink = nullptr; } \
     state = State::ERROR; \
 }while(0)
 
@@ -39,6 +147,7 @@ void StreamingParser::parse(const char ch)
     if(!handler || state == State::ERROR) { return; }
 
     const int c = curCh = std::is_signed<char>::value ? (unsigned char)ch : ch; // Handling the case where char is signed.
+    GOB_JSON_STAT(++stats.bytes[(int)state + 1]);
 
     //GOB_JSON_LOGI("stack[%d]:%d <%c>0x%x", stackPos, (stackPos > 0) ? (int)stack[stackPos-1] : -1, ch, ch);
 
@@ -48,11 +157,16 @@ void StreamingParser::parse(const char ch)
     // http://stackoverflow.com/questions/16042274/definition-of-whitespace-in-json
     if ((c == ' ' || c == '\t' || c == '\n' || c == '\r')
         && !(state == State::IN_STRING || state == State::UNICODE || state == State::START_ESCAPE || state == State::IN_NUMBER)) {
+        if (doEmitWhitespace) { GOB_JSON_DISPATCH(Whitespace, handler->whitespace(ch)); }
         return;
     }
 
     switch (state) {
     case State::IN_STRING:
+        if (utf8Check && (c < 0x80 ? !utf8.complete() : !utf8.step(c))) {
+            PARSE_ERROR("Invalid UTF-8 sequence", c, characterCounter, path);
+            break;
+        }
         if (c == '"') {
             endString();
         } else if (c == '\\') {
@@ -183,7 +297,9 @@ void StreamingParser::parse(const char ch)
         } else {
             endNumber();
             // we have consumed one beyond the end of the number
+            GOB_JSON_STAT(--stats.bytes[(int)State::IN_NUMBER + 1]);
             parse(c);
+            return; // Counted by the call above
         }
         break;
     case State::IN_TRUE:
@@ -209,10 +325,10 @@ void StreamingParser::parse(const char ch)
         break;
     case State::START_DOCUMENT:
         if (c == '[') {
-            handler->startDocument();
+            GOB_JSON_DISPATCH(StartDocument, handler->startDocument());
             startArray();
         } else if (c == '{') {
-            handler->startDocument();
+            GOB_JSON_DISPATCH(StartDocument, handler->startDocument());
             startObject();
         } else {
             // throw new ParsingError($this->_line_number,
@@ -231,7 +347,124 @@ void StreamingParser::parse(const char ch)
     characterCounter++;
 }
 
+// Append to the token buffer, truncated as increaseBufferPointer
+inline void StreamingParser::appendBuffer(const char* s, const size_t len)
+{
+#if GOB_JSON_STATS
+    if(bufferPos == 0) { truncating = false; } // New token
+    if((size_t)bufferPos + len >= sizeof(buffer) && !truncating) { ++stats.truncatedTokens; truncating = true; }
+    stats.bufferHighWater = std::max(stats.bufferHighWater, (int)std::min((size_t)bufferPos + len, sizeof(buffer)));
+#endif
+    const size_t room = sizeof(buffer) - 1 - bufferPos;
+    if(len <= room)
+    {
+        std::memcpy(buffer + bufferPos, s, len);
+        bufferPos += len;
+    }
+    else
+    {
+        std::memcpy(buffer + bufferPos, s, room);
+        bufferPos += room;
+        buffer[bufferPos] = s[len - 1];
+    }
+}
+
+void StreamingParser::parse(const char* buf, size_t len)
+{
+    const char* e = buf + len;
+    while(buf < e)
+    {
+        // Runs of plain string characters are copied at once.
+        if(state == State::IN_STRING)
+        {
+            auto p = swar::findSpecial<true>(buf, e);
+            if(p != buf)
+            {
+                appendString(buf, p - buf);
+                if(hasError()) { return; }
+                buf = p;
+                continue;
+            }
+            // Whole escape sequences are decoded at once.
+            if(*buf == '\\')
+            {
+                auto n = decodeEscape(buf, e);
+                if(n) { buf += n; continue; }
+            }
+        }
+        parse(*buf++);
+    }
+}
+
+// Same as parse() for each character in IN_STRING that is not special
+void StreamingParser::appendString(const char* s, const size_t len)
+{
+    if(utf8Check)
+    {
+        auto p = utf8.validate(s, s + len);
+        if(p != s + len)
+        {
+            characterCounter += p - s;
+            PARSE_ERROR("Invalid UTF-8 sequence", (uint8_t)*p, characterCounter, path);
+            return;
+        }
+    }
+    GOB_JSON_STAT(stats.bytes[(int)State::IN_STRING + 1] += len);
+    appendBuffer(s, len);
+    curCh = (uint8_t)s[len - 1];
+    characterCounter += len;
+}
+
+// Same as parse() for each character of the escape sequence at p
+// Returns the length of the sequence, or 0 if it is left to parse(char)
+// (incomplete in the chunk, invalid, or a lone surrogate)
+size_t StreamingParser::decodeEscape(const char* p, const char* e)
+{
+    if(e - p < 2 || (utf8Check && !utf8.complete())) { return 0; }
+    if(p[1] != 'u')
+    {
+        const char c = simpleEscape(p[1]);
+        if(!c) { return 0; }
+        GOB_JSON_STAT(++stats.bytes[(int)State::IN_STRING + 1]);
+        GOB_JSON_STAT(++stats.bytes[(int)State::START_ESCAPE + 1]);
+        appendBuffer(&c, 1);
+        curCh = (uint8_t)p[1];
+        characterCounter += 2;
+        return 2;
+    }
+
+    if(e - p < 6) { return 0; }
+    int32_t cp = hex4(p + 2);
+    if(cp < 0) { return 0; }
+    size_t n = 6;
+    if(cp >= 0xD800 && cp < 0xDC00)
+    {
+        // Surrogate pair
+        if(e - p < 12 || p[6] != '\\' || p[7] != 'u') { return 0; }
+        const int32_t low = hex4(p + 8);
+        if(low < 0xDC00 || low >= 0xE000) { return 0; }
+        cp = ((cp - 0xD800) << 10) + (low - 0xDC00) + 0x10000;
+        n = 12;
+        GOB_JSON_STAT(stats.bytes[(int)State::UNICODE_SURROGATE + 1] += 2);
+        GOB_JSON_STAT(stats.bytes[(int)State::UNICODE + 1] += 4);
+    }
+    GOB_JSON_STAT(++stats.bytes[(int)State::IN_STRING + 1]);
+    GOB_JSON_STAT(++stats.bytes[(int)State::START_ESCAPE + 1]);
+    GOB_JSON_STAT(stats.bytes[(int)State::UNICODE + 1] += 4);
+
+    char u8[4];
+    appendBuffer(u8, toUtf8(cp, u8));
+    curCh = (uint8_t)p[n - 1];
+    characterCounter += n;
+    return n;
+}
+
 void StreamingParser::increaseBufferPointer() {
+#if GOB_JSON_STATS
+    if(bufferPos == 0) { truncating = false; } // New token
+    if((size_t)bufferPos + 1 >= sizeof(buffer) && !truncating) { ++stats.truncatedTokens; truncating = true; }
+    stats.bufferHighWater = std::max(stats.bufferHighWater, bufferPos + 1);
+#endif
     bufferPos = std::min((size_t)bufferPos + 1, sizeof(buffer) - 1);
 }
 
@@ -245,11 +478,13 @@ void StreamingParser::endString() {
     stackPos--;
     if (popped == Stack::KEY) {
         buffer[bufferPos] = '\0';
+        GOB_JSON_STAT(stats.keyHighWater = std::max(stats.keyHighWater, bufferPos));
+        GOB_JSON_STAT(stats.truncatedKeys += (bufferPos >= GOB_JSON_PARSER_KEY_MAX_LENGTH));
         path.getCurrent()->set(buffer);
         state = State::END_KEY;
     } else if (popped == Stack::STRING) {
         buffer[bufferPos] = '\0';
-        handler->value(path, elementValue.with(buffer));
+        GOB_JSON_DISPATCH(Value, handler->value(path, elementValue.with(buffer)));
         state = State::AFTER_VALUE;
     } else {
         PARSE_ERROR("Unexpected end of string", curCh, characterCounter, path);
@@ -297,6 +532,11 @@ void StreamingParser::endArray() {
         PARSE_ERROR("stackPos <= 0", curCh, characterCounter, path);
         return;
     }
+    if(activeSink && stackPos == activeSinkDepth)
+    {
+        activeSink->flush();
+        activeSink = nullptr;
+    }
     auto popped = stack[stackPos - 1];
     stackPos--;
     path.pop();
@@ -306,7 +546,7 @@ void StreamingParser::endArray() {
         // throw new ParsingError($this->_line_number, $this->_char_number,
         // "Unexpected end of array encountered.");
     }
-    handler->endArray(path);
+    GOB_JSON_DISPATCH(EndArray, handler->endArray(path));
     state = State::AFTER_VALUE;
     if (stackPos == 0) {
         endDocument();
@@ -321,6 +561,7 @@ void StreamingParser::startKey() {
     }
     stack[stackPos] = Stack::KEY;
     stackPos++;
+    GOB_JSON_STAT(stats.depthHighWater = std::max(stats.depthHighWater, stackPos));
     state = State::IN_STRING;
 }
 
@@ -334,7 +575,7 @@ void StreamingParser::endObject() {
         // throw new ParsingError($this->_line_number, $this->_char_number,
         // "Unexpected end of object encountered.");
     }
-    handler->endObject(path);
+    GOB_JSON_DISPATCH(EndObject, handler->endObject(path));
     state = State::AFTER_VALUE;
     if (stackPos == 0) {
         endDocument();
@@ -412,17 +653,8 @@ bool StreamingParser::isHexCharacter(char c) {
 
 int StreamingParser::getHexArrayAsDecimal(char hexArray[], int length) {
     int result = 0;
-    for (int i = length; i >= 0; i--) {
-        char current = hexArray[length - i - 1];
-        int value = 0;
-        if (current >= 'a' && current <= 'f') {
-            value = current - 'a' + 10;
-        } else if (current >= 'A' && current <= 'F') {
-            value = current - 'A' + 10;
-        } else if (current >= '0' && current <= '9') {
-            value = current - '0';
-        }
-        result = (result << 4) | value;
+    for (int i = 0; i < length; i++) {
+        result = (result << 4) | (hexTable[(uint8_t)hexArray[i]] & 0x0F);
     }
     return result;
 }
@@ -452,43 +684,24 @@ void StreamingParser::endUnicodeSurrogateInterstitial() {
 
 void StreamingParser::endNumber() {
     buffer[bufferPos] = '\0';
-#if 1
-    if (strchr(buffer, '.') != NULL) {
-        double floatValue;
-        sscanf(buffer, "%lf", &floatValue);
-        handler->value(path, elementValue.with(static_cast<ElementValue::fp_t>(floatValue)));
-    }
-    else if(buffer[0] == '-')
-    {
-        intmax_t intValue;
-        sscanf(buffer, "%jd", &intValue);
-        handler->value(path, elementValue.with(static_cast<ElementValue::number_t>(intValue)));
-    }
-    else
-    {
-        uintmax_t intValue;
-        sscanf(buffer, "%ju", &intValue);
-        handler->value(path, elementValue.with(static_cast<ElementValue::number_t>(intValue)));
-    }
-#else
-    // Floating-point
-    if(strchr(buffer, '.') != nullptr)
-    {
-        handler->value(path, elementValue.with(static_cast<ElementValue::fp_t>(std::strtod(buffer, nullptr))) );
-    }
-    // Signed integer
-    else if(buffer[0] == '-')
+    // Directly to the sink
+    if(activeSink && stackPos == activeSinkDepth)
     {
-        handler->value(path,
-                       elementValue.with(static_cast<ElementValue::number_t>(std::strtoimax(buffer, nullptr, 10))) );
+        GOB_JSON_STAT(++stats.sinkNumbers);
+        activeSink->put(buffer);
+        bufferPos = 0;
+        state = State::AFTER_VALUE;
+        return;
     }
-    // Assume unsigned integarer
-    else
+    // Conversion is deferred until ElementValue::getInt/getFloat.
+    uint8_t flags = (buffer[0] == '-') ? ElementValue::Negative : 0;
+    for(int i = 0; i < bufferPos; ++i)
     {
-        handler->value(path,
-                       elementValue.with(static_cast<ElementValue::number_t>(std::strtoumax(buffer, nullptr, 10))) );
+        if(buffer[i] == '.') { flags |= ElementValue::Fraction; }
+        else if(buffer[i] == 'e' || buffer[i] == 'E') { flags |= ElementValue::Exponent; }
     }
-#endif
+    GOB_JSON_STAT(++stats.numbers);
+    GOB_JSON_DISPATCH(Value, handler->value(path, elementValue.withNumber(buffer, bufferPos, flags)));
 
     bufferPos = 0;
     state = State::AFTER_VALUE;
@@ -504,7 +717,7 @@ int StreamingParser::convertDecimalBufferToInt(char myArray[], int length) {
 }
 
 void StreamingParser::endDocument() {
-    handler->endDocument();
+    GOB_JSON_DISPATCH(EndDocument, handler->endDocument());
     if(recursive) { reset(); }
     else { state = State::DONE; }
 }
@@ -512,7 +725,7 @@ void StreamingParser::endDocument() {
 void StreamingParser::endTrue() {
     buffer[bufferPos] = '\0';
     if(strcmp(buffer, "true") == 0) {
-        handler->value(path, elementValue.with(true));
+        GOB_JSON_DISPATCH(Value, handler->value(path, elementValue.with(true)));
     } else {
         PARSE_ERROR("Expected 'true'", curCh, characterCounter, path);
         return;
@@ -526,7 +739,7 @@ void StreamingParser::endTrue() {
 void StreamingParser::endFalse() {
     buffer[bufferPos] = '\0';
     if(strcmp(buffer, "false") == 0) {
-        handler->value(path, elementValue.with(false));
+        GOB_JSON_DISPATCH(Value, handler->value(path, elementValue.with(false)));
     } else {
         PARSE_ERROR("Expected 'false'", curCh, characterCounter, path);
         return;
@@ -540,7 +753,7 @@ void StreamingParser::endFalse() {
 void StreamingParser::endNull() {
     buffer[bufferPos] = '\0';
     if(strcmp(buffer, "null") == 0) {
-        handler->value(path, elementValue.with());
+        GOB_JSON_DISPATCH(Value, handler->value(path, elementValue.with()));
     } else {
         PARSE_ERROR("Expected 'null'", curCh, characterCounter, path);
         return;
@@ -557,11 +770,24 @@ void StreamingParser::startArray() {
         PARSE_ERROR("stack overflow", curCh, characterCounter, path);
         return;
     }
-    handler->startArray(path);
+    GOB_JSON_DISPATCH(StartArray, handler->startArray(path));
+    if(!activeSink)
+    {
+        for(auto& b : numberSinks)
+        {
+            if(b.sink && path.match(b.pattern))
+            {
+                activeSink = b.sink;
+                activeSinkDepth = stackPos + 1;
+                break;
+            }
+        }
+    }
     state = State::IN_ARRAY;
     stack[stackPos] = Stack::ARRAY;
     path.push(); 
     stackPos++;
+    GOB_JSON_STAT(stats.depthHighWater = std::max(stats.depthHighWater, stackPos));
 }
 
 void StreamingParser::startObject() {
@@ -570,11 +796,12 @@ void StreamingParser::startObject() {
         PARSE_ERROR("stack overflow", curCh, characterCounter, path);
         return;
     }
-    handler->startObject(path);
+    GOB_JSON_DISPATCH(StartObject, handler->startObject(path));
     state = State::IN_OBJECT;
     stack[stackPos] = Stack::OBJECT;
     path.push(); 
     stackPos++;
+    GOB_JSON_STAT(stats.depthHighWater = std::max(stats.depthHighWater, stackPos));
 }
 
 void StreamingParser::startString() {
@@ -585,6 +812,7 @@ void StreamingParser::startString() {
     }
     stack[stackPos] = Stack::STRING;
     stackPos++;
+    GOB_JSON_STAT(stats.depthHighWater = std::max(stats.depthHighWater, stackPos));
     state = State::IN_STRING;
 }
 
@@ -17,6 +17,8 @@
 #include "gob_json_handler.hpp"
 #include "gob_json_element_path.hpp"
 #include "gob_json_element_value.hpp"
+#include "gob_json_number_sink.hpp"
+#include "internal/gob_json_utf8.hpp"
 
 /*!
   @namespace goblib
@@ -43,6 +45,47 @@ namespace json {
 # pragma message "[gob_json] Defined buffer length=" GOB_JSON_STRINGIFY(GOB_JSON_PARSER_BUFFER_MAX_LENGTH)
 #endif
 
+#ifndef GOB_JSON_PARSER_NUMBER_SINK_MAX
+# pragma message "[gob_json] Number sink max as default"
+# define GOB_JSON_PARSER_NUMBER_SINK_MAX  (2)
+#else
+# pragma message "[gob_json] Defined number sink max=" GOB_JSON_STRINGIFY(GOB_JSON_PARSER_NUMBER_SINK_MAX)
+#endif
+
+#ifndef GOB_JSON_STATS
+# define GOB_JSON_STATS (0)
+#else
+# pragma message "[gob_json] Defined stats=" GOB_JSON_STRINGIFY(GOB_JSON_STATS)
+#endif
+
+#if GOB_JSON_STATS || defined(DOXYGEN_PROCESS)
+/*!
+  @struct ParserStats
+  @brief Counters of StreamingParser (GOB_JSON_STATS)
+ */
+struct ParserStats
+{
+    /*! @brief Kind of handler event */
+    enum Event : uint8_t { StartDocument, EndDocument, StartObject, EndObject, StartArray, EndArray, Value, Whitespace, EventMax };
+    static constexpr size_t STATE_MAX = 16; //!< Number of parser states
+
+    /*!
+      @brief Bytes per parser state (Index 0 is ERROR, see StreamingParser::getStateName)
+      @note Each character is counted once. The character that terminates a number is counted in the state after the number.
+     */
+    uint64_t bytes[STATE_MAX]{};
+    uint64_t events[EventMax]{};    //!< Handler calls per kind
+    uint64_t handlerTicks{};        //!< Ticks spent in handler callbacks (stats::ticks)
+    uint64_t numbers{};             //!< Numbers passed to the handler
+    uint64_t sinkNumbers{};         //!< Numbers converted into NumberSink
+    uint32_t truncatedTokens{};     //!< Strings/numbers truncated by the token buffer
+    uint32_t truncatedKeys{};       //!< Keys truncated by GOB_JSON_PARSER_KEY_MAX_LENGTH
+    int bufferHighWater{};          //!< Maximum length of token
+    int keyHighWater{};             //!< Maximum length of key
+    int depthHighWater{};           //!< Maximum depth of the inner stack
+};
+#endif
+
 /*!
   @class StreamingParser
   @brief JSON streaming parser
@@ -58,21 +101,67 @@ class StreamingParser
 
     /*! @brief Set handler */
     void setHandler(Handler* h) { handler = h; }
-    /*! @brief Reset inner state.*/
+    /*! @brief Reset inner state. (Numbers not yet passed to the NumberSink are discarded) */
     void reset();
 
     /*! @brief Parse 1 character */
     void parse(const char ch);
-    /*! @brief Parse buffer */
-    void parse(const char* buf, size_t len)
-    {
-        while(len--) { parse(*buf++); }
-    }
+    /*!
+      @brief Parse buffer
+      @note Runs of plain characters in strings are processed at once.
+     */
+    void parse(const char* buf, size_t len);
     /*! @brief Parsing JSON documents recursively */
     void setRecursively(const bool b) { recursive = b; }
+    /*!
+      @brief Validate UTF-8 in strings and keys (Default false)
+      @note Invalid sequences (overlong, surrogates, over U+10FFFF, truncated) are parse errors.
+     */
+    void setValidateUtf8(const bool b) { utf8Check = b; utf8.reset(); }
+    /*!
+      @brief Pass whitespace outside strings to Handler::whitespace (Default false)
+      @note Whitespace that terminates a number is passed after the number value.
+     */
+    void setEmitWhitespace(const bool b) { doEmitWhitespace = b; }
+
+    /*!
+      @brief Bind numeric JSON array to the sink
+      @param pattern Path of the array. (ElementPath::match)
+      @param sink Numbers in the array are passed to the sink instead of Handler::value
+      @return False if no room. (GOB_JSON_PARSER_NUMBER_SINK_MAX)
+      @warning pattern and sink must be alive while parsing.
+     */
+    bool addNumberSink(const char* pattern, NumberSink* sink);
+    /*! @brief Unbind all number sinks */
+    void clearNumberSinks();
+
+    /*!
+      @brief Validate the JSON text without handler, values, paths and events
+      @param buf JSON text
+      @param len Length of buf
+      @param errorPos Offset of the first invalid character (len if truncated) if not nullptr
+      @return True if buf is exactly one JSON value surrounded by optional whitespace (RFC 8259)
+      @note Strict grammar including numbers, escapes, separators and UTF-8 in strings. Scalar at the top level is valid as RFC 8259.
+      @note Nesting level is limited as parse. A key or string takes a level as well as a container, so they are invalid at GOB_JSON_PARSER_STACK_MAX_DEPTH.
+     */
+    static bool validate(const char* buf, const size_t len, size_t* errorPos = nullptr);
 
     /*! @brief Any errors? */
     bool hasError() const { return state == State::ERROR; }
+    /*! @brief Number of characters parsed since reset() */
+    size_t getPosition() const { return characterCounter; }
+
+#if GOB_JSON_STATS || defined(DOXYGEN_PROCESS)
+    ///@name Statistics (GOB_JSON_STATS)
+    ///@{
+    /*! @brief Gets the counters */
+    const ParserStats& getStats() const { return stats; }
+    /*! @brief Clear the counters */
+    void resetStats() { stats = ParserStats{}; }
+    /*! @brief Name of the state for ParserStats::bytes */
+    static const char* getStateName(const size_t index);
+    ///@}
+#endif
     
   protected:
     void startArray();
@@ -97,6 +186,9 @@ class StreamingParser
     void endUnicodeSurrogateInterstitial();
     void endUnicodeCharacter(uint32_t codepoint);
 
+    void appendString(const char* s, const size_t len);
+    size_t decodeEscape(const char* p, const char* e);
+    void appendBuffer(const char* s, const size_t len);
     void increaseBufferPointer();
     void processEscapeCharacters(char c);
 
@@ -146,6 +238,8 @@ class StreamingParser
     
     bool recursive{false};
     bool doEmitWhitespace{false};
+    bool utf8Check{false};
+    utf8::Validator utf8{};
 
     char buffer[GOB_JSON_PARSER_BUFFER_MAX_LENGTH]{};
     int bufferPos{0};
@@ -158,6 +252,20 @@ class StreamingParser
 
     size_t characterCounter{0};
     int curCh{}; // for error information.
+
+    struct NumberSinkBinding
+    {
+        const char* pattern;
+        NumberSink* sink;
+    };
+    NumberSinkBinding numberSinks[GOB_JSON_PARSER_NUMBER_SINK_MAX]{};
+    NumberSink* activeSink{nullptr}; // Sink of the array being parsed
+    int activeSinkDepth{0};          // stackPos in the array
+
+#if GOB_JSON_STATS
+    ParserStats stats{};
+    bool truncating{};
+#endif
 };
 //
 }}
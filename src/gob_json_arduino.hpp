@@ -9,6 +9,7 @@
 
 #include <Stream.h>
 #include "gob_json.hpp"
+#include "gob_json_writer.hpp"
 
 namespace goblib { namespace json {
 /*!
@@ -49,6 +50,23 @@ class Stream : public ::Stream, public StreamingParser
     inline virtual int read() override { return 0; }
     ///@}
 };
+
+/*!
+  @class PrintSink
+  @brief Sink for StreamingWriter that outputs to Arduino Print
+ */
+class PrintSink : public goblib::json::Sink
+{
+  public:
+    explicit PrintSink(::Print& p) : _print(p) {}
+    virtual bool write(const char* buf, size_t len) override
+    {
+        return _print.write(reinterpret_cast<const uint8_t*>(buf), len) == len;
+    }
+
+  private:
+    ::Print& _print;
+};
 //
 }}}
 #endif
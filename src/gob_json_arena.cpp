@@ -0,0 +1,60 @@
+/*!
+  @file gob_json_arena.cpp
+  @brief Monotonic memory arena and allocator for Element stores.
+ */
+#include "gob_json_arena.hpp"
+#include "internal/gob_json_log.hpp"
+#include <cstdlib>
+#include <algorithm>
+
+namespace goblib { namespace json {
+
+void* MonotonicArena::allocate(const size_t bytes, const size_t alignment)
+{
+    auto align = [alignment](uint8_t* p)
+    {
+        return reinterpret_cast<uint8_t*>((reinterpret_cast<uintptr_t>(p) + alignment - 1) & ~(uintptr_t)(alignment - 1));
+    };
+
+    auto p = align(_cur);
+    if(!_cur || p > _end || bytes > (size_t)(_end - p))
+    {
+        // Obtain new block from heap.
+        if(_nextBlockSize == 0)
+        {
+            GOB_JSON_LOGE("Arena exhausted %zu/%zu", bytes, _used);
+            return nullptr;
+        }
+        auto sz = std::max(_nextBlockSize, sizeof(Block) + alignment + bytes);
+        auto blk = static_cast<Block*>(std::malloc(sz));
+        if(!blk)
+        {
+            GOB_JSON_LOGE("Failed to allocate block %zu", sz);
+            return nullptr;
+        }
+        blk->next = _blocks;
+        _blocks = blk;
+        _cur = reinterpret_cast<uint8_t*>(blk + 1);
+        _end = reinterpret_cast<uint8_t*>(blk) + sz;
+        p = align(_cur);
+    }
+    _cur = p + bytes;
+    _used += bytes;
+    return p;
+}
+
+void MonotonicArena::release()
+{
+    while(_blocks)
+    {
+        auto next = _blocks->next;
+        std::free(_blocks);
+        _blocks = next;
+    }
+    _cur = _initial;
+    _end = _initial + _initialSize;
+    _used = 0;
+}
+
+//
+}}
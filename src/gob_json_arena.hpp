@@ -0,0 +1,141 @@
+/*!
+  @file gob_json_arena.hpp
+  @brief Monotonic memory arena and allocator for Element stores.
+ */
+#ifndef GOB_JSON_ARENA_HPP
+#define GOB_JSON_ARENA_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#if __cplusplus >= 201703L && defined(__has_include)
+# if __has_include(<memory_resource>)
+#   include <memory_resource>
+# endif
+#endif
+
+namespace goblib { namespace json {
+
+#if defined(__cpp_lib_memory_resource) && __cpp_lib_memory_resource >= 201603L
+# define GOB_JSON_HAS_MEMORY_RESOURCE 1
+#else
+# define GOB_JSON_HAS_MEMORY_RESOURCE 0
+#endif
+
+/*!
+  @class MonotonicArena
+  @brief Bump allocator on the user buffer.
+  @details Deallocation does nothing, release() discards all allocations at once.
+  When the buffer is exhausted, blocks are obtained from the heap if nextBlockSize is not zero.
+  @note Derived from std::pmr::memory_resource if available (C++17), so that std::pmr containers can use it.
+  @warning Growth of containers leaves old storage in the arena. Use the capacity hint of Element.
+  @code
+  static uint8_t buf[4096];
+  MonotonicArena arena(buf, sizeof(buf));
+  std::vector<int, ArenaAllocator<int>> values(ArenaAllocator<int>(arena));
+  // ... parse and bind into values ...
+  arena.release(); // e.g. in endDocument after the values are consumed.
+  @endcode
+ */
+class MonotonicArena
+#if GOB_JSON_HAS_MEMORY_RESOURCE
+        : public std::pmr::memory_resource
+#endif
+{
+  public:
+    /*!
+      @param buffer Initial buffer
+      @param size Size of initial buffer
+      @param nextBlockSize Size of block obtained from heap when exhausted. 0 means no heap.
+     */
+    MonotonicArena(void* buffer, const size_t size, const size_t nextBlockSize = 0)
+            : _initial(static_cast<uint8_t*>(buffer)), _initialSize(size), _nextBlockSize(nextBlockSize)
+    { release(); }
+    virtual ~MonotonicArena() { release(); }
+    MonotonicArena(const MonotonicArena&) = delete;
+    MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+    /*!
+      @brief Allocate memory
+      @return Pointer to memory, nullptr if exhausted
+     */
+    void* allocate(const size_t bytes, const size_t alignment = alignof(std::max_align_t));
+    /*! @brief Discard all allocations and return heap blocks */
+    void release();
+
+    /*! @brief Bytes handed out since last release() */
+    size_t used() const { return _used; }
+
+  protected:
+#if GOB_JSON_HAS_MEMORY_RESOURCE
+    virtual void* do_allocate(size_t bytes, size_t alignment) override
+    {
+        auto p = allocate(bytes, alignment);
+        if(!p)
+        {
+# if defined(__cpp_exceptions) || defined(__EXCEPTIONS)
+            throw std::bad_alloc();
+# else
+            abort();
+# endif
+        }
+        return p;
+    }
+    virtual void do_deallocate(void*, size_t, size_t) override {}
+    virtual bool do_is_equal(const std::pmr::memory_resource& o) const noexcept override { return this == &o; }
+#endif
+
+  private:
+    struct Block { Block* next; };
+    uint8_t* _initial{};
+    size_t _initialSize{};
+    size_t _nextBlockSize{};
+    uint8_t* _cur{};
+    uint8_t* _end{};
+    Block* _blocks{};
+    size_t _used{};
+};
+
+/*!
+  @class ArenaAllocator
+  @brief Allocator using MonotonicArena. (C++11 allocator requirements)
+  @tparam T Value type
+ */
+template<typename T> class ArenaAllocator
+{
+  public:
+    using value_type = T;
+
+    explicit ArenaAllocator(MonotonicArena& arena) noexcept : _arena(&arena) {}
+    template<typename U> ArenaAllocator(const ArenaAllocator<U>& o) noexcept : _arena(o.arena()) {}
+
+    T* allocate(const size_t n)
+    {
+        auto p = _arena->allocate(n * sizeof(T), alignof(T));
+        if(!p)
+        {
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS)
+            throw std::bad_alloc();
+#else
+            abort();
+#endif
+        }
+        return static_cast<T*>(p);
+    }
+    void deallocate(T*, size_t) noexcept {}
+
+    MonotonicArena* arena() const noexcept { return _arena; }
+
+  private:
+    MonotonicArena* _arena{};
+};
+
+template<typename T, typename U>
+inline bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.arena() == b.arena(); }
+template<typename T, typename U>
+inline bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return !(a == b); }
+
+//
+}}
+#endif
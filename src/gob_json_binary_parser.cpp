@@ -0,0 +1,349 @@
+/*!
+  @file gob_json_binary_parser.cpp
+  @brief CBOR / MessagePack streaming parser that drives Handler.
+ */
+#include "gob_json_binary_parser.hpp"
+#include "internal/gob_json_log.hpp"
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+
+namespace
+{
+// IEEE754 binary16 to double
+double halfToDouble(const uint16_t h)
+{
+    const int exp = (h >> 10) & 0x1F;
+    const int mant = h & 0x3FF;
+    double v{};
+    if(exp == 0)       { v = std::ldexp(mant, -24); }
+    else if(exp != 31) { v = std::ldexp(mant + 1024, exp - 25); }
+    else               { v = mant ? NAN : INFINITY; }
+    return (h & 0x8000) ? -v : v;
+}
+//
+}
+
+namespace goblib { namespace json {
+
+void BinaryParser::reset()
+{
+    state = State::HEAD;
+    stackPos = 0;
+    path = ElementPath{};
+    argument = 0;
+    argLength = argPos = 0;
+    remaining = 0;
+    chunked = false;
+    bufferPos = 0;
+    characterCounter = 0;
+}
+
+void BinaryParser::error(const char* estr)
+{
+    GOB_JSON_LOGE("%s pos:%zu [%s]", estr, characterCounter, path.toString().c_str());
+    state = State::ERROR;
+}
+
+void BinaryParser::parse(const char ch)
+{
+    const uint8_t c = static_cast<uint8_t>(ch);
+    switch(state)
+    {
+    case State::HEAD:
+        argument = 0;
+        argLength = argPos = 0;
+        if(format == BinaryFormat::CBOR ? decodeCbor(c) : decodeMessagePack(c))
+        {
+            if(argLength) { state = State::ARGUMENT; }
+            else { item(); }
+        }
+        break;
+    case State::ARGUMENT:
+        argument = (argument << 8) | c;
+        if(++argPos == argLength) { item(); }
+        break;
+    case State::PAYLOAD:
+        buffer[bufferPos] = ch;
+        bufferPos += (bufferPos + 1 < sizeof(buffer)); // Truncate
+        if(--remaining == 0)
+        {
+            if(chunked) { state = State::HEAD; } // Next chunk
+            else { endString(); }
+        }
+        break;
+    case State::SKIP:
+        if(--remaining == 0) { value(elementValue.with()); }
+        break;
+    default: return; // ERROR, DONE
+    }
+    characterCounter++;
+}
+
+// Initial byte of CBOR data item
+bool BinaryParser::decodeCbor(const uint8_t c)
+{
+    static constexpr Item majors[] = { Item::Unsigned, Item::Negative, Item::String, Item::String, Item::Array, Item::Map, Item::Tag };
+    static constexpr Item indefinites[] = { Item::Break, Item::Break, Item::IndefiniteString, Item::IndefiniteString,
+                                            Item::IndefiniteArray, Item::IndefiniteMap, Item::Break };
+    const uint8_t major = c >> 5;
+    const uint8_t ai = c & 0x1F;
+
+    if(ai >= 28 && ai <= 30) { error("Reserved additional information"); return false; }
+    if(ai == 31)
+    {
+        kind = (major < 7) ? indefinites[major] : Item::Break;
+        if(major < 2 || major == 6) { error("Invalid indefinite length"); return false; }
+        return true;
+    }
+    argLength = (ai < 24) ? 0 : (1 << (ai - 24));
+    argument = (ai < 24) ? ai : 0;
+    if(major < 7)
+    {
+        kind = majors[major];
+        return true;
+    }
+    switch(ai)
+    {
+    case 20: kind = Item::False;  break;
+    case 21: kind = Item::True;   break;
+    case 25: kind = Item::Half;   break;
+    case 26: kind = Item::Float;  break;
+    case 27: kind = Item::Double; break;
+    default: kind = Item::Null;   break; // null, undefined and simple values
+    }
+    return true;
+}
+
+// First byte of MessagePack object
+bool BinaryParser::decodeMessagePack(const uint8_t c)
+{
+    if(c <= 0x7F) { kind = Item::Unsigned; argument = c;        return true; } // positive fixint
+    if(c <= 0x8F) { kind = Item::Map;      argument = c & 0x0F; return true; } // fixmap
+    if(c <= 0x9F) { kind = Item::Array;    argument = c & 0x0F; return true; } // fixarray
+    if(c <= 0xBF) { kind = Item::String;   argument = c & 0x1F; return true; } // fixstr
+    if(c >= 0xE0) // negative fixint
+    {
+        kind = Item::Signed;
+        argument = static_cast<uint64_t>(static_cast<int64_t>(static_cast<int8_t>(c)));
+        return true;
+    }
+    switch(c)
+    {
+    case 0xC0: kind = Item::Null;  return true;
+    case 0xC2: kind = Item::False; return true;
+    case 0xC3: kind = Item::True;  return true;
+    case 0xC4: case 0xC5: case 0xC6: kind = Item::String; argLength = 1 << (c - 0xC4); return true; // bin
+    case 0xC7: case 0xC8: case 0xC9: kind = Item::Ext;    argLength = 1 << (c - 0xC7); return true;
+    case 0xCA: kind = Item::Float;  argLength = 4; return true;
+    case 0xCB: kind = Item::Double; argLength = 8; return true;
+    case 0xCC: case 0xCD: case 0xCE: case 0xCF: kind = Item::Unsigned; argLength = 1 << (c - 0xCC); return true;
+    case 0xD0: case 0xD1: case 0xD2: case 0xD3: kind = Item::Signed;   argLength = 1 << (c - 0xD0); return true;
+    case 0xD4: case 0xD5: case 0xD6: case 0xD7: case 0xD8: kind = Item::Ext; argument = 1 << (c - 0xD4); return true; // fixext
+    case 0xD9: case 0xDA: case 0xDB: kind = Item::String; argLength = 1 << (c - 0xD9); return true; // str
+    case 0xDC: kind = Item::Array; argLength = 2; return true;
+    case 0xDD: kind = Item::Array; argLength = 4; return true;
+    case 0xDE: kind = Item::Map;   argLength = 2; return true;
+    case 0xDF: kind = Item::Map;   argLength = 4; return true;
+    default: break;
+    }
+    error("Never used type");
+    return false;
+}
+
+// Initial byte and argument are complete
+void BinaryParser::item()
+{
+    state = State::HEAD;
+    if(chunked && kind != Item::String && kind != Item::Break)
+    {
+        error("Definite length string expected in chunks");
+        return;
+    }
+    switch(kind)
+    {
+    case Item::Unsigned: value(elementValue.with(static_cast<ElementValue::number_t>(argument))); break;
+    case Item::Negative: value(elementValue.with(static_cast<ElementValue::number_t>(~argument))); break;
+    case Item::Signed:
+    {
+        // Sign extension
+        const int shift = argLength ? 64 - argLength * 8 : 0;
+        const int64_t v = static_cast<int64_t>(argument << shift) >> shift;
+        value(elementValue.with(static_cast<ElementValue::number_t>(v)));
+        break;
+    }
+    case Item::Half: value(elementValue.with(halfToDouble(static_cast<uint16_t>(argument)))); break;
+    case Item::Float:
+    {
+        const uint32_t bits = static_cast<uint32_t>(argument);
+        float f;
+        std::memcpy(&f, &bits, sizeof(f));
+        value(elementValue.with(static_cast<ElementValue::fp_t>(f)));
+        break;
+    }
+    case Item::Double:
+    {
+        double d;
+        std::memcpy(&d, &argument, sizeof(d));
+        value(elementValue.with(static_cast<ElementValue::fp_t>(d)));
+        break;
+    }
+    case Item::String:
+        if(chunked)
+        {
+            remaining = argument;
+            if(remaining) { state = State::PAYLOAD; }
+            break;
+        }
+        startString(argument);
+        break;
+    case Item::IndefiniteString:
+        chunked = true;
+        bufferPos = 0;
+        break;
+    case Item::Array:           startContainer(false, false, argument); break;
+    case Item::Map:             startContainer(true,  false, argument); break;
+    case Item::IndefiniteArray: startContainer(false, true, 0);         break;
+    case Item::IndefiniteMap:   startContainer(true,  true, 0);         break;
+    case Item::Break:
+        if(chunked)
+        {
+            chunked = false;
+            endString();
+            break;
+        }
+        if(stackPos <= 0 || !stack[stackPos - 1].indefinite)
+        {
+            error("Unexpected break");
+            break;
+        }
+        endContainer();
+        break;
+    case Item::Tag: break; // Ignored, next item is the content
+    case Item::Ext:
+        remaining = argument + 1; // With type byte
+        state = State::SKIP;
+        break;
+    case Item::Null:  value(elementValue.with());      break;
+    case Item::True:  value(elementValue.with(true));  break;
+    case Item::False: value(elementValue.with(false)); break;
+    }
+}
+
+void BinaryParser::startString(const uint64_t len)
+{
+    bufferPos = 0;
+    remaining = len;
+    if(remaining) { state = State::PAYLOAD; }
+    else { endString(); }
+}
+
+void BinaryParser::endString()
+{
+    buffer[bufferPos] = '\0';
+    bufferPos = 0;
+    state = State::HEAD;
+    value(elementValue.with(static_cast<const char*>(buffer)));
+}
+
+// Dispatch the scalar, or set the key
+void BinaryParser::value(const ElementValue& v)
+{
+    state = State::HEAD;
+    if(isKey())
+    {
+        if(v.isInt())
+        {
+            if(kind == Item::Unsigned) { snprintf(buffer, sizeof(buffer), "%ju", v.getInt()); }
+            else { snprintf(buffer, sizeof(buffer), "%jd", static_cast<intmax_t>(v.getInt())); }
+        }
+        else if(!v.isString())
+        {
+            error("Unsupported type of key");
+            return;
+        }
+        path.getCurrent()->set(buffer);
+        stack[stackPos - 1].expectKey = false;
+        return;
+    }
+    if(!beforeValue()) { return; }
+    if(handler) { handler->value(path, v); }
+    afterValue();
+}
+
+bool BinaryParser::beforeValue()
+{
+    if(stackPos == 0)
+    {
+        if(handler) { handler->startDocument(); }
+    }
+    else if(!stack[stackPos - 1].object)
+    {
+        path.getCurrent()->step();
+    }
+    return true;
+}
+
+void BinaryParser::afterValue()
+{
+    if(hasError()) { return; }
+    if(stackPos == 0)
+    {
+        endDocument();
+        return;
+    }
+    auto& c = stack[stackPos - 1];
+    c.expectKey = c.object;
+    if(!c.indefinite && --c.remaining == 0) { endContainer(); }
+}
+
+void BinaryParser::startContainer(const bool object, const bool indefinite, const uint64_t count)
+{
+    if(isKey())
+    {
+        error("Unsupported type of key");
+        return;
+    }
+    if(stackPos >= (int)(sizeof(stack) / sizeof(stack[0])))
+    {
+        error("stack overflow");
+        return;
+    }
+    beforeValue();
+    if(handler)
+    {
+        if(object) { handler->startObject(path); }
+        else { handler->startArray(path); }
+    }
+    path.push();
+    stack[stackPos++] = { count, object, indefinite, object };
+    if(!indefinite && count == 0) { endContainer(); }
+}
+
+void BinaryParser::endContainer()
+{
+    const auto c = stack[stackPos - 1];
+    if(c.object && !c.expectKey)
+    {
+        error("Value expected for key");
+        return;
+    }
+    --stackPos;
+    path.pop();
+    if(handler)
+    {
+        if(c.object) { handler->endObject(path); }
+        else { handler->endArray(path); }
+    }
+    afterValue();
+}
+
+void BinaryParser::endDocument()
+{
+    if(handler) { handler->endDocument(); }
+    if(recursive) { reset(); }
+    else { state = State::DONE; }
+}
+
+//
+}}
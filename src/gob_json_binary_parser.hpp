@@ -0,0 +1,137 @@
+/*!
+  @file gob_json_binary_parser.hpp
+  @brief CBOR / MessagePack streaming parser that drives Handler.
+ */
+#ifndef GOB_JSON_BINARY_PARSER_HPP
+#define GOB_JSON_BINARY_PARSER_HPP
+
+#include "gob_json.hpp"
+#include "gob_json_transcoder.hpp" // BinaryFormat
+#include <cstdint>
+#include <cstddef>
+
+namespace goblib { namespace json {
+
+/*!
+  @class BinaryParser
+  @brief CBOR / MessagePack streaming parser
+  @details Same events and ElementPath as StreamingParser parsing the equivalent JSON,
+  so the existing handlers, Element and DelegateHandler work unchanged.
+  Numbers are passed as converted values. (No raw text, no text to number conversion)
+  - Byte strings (CBOR) and bin (MessagePack) are passed as string.
+  - CBOR tags are ignored, undefined and simple values are passed as null.
+  - MessagePack ext is skipped and passed as null.
+  - Integer keys are passed as decimal text. Other types of key are errors.
+  - Top-level scalar is passed between startDocument and endDocument.
+  @note Strings longer than GOB_JSON_PARSER_BUFFER_MAX_LENGTH - 1 are truncated as StreamingParser.
+ */
+class BinaryParser
+{
+  public:
+    /*!
+      @brief Constructor
+      @param format Input format
+      @param handler Handler
+     */
+    explicit BinaryParser(const BinaryFormat format, Handler* h = nullptr) : format(format) { reset(); setHandler(h); }
+
+    /*! @brief Set handler */
+    void setHandler(Handler* h) { handler = h; }
+    /*! @brief Input format */
+    BinaryFormat getFormat() const { return format; }
+    /*! @brief Reset inner state.*/
+    void reset();
+
+    /*! @brief Parse 1 byte */
+    void parse(const char ch);
+    /*! @brief Parse buffer */
+    void parse(const char* buf, size_t len)
+    {
+        while(len--) { parse(*buf++); }
+    }
+    /*! @brief Parsing documents recursively (CBOR sequence, MessagePack stream) */
+    void setRecursively(const bool b) { recursive = b; }
+
+    /*! @brief Any errors? */
+    bool hasError() const { return state == State::ERROR; }
+    /*! @brief Number of bytes parsed since reset() */
+    size_t getPosition() const { return characterCounter; }
+
+  protected:
+    // Kind of the data item
+    enum class Item : uint8_t
+    {
+        Unsigned,
+        Negative, // CBOR -1 - n
+        Signed,   // MessagePack int8-64
+        Half,
+        Float,
+        Double,
+        String,
+        Array,
+        Map,
+        IndefiniteString,
+        IndefiniteArray,
+        IndefiniteMap,
+        Break,
+        Tag,
+        Ext,
+        Null,
+        True,
+        False,
+    };
+
+    bool decodeCbor(const uint8_t c);
+    bool decodeMessagePack(const uint8_t c);
+    void item();
+    void value(const ElementValue& v);
+    void startContainer(const bool object, const bool indefinite, const uint64_t count);
+    void endContainer();
+    void startString(const uint64_t len);
+    void endString();
+    bool beforeValue();
+    void afterValue();
+    void endDocument();
+    void error(const char* estr);
+    bool isKey() const { return stackPos > 0 && stack[stackPos - 1].object && stack[stackPos - 1].expectKey; }
+
+    enum class State : int8_t
+    {
+        ERROR = -1,
+        DONE,
+        HEAD,     // Initial byte
+        ARGUMENT, // Following bytes of the argument
+        PAYLOAD,  // String bytes
+        SKIP,     // Ext data
+    };
+    struct Container
+    {
+        uint64_t remaining; // Elements (members) left if definite
+        bool object;
+        bool indefinite;
+        bool expectKey;
+    };
+
+    BinaryFormat format{};
+    Handler* handler{nullptr};
+    ElementValue elementValue{};
+    ElementPath path{};
+
+    State state{State::HEAD};
+    Container stack[GOB_JSON_PARSER_STACK_MAX_DEPTH]{};
+    int stackPos{0};
+    bool recursive{false};
+
+    Item kind{};
+    uint64_t argument{};
+    uint8_t argLength{}, argPos{};
+    uint64_t remaining{}; // Bytes of PAYLOAD/SKIP
+    bool chunked{};       // In indefinite length string
+
+    char buffer[GOB_JSON_PARSER_BUFFER_MAX_LENGTH]{};
+    size_t bufferPos{0};
+    size_t characterCounter{0};
+};
+//
+}}
+#endif
@@ -0,0 +1,168 @@
+/*!
+  @file gob_json_coroutine.cpp
+  @brief C++20 coroutine layer for non-blocking sources. (Linux, C++20 only)
+ */
+#include "gob_json_coroutine.hpp"
+
+#if GOB_JSON_HAS_COROUTINE
+
+#include "internal/gob_json_log.hpp"
+#include <sys/epoll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <cassert>
+
+namespace goblib { namespace json { namespace coro {
+
+// ----------------------------------------------------------------------------
+// EventLoop
+EventLoop::EventLoop() : _epfd(epoll_create1(EPOLL_CLOEXEC))
+{
+    if(_epfd < 0) { GOB_JSON_LOGE("Failed to epoll_create1:%s", std::strerror(errno)); }
+}
+
+EventLoop::~EventLoop()
+{
+    if(_epfd >= 0) { ::close(_epfd); }
+}
+
+bool EventLoop::watch(const int fd, std::coroutine_handle<> h)
+{
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+    ev.data.ptr = h.address();
+    // Re-arm if already registered.
+    if(epoll_ctl(_epfd, EPOLL_CTL_MOD, fd, &ev) != 0 &&
+       (errno != ENOENT || epoll_ctl(_epfd, EPOLL_CTL_ADD, fd, &ev) != 0))
+    {
+        GOB_JSON_LOGE("Failed to watch %d:%s", fd, std::strerror(errno));
+        return false; // Resume immediately, Readable returns false.
+    }
+    ++_waiting;
+    return true;
+}
+
+void EventLoop::forget(const int fd)
+{
+    epoll_ctl(_epfd, EPOLL_CTL_DEL, fd, nullptr);
+}
+
+size_t EventLoop::runOnce(const int timeoutMs)
+{
+    epoll_event evs[64];
+    int n;
+    while((n = epoll_wait(_epfd, evs, sizeof(evs) / sizeof(evs[0]), timeoutMs)) < 0 && errno == EINTR) {}
+    if(n < 0)
+    {
+        GOB_JSON_LOGE("Failed to epoll_wait:%s", std::strerror(errno));
+        return 0;
+    }
+    for(int i = 0; i < n; ++i)
+    {
+        --_waiting;
+        std::coroutine_handle<>::from_address(evs[i].data.ptr).resume();
+    }
+    return static_cast<size_t>(n);
+}
+
+// ----------------------------------------------------------------------------
+// AsyncSource
+AsyncSource::AsyncSource(EventLoop& loop, const int fd) : _loop(loop), _fd(fd)
+{
+    int fl = fcntl(_fd, F_GETFL, 0);
+    if(fl < 0 || fcntl(_fd, F_SETFL, fl | O_NONBLOCK) < 0)
+    {
+        GOB_JSON_LOGE("Failed to set O_NONBLOCK %d:%s", _fd, std::strerror(errno));
+    }
+}
+
+Task<ssize_t> AsyncSource::read(char* buf, const size_t len)
+{
+    for(;;)
+    {
+        ssize_t sz = ::read(_fd, buf, len);
+        if(sz >= 0) { co_return sz; }
+        if(errno == EINTR) { continue; }
+        if(errno != EAGAIN && errno != EWOULDBLOCK)
+        {
+            GOB_JSON_LOGE("Failed to read %d:%s", _fd, std::strerror(errno));
+            co_return sz;
+        }
+        // Retrying without the loop would spin.
+        if(!co_await _loop.readable(_fd)) { co_return -1; }
+    }
+}
+
+// ----------------------------------------------------------------------------
+// AsyncParser
+AsyncParser::Event& AsyncParser::Queue::add(const Kind k, const ElementPath* path)
+{
+    assert(size < CAPACITY);
+    auto& ev = events[(head + size++) % CAPACITY];
+    ev = Event{};
+    ev.kind = k;
+    ev.path = path;
+    return ev;
+}
+
+void AsyncParser::Queue::value(const ElementPath& path, const ElementValue& value)
+{
+    auto& ev = add(Kind::Value, &path);
+    ev.value = value; // Refers to the parser buffer, not overwritten until the next character
+    if(closing)
+    {
+        snapshot = path;
+        ev.path = &snapshot;
+    }
+}
+
+Task<bool> AsyncParser::parse(Handler& handler)
+{
+    _parser.setHandler(&handler);
+    if(_pos < _len) { _parser.parse(_buf + _pos, _len - _pos); } // Left by next()
+    _pos = _len = 0;
+    while(!_parser.hasError())
+    {
+        auto sz = co_await _src.read(_buf, sizeof(_buf));
+        if(sz <= 0)
+        {
+            _error = (sz < 0);
+            break;
+        }
+        _parser.parse(_buf, static_cast<size_t>(sz));
+    }
+    _parser.setHandler(&_queue);
+    co_return !hasError();
+}
+
+Task<std::optional<AsyncParser::Event>> AsyncParser::next()
+{
+    while(_queue.empty() && !hasError())
+    {
+        if(_pos == _len)
+        {
+            if(_eof) { break; }
+            auto sz = co_await _src.read(_buf, sizeof(_buf));
+            if(sz <= 0)
+            {
+                _eof = true;
+                _error = (sz < 0);
+                break;
+            }
+            _pos = 0;
+            _len = static_cast<size_t>(sz);
+        }
+        // A character at a time, so that the path and value of the events stay valid until the next call.
+        const char c = _buf[_pos++];
+        _queue.closing = (c == '}' || c == ']');
+        _parser.parse(c);
+    }
+    if(_queue.empty()) { co_return std::nullopt; }
+    co_return _queue.pop();
+}
+
+//
+}}}
+#endif
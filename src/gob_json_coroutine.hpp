@@ -0,0 +1,297 @@
+/*!
+  @file gob_json_coroutine.hpp
+  @brief C++20 coroutine layer for non-blocking sources. (Linux, C++20 only)
+ */
+#ifndef GOB_JSON_COROUTINE_HPP
+#define GOB_JSON_COROUTINE_HPP
+
+#if __cplusplus >= 202002L && defined(__has_include)
+# if __has_include(<coroutine>)
+#   include <coroutine>
+# endif
+#endif
+
+#if defined(__cpp_impl_coroutine) && defined(__cpp_lib_coroutine) && defined(__linux__) && !defined(ARDUINO)
+# define GOB_JSON_HAS_COROUTINE 1
+#else
+# define GOB_JSON_HAS_COROUTINE 0
+#endif
+
+#if GOB_JSON_HAS_COROUTINE
+
+#include "gob_json.hpp"
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <optional>
+#include <utility>
+#include <sys/types.h>
+
+namespace goblib { namespace json {
+/*!
+  @namespace coro
+  @brief Coroutine layer
+ */
+namespace coro {
+
+/*!
+  @class Task
+  @brief Lazy coroutine that can be awaited or started.
+  @tparam T Result type
+  @details co_await task resumes the awaiter when the task finishes. (Symmetric transfer)
+  For the top level, call start() and drive the EventLoop until done().
+ */
+template<typename T = void> class Task;
+
+namespace detail {
+template<typename P> struct FinalAwaiter
+{
+    bool await_ready() noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) noexcept
+    {
+        auto c = h.promise().continuation;
+        return c ? c : std::noop_coroutine();
+    }
+    void await_resume() noexcept {}
+};
+struct PromiseBase
+{
+    std::coroutine_handle<> continuation{};
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    void unhandled_exception() noexcept { std::abort(); } // No exceptions in this library.
+};
+//
+}
+
+template<typename T> class Task
+{
+  public:
+    struct promise_type : detail::PromiseBase
+    {
+        std::optional<T> result{};
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        detail::FinalAwaiter<promise_type> final_suspend() noexcept { return {}; }
+        template<typename U> void return_value(U&& v) { result.emplace(std::forward<U>(v)); }
+    };
+
+    Task(Task&& o) noexcept : _h(std::exchange(o._h, nullptr)) {}
+    Task& operator=(Task&& o) noexcept { if(this != &o) { destroy(); _h = std::exchange(o._h, nullptr); } return *this; }
+    ~Task() { destroy(); }
+
+    /*! @brief Run until the first suspension (Top level) */
+    void start() { if(_h && !_h.done()) { _h.resume(); } }
+    /*! @brief Finished? */
+    bool done() const { return !_h || _h.done(); }
+    /*! @brief Result (Valid after done) */
+    T& result() { return *_h.promise().result; }
+
+    bool await_ready() const noexcept { return done(); }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept
+    {
+        _h.promise().continuation = awaiter;
+        return _h;
+    }
+    T await_resume() { return std::move(*_h.promise().result); }
+
+  private:
+    explicit Task(std::coroutine_handle<promise_type> h) : _h(h) {}
+    void destroy() { if(_h) { _h.destroy(); _h = nullptr; } }
+    std::coroutine_handle<promise_type> _h{};
+};
+
+template<> class Task<void>
+{
+  public:
+    struct promise_type : detail::PromiseBase
+    {
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        detail::FinalAwaiter<promise_type> final_suspend() noexcept { return {}; }
+        void return_void() {}
+    };
+
+    Task(Task&& o) noexcept : _h(std::exchange(o._h, nullptr)) {}
+    Task& operator=(Task&& o) noexcept { if(this != &o) { destroy(); _h = std::exchange(o._h, nullptr); } return *this; }
+    ~Task() { destroy(); }
+
+    void start() { if(_h && !_h.done()) { _h.resume(); } }
+    bool done() const { return !_h || _h.done(); }
+
+    bool await_ready() const noexcept { return done(); }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept
+    {
+        _h.promise().continuation = awaiter;
+        return _h;
+    }
+    void await_resume() {}
+
+  private:
+    explicit Task(std::coroutine_handle<promise_type> h) : _h(h) {}
+    void destroy() { if(_h) { _h.destroy(); _h = nullptr; } }
+    std::coroutine_handle<promise_type> _h{};
+};
+
+/*!
+  @class EventLoop
+  @brief Minimal epoll loop that resumes coroutines waiting for readable file descriptors.
+  @note Single thread. A file descriptor can be awaited by one coroutine at a time.
+ */
+class EventLoop
+{
+  public:
+    EventLoop();
+    ~EventLoop();
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    /*!
+      @brief Awaitable that suspends until fd is readable (or closed)
+      @note co_await returns false without suspending if fd cannot be watched.
+     */
+    struct Readable
+    {
+        EventLoop& loop;
+        int fd;
+        bool watched{};
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> h) { return (watched = loop.watch(fd, h)); }
+        bool await_resume() const noexcept { return watched; }
+    };
+    /*! @brief Wait for fd to become readable */
+    Readable readable(const int fd) { return Readable{*this, fd}; }
+
+    /*!
+      @brief Wait for events and resume the coroutines
+      @param timeoutMs Timeout (-1: infinite)
+      @return Number of coroutines resumed
+     */
+    size_t runOnce(const int timeoutMs = -1);
+    /*! @brief Run while coroutines are waiting */
+    void run() { while(_waiting > 0) { runOnce(-1); } }
+    /*! @brief Number of waiting coroutines */
+    size_t waiting() const { return _waiting; }
+    /*! @brief Remove fd from the loop */
+    void forget(const int fd);
+
+  private:
+    bool watch(const int fd, std::coroutine_handle<> h);
+    int _epfd{-1};
+    size_t _waiting{};
+};
+
+/*!
+  @class AsyncSource
+  @brief Non-blocking file descriptor (socket, pipe...) read by coroutine
+  @note The file descriptor is set to O_NONBLOCK and is not closed by this class.
+ */
+class AsyncSource
+{
+  public:
+    AsyncSource(EventLoop& loop, const int fd);
+    ~AsyncSource() { _loop.forget(_fd); }
+    AsyncSource(const AsyncSource&) = delete;
+    AsyncSource& operator=(const AsyncSource&) = delete;
+
+    /*!
+      @brief Read bytes, suspending while no data arrived
+      @return Bytes read, 0 at EOF, negative on error
+     */
+    Task<ssize_t> read(char* buf, const size_t len);
+
+    int fd() const { return _fd; }
+
+  private:
+    EventLoop& _loop;
+    int _fd{-1};
+};
+
+/*!
+  @class AsyncParser
+  @brief StreamingParser driven by AsyncSource
+  @details parse() pumps all events into the handler.
+  next() pulls one event at a time, so that the coroutine can simply co_await the next value.
+  The event is a view of the parser (no allocation), valid until the next call of next().
+  @code
+  Task<void> consume(AsyncSource& src)
+  {
+      AsyncParser ap(src);
+      while(auto ev = co_await ap.next())
+      {
+          if(ev->kind == AsyncParser::Kind::Value) { ... ev->path->getKey(), ev->value.getInt() ... }
+      }
+  }
+  @endcode
+ */
+class AsyncParser
+{
+  public:
+    /*! @brief Event kind */
+    enum class Kind : uint8_t
+    {
+        StartDocument, EndDocument,
+        StartObject, EndObject,
+        StartArray, EndArray,
+        Value,
+    };
+    /*! @brief Event pulled by next() (Valid until the next call of next()) */
+    struct Event
+    {
+        Kind kind{};
+        const ElementPath* path{}; //!< nullptr for StartDocument and EndDocument
+        ElementValue value{};      //!< Value (Kind::Value)
+    };
+
+    explicit AsyncParser(AsyncSource& src) : _src(src), _parser(&_queue) {}
+
+    /*!
+      @brief Parse until EOF, passing events to the handler
+      @return True if EOF reached without read or parse errors
+     */
+    Task<bool> parse(Handler& handler);
+    /*!
+      @brief Next event
+      @return Event, std::nullopt at EOF or error
+     */
+    Task<std::optional<Event>> next();
+
+    /*! @brief Any errors? (Read or parse) */
+    bool hasError() const { return _error || _parser.hasError(); }
+    /*! @brief Underlying parser (e.g. addNumberSink) */
+    StreamingParser& parser() { return _parser; }
+
+  private:
+    // Events of the last character parsed by next()
+    struct Queue : public Handler
+    {
+        // A character emits up to 3 events. (e.g. value, end of array and end of document by ']')
+        static constexpr uint8_t CAPACITY = 4;
+
+        virtual void startDocument() override { add(Kind::StartDocument, nullptr); }
+        virtual void endDocument() override { add(Kind::EndDocument, nullptr); }
+        virtual void startObject(const ElementPath& path) override { add(Kind::StartObject, &path); }
+        virtual void endObject(const ElementPath& path) override { add(Kind::EndObject, &path); }
+        virtual void startArray(const ElementPath& path) override { add(Kind::StartArray, &path); }
+        virtual void endArray(const ElementPath& path) override { add(Kind::EndArray, &path); }
+        virtual void value(const ElementPath& path, const ElementValue& value) override;
+        virtual void whitespace(const char) override {}
+        Event& add(const Kind k, const ElementPath* path);
+        bool empty() const { return size == 0; }
+        Event pop() { --size; return events[head++ % CAPACITY]; }
+
+        Event events[CAPACITY]{};
+        uint8_t head{}, size{};
+        bool closing{};        // Parsing '}' or ']' that pops the path after the value
+        ElementPath snapshot{}; // Path of the value followed by the end of container
+    };
+
+    AsyncSource& _src;
+    Queue _queue{};
+    StreamingParser _parser;
+    bool _eof{}, _error{};
+    char _buf[4096]{};
+    size_t _pos{}, _len{}; // Not yet parsed by next()
+};
+
+//
+}}}
+#endif
+#endif
@@ -3,10 +3,40 @@
   @brief Derived handler using delegate object.
  */
 #include "gob_json_delegate_handler.hpp"
+#include "internal/gob_json_log.hpp"
 #include <cassert>
 
 namespace goblib { namespace json {
 
+namespace
+{
+// Flyweight for uninteresting objects.
+struct IgnoreDelegater : public DelegateHandler::Delegater
+{
+    virtual Delegater* startObject(const ElementPath& /*path*/) override { return this; }
+    virtual void dispose() override {}
+};
+IgnoreDelegater ignoreDelegater;
+}
+
+DelegateHandler::Delegater* DelegateHandler::Delegater::ignore()
+{
+    return &ignoreDelegater;
+}
+
+void DelegateHandler::pushDelegater(Delegater* o)
+{
+    assert(o);
+    if(_depth >= (int)(sizeof(_delegaters) / sizeof(_delegaters[0])))
+    {
+        GOB_JSON_LOGE("Delegater stack overflow");
+        assert(0 && "Delegater stack overflow");
+        o->dispose();
+        return;
+    }
+    _delegaters[_depth++] = o;
+}
+
 void DelegateHandler::startObject(const ElementPath& path)
 {
     // Delegate processing
@@ -15,10 +45,10 @@ void DelegateHandler::startObject(const ElementPath& path)
     {
         auto ndel = del->startObject(path);
         assert(ndel);
-        _delegaters.push(ndel);
+        pushDelegater(ndel ? ndel : Delegater::ignore());
         return;
     }
-    _delegaters.push(new Delegater());
+    pushDelegater(Delegater::ignore());
 }
 
 void DelegateHandler::endObject(const ElementPath& path)
@@ -28,8 +58,8 @@ void DelegateHandler::endObject(const ElementPath& path)
     if(del)
     {
         del->endObject(path);
-        delete _delegaters.top();
-        _delegaters.pop();
+        --_depth;
+        del->dispose();
     }
 }
 
@@ -56,7 +86,7 @@ void DelegateHandler::value(const ElementPath& path, const ElementValue& value)
 
 void DelegateHandler::endDocument()
 {
-    assert(_delegaters.empty());
+    assert(_depth == 0);
 }
 
 //
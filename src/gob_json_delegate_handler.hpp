@@ -7,13 +7,16 @@
 
 #include "gob_json_handler.hpp"
 #include "gob_json_element.hpp"
-#include <stack>
+#include <new>
+#include <utility>
+#include <type_traits>
 
 namespace goblib { namespace json {
 
 /*!
   @class DelegateHandler
   @brief Handler using delegate object.
+  @note The delegaters are held in the fixed length stack. (GOB_JSON_PARSER_STACK_MAX_DEPTH)
 */
 class DelegateHandler : public Handler
 {
@@ -27,12 +30,90 @@ class DelegateHandler : public Handler
         virtual ~Delegater(){}
         ///@name Delegate functions
         ///@{
-        virtual Delegater* startObject(const ElementPath& /*path*/) { return new Delegater(); }
+        /*!
+          @brief Start of the child object
+          @return Delegater for the child object. Default is ignore()
+         */
+        virtual Delegater* startObject(const ElementPath& /*path*/) { return ignore(); }
         virtual void endObject(const ElementPath& /*path*/){}
         virtual void startArray(const ElementPath& /*path*/) {}
         virtual void endArray(const ElementPath& /*path*/) {}
         virtual void value(const ElementPath& /*path*/, const ElementValue& /*value*/) {}
         ///@}
+
+        /*!
+          @brief Release this object after endObject.
+          @note Default is delete this. (Assume allocated by new)
+         */
+        virtual void dispose() { delete this; }
+
+        /*! @brief Shared delegater that does nothing. Never allocated and disposed */
+        static Delegater* ignore();
+    };
+
+    /*!
+      @class Pool
+      @brief Fixed capacity storage of delegaters.
+      @tparam D Type of delegater
+      @tparam N Capacity (Maximum number of objects alive at the same time)
+      @code
+      DelegaterPool<ItemDelegater, 2> _pool; // member of your delegater or handler.
+      Delegater* startObject(const ElementPath& path) override { return _pool.create(args...); }
+      @endcode
+     */
+    template<class D, size_t N = 1> class Pool
+    {
+      public:
+        Pool() = default;
+        Pool(const Pool&) = delete;
+        Pool& operator=(const Pool&) = delete;
+
+        /*!
+          @brief Construct delegater in the pool
+          @return Pointer to created object, nullptr if exhausted
+          @note Created object is returned to the pool by dispose().
+         */
+        template<typename... Args> D* create(Args&&... args)
+        {
+            for(size_t i = 0; i < N; ++i)
+            {
+                if(!_used[i])
+                {
+                    _used[i] = true;
+                    return new(&_slots[i]) Pooled(this, std::forward<Args>(args)...);
+                }
+            }
+            return nullptr;
+        }
+        /*! @brief Number of available slots */
+        size_t available() const
+        {
+            size_t cnt{};
+            for(auto& u : _used) { cnt += !u; }
+            return cnt;
+        }
+
+      private:
+        struct Pooled : public D
+        {
+            template<typename... Args> explicit Pooled(Pool* p, Args&&... args)
+                    : D(std::forward<Args>(args)...), _pool(p) {}
+            virtual void dispose() override
+            {
+                auto pool = _pool;
+                this->~Pooled();
+                pool->release(this);
+            }
+            Pool* _pool;
+        };
+        void release(void* p)
+        {
+            auto idx = static_cast<typename std::aligned_storage<sizeof(Pooled), alignof(Pooled)>::type*>(p) - _slots;
+            _used[idx] = false;
+        }
+
+        typename std::aligned_storage<sizeof(Pooled), alignof(Pooled)>::type _slots[N];
+        bool _used[N]{};
     };
 
     virtual void startDocument() override {}
@@ -45,12 +126,16 @@ class DelegateHandler : public Handler
     virtual void value(const ElementPath& path, const ElementValue& value) override;
 
   protected:
-    Delegater* currentDelegater() const { return !_delegaters.empty() ? _delegaters.top() : nullptr; }
-    void pushDelegater(Delegater* o) { _delegaters.push(o); }
+    Delegater* currentDelegater() const { return _depth > 0 ? _delegaters[_depth - 1] : nullptr; }
+    void pushDelegater(Delegater* o);
 
   private:
-    std::stack<Delegater*> _delegaters;
+    Delegater* _delegaters[GOB_JSON_PARSER_STACK_MAX_DEPTH]{};
+    int _depth{};
 };
+
+/*! @brief Alias of DelegateHandler::Pool */
+template<class D, size_t N = 1> using DelegaterPool = DelegateHandler::Pool<D, N>;
 //
 }}
 #endif
@@ -7,34 +7,60 @@
 
 #include "gob_json_typedef.hpp"
 #include "gob_json_element_value.hpp"
+#include "gob_json_writer.hpp"
 #include "internal/gob_json_log.hpp"
+#include "internal/gob_json_number.hpp"
 #include <cinttypes>
 #include <cstdlib>
 #include <cstring>
 #include <array>
 #include <vector>
+#include <string>
 #include <type_traits>
 #include <cassert>
+#include <cmath>
 
 namespace goblib { namespace json {
 
-// Type is std::vector?
+// Type is std::vector? (Any allocator)
 template <class T> struct is_std_vector : public std::false_type { };
-template <class T> struct is_std_vector<std::vector<T> > : public std::true_type { };
+template <class T, class A> struct is_std_vector<std::vector<T, A> > : public std::true_type { };
 // Type is std::array?
 template <class T> struct is_std_array : public std::false_type { };
 template <class T, size_t N> struct is_std_array<std::array<T, N> > : public std::true_type { };
 
+// Type is std::basic_string<char>? (Any allocator)
+template <class T> struct is_std_basic_string : public std::false_type { };
+template <class Tr, class A> struct is_std_basic_string<std::basic_string<char, Tr, A> > : public std::true_type { };
+// Type is string_t or std::basic_string<char>?
+template <class T> struct is_string
+{
+    static constexpr bool value = std::is_same<T, string_t>::value || is_std_basic_string<T>::value;
+};
+
+// Type is char[N]? (Fixed capacity string)
+template <class T> struct is_char_array
+{
+    static constexpr bool value = std::is_array<T>::value && std::rank<T>::value == 1 &&
+            std::is_same<typename std::remove_extent<T>::type, char>::value;
+};
+
 // Integer type determination excluding bool.
 template <typename T> struct is_integral_exclude_bool
 {
     static constexpr bool value = !std::is_same<T,bool>::value && std::is_integral<T>::value;
 };
+// Type that can be written as a single JSON value.
+template <typename T> struct is_element_scalar
+{
+    static constexpr bool value = std::is_arithmetic<T>::value || is_string<T>::value;
+};
 
 /*!
   @class ElementBase
   @brief Base class
   Call virtual store() => each _store() (SFINAE)
+  Call virtual write() => each _write() (SFINAE)
  */
 struct ElementBase
 {
@@ -44,6 +70,11 @@ struct ElementBase
     bool operator==(const char* k) { return strcmp(k, key) == 0; } //!< Compare key
 
     virtual void store(const ElementValue& s, const int index = -1) = 0;
+    /*!
+      @brief Write key and value as the member of JSON object
+      @note Writes null unless overridden, so that subclasses written before write() existed still compile.
+     */
+    virtual void write(StreamingWriter& w) const { w.key(key).value(nullptr); }
 };
 
 /*!
@@ -54,17 +85,23 @@ struct ElementBase
 template<typename T> struct Element : public ElementBase
 {
     T* value{}; // Pointer of store target.
+    size_t capacity{}; // Expected number of elements for std::vector.
 
     /*! @brief Constructor
       @param key JSON key
       @param p Pointer of object
+      @param capacityHint Expected length of JSON array. Reserve when the first element is stored. (std::vector)
      */
-    Element(const char* key, T* p) : ElementBase(key), value(p) { assert(p); }
+    Element(const char* key, T* p, const size_t capacityHint = 0) : ElementBase(key), value(p), capacity(capacityHint) { assert(p); }
     /*!
       @param ev Value
       @param index <0: Object >=0:Array
      */
     virtual void store(const ElementValue& ev, const int index = -1) override { _store(ev, index); }
+    /*!
+      @param w Writer
+     */
+    virtual void write(StreamingWriter& w) const override { w.key(key); _write(w); }
 
     ///@name Store functions for generic type.
     ///@{
@@ -74,18 +111,19 @@ template<typename T> struct Element : public ElementBase
     void _store(const ElementValue& ev, const int)
     {
         //GOB_JSON_LOGD("int");
-        *value = !ev.isString() ? ev.getInt() : std::strtoumax(ev.toString().c_str(), nullptr, 10);
+        *value = _toIntegral<U>(ev);
     }
     //! @brief Array or pointer of integers
     template<typename U = T,
              typename std::enable_if<std::is_pointer<typename std::decay<U>::type>::value &&
-                                     is_integral_exclude_bool<typename std::remove_pointer<typename std::decay<U>::type>::type>::value,
+                                     is_integral_exclude_bool<typename std::remove_pointer<typename std::decay<U>::type>::type>::value &&
+                                     !is_char_array<U>::value,
                                      std::nullptr_t>::type = nullptr>
     void _store(const ElementValue& ev, const int index)
     {
         //GOB_JSON_LOGD("int a/p %d", index);
         assert(index >= 0);
-        *(*value + index) = !ev.isString() ? ev.getInt() : std::strtoumax(ev.toString().c_str(), nullptr, 10);
+        *(*value + index) = _toIntegral<typename std::remove_pointer<typename std::decay<U>::type>::type>(ev);
     }
     //! @brief std::array<integer, N>
     template<typename U = T,
@@ -96,17 +134,18 @@ template<typename T> struct Element : public ElementBase
     {
         //GOB_JSON_LOGD("int a %d", index);
         assert(index >= 0);
-        (*value)[index] = !ev.isString() ? ev.getInt() : std::strtoumax(ev.toString().c_str(), nullptr, 10);
+        (*value)[index] = _toIntegral<typename U::value_type>(ev);
     }
     //! @brief vector<integer>
     template<typename U = T,
              typename std::enable_if<is_std_vector<U>::value &&
                                      is_integral_exclude_bool<typename U::value_type>::value,
                                      std::nullptr_t>::type = nullptr>
-    void _store(const ElementValue& ev, const int)
+    void _store(const ElementValue& ev, const int index)
     {
         //GOB_JSON_LOGD("int v");
-        value->emplace_back(!ev.isString() ? ev.getInt() : std::strtoumax(ev.toString().c_str(), nullptr, 10));
+        _reserve(index);
+        value->emplace_back(_toIntegral<typename U::value_type>(ev));
     }
 
     //! @brief Floating-point
@@ -115,7 +154,7 @@ template<typename T> struct Element : public ElementBase
     void _store(const ElementValue& ev, const int)
     {
         //GOB_JSON_LOGD("float");
-        *value = !ev.isString() ? ev.getFloat() : std::strtod(ev.toString().c_str(), nullptr);
+        *value = _toFloat<U>(ev);
     }
     //! @brief Array or pointer of floating-points
     template<typename U = T,
@@ -126,7 +165,7 @@ template<typename T> struct Element : public ElementBase
     {
         //GOB_JSON_LOGD("float a/p");
         assert(index >= 0);
-        *(*value + index) = !ev.isString() ? ev.getFloat() : std::strtod(ev.toString().c_str(), nullptr);
+        *(*value + index) = _toFloat<typename std::remove_pointer<typename std::decay<U>::type>::type>(ev);
     }
     //! @brief std::array<floating-point, N>
     template<typename U = T,
@@ -137,17 +176,18 @@ template<typename T> struct Element : public ElementBase
     {
         //GOB_JSON_LOGD("float a");
         assert(index >= 0);
-        (*value)[index] = !ev.isString() ? ev.getFloat() : std::strtod(ev.toString().c_str(), nullptr);
+        (*value)[index] = _toFloat<typename U::value_type>(ev);
     }
     //! @brief vector<floating-point>
     template<typename U = T,
              typename std::enable_if<is_std_vector<U>::value &&
                                      std::is_floating_point<typename U::value_type>::value,
                                      std::nullptr_t>::type = nullptr>
-    void _store(const ElementValue& ev, const int)
+    void _store(const ElementValue& ev, const int index)
     {
         //GOB_JSON_LOGD("float b");
-        value->emplace_back(!ev.isString() ? ev.getFloat() : std::strtod(ev.toString().c_str(), nullptr));
+        _reserve(index);
+        value->emplace_back(_toFloat<typename U::value_type>(ev));
     }
 
     //! @brief bool
@@ -156,7 +196,7 @@ template<typename T> struct Element : public ElementBase
     void _store(const ElementValue& ev, const int)
     {
         //GOB_JSON_LOGD("bool");        
-        *value = !ev.isString() ? ev.getBool() : (ev.toString() == "true");
+        *value = _toBool(ev);
     }
     //! @brief Array or pointer of bool
     template<typename U = T,
@@ -167,7 +207,7 @@ template<typename T> struct Element : public ElementBase
     {
         //GOB_JSON_LOGD("bool a/p %d", index);
         assert(index >= 0);
-        *(*value + index) = !ev.isString() ? ev.getBool() : (ev.toString() == "true");
+        *(*value + index) = _toBool(ev);
     }
     //! @brief std::array<bool,N>
     template<typename U = T,
@@ -178,27 +218,28 @@ template<typename T> struct Element : public ElementBase
     {
         //GOB_JSON_LOGD("bool a %d", index);
         assert(index >= 0);
-        (*value)[index] = !ev.isString() ? ev.getBool() : (ev.toString() == "true");
+        (*value)[index] = _toBool(ev);
     }
     //! @brief std::vector<bool>
     template<typename U = T,
              typename std::enable_if<is_std_vector<U>::value &&
                                      std::is_same<typename U::value_type, bool>::value,
                                      std::nullptr_t>::type = nullptr>
-    void _store(const ElementValue& ev, const int)
+    void _store(const ElementValue& ev, const int index)
     {
         //GOB_JSON_LOGD("bool v");
+        _reserve(index);
 #ifdef __clang__
         // std::vector<bool> is different from ordinary vector because it is specialized. emplace_back cannot use Clang.
-        value->push_back(!ev.isString() ? ev.getBool() : (ev.toString() == "true"));        
+        value->push_back(_toBool(ev));
 #else        
-        value->emplace_back(!ev.isString() ? ev.getBool() : (ev.toString() == "true"));
+        value->emplace_back(_toBool(ev));
 #endif
     }
     
-    //@brief string_t (String or std::string)
+    //@brief string_t (String or std::string), std::basic_string<char> with any allocator
     template<typename U = T,
-             typename std::enable_if<std::is_same<U, string_t>::value, std::nullptr_t>::type = nullptr>
+             typename std::enable_if<is_string<U>::value, std::nullptr_t>::type = nullptr>
     void _store(const ElementValue& ev, const int)
     {
         //GOB_JSON_LOGD("str");        
@@ -207,7 +248,7 @@ template<typename T> struct Element : public ElementBase
     //! @brief Array or pointer of string_t
     template<typename U = T,
              typename std::enable_if<std::is_pointer<typename std::decay<U>::type>::value && 
-                                     std::is_same<typename std::remove_pointer<typename std::decay<U>::type>::type, string_t>::value,
+                                     is_string<typename std::remove_pointer<typename std::decay<U>::type>::type>::value,
                                      std::nullptr_t>::type = nullptr>
     void _store(const ElementValue& ev, const int index)
     {
@@ -218,7 +259,7 @@ template<typename T> struct Element : public ElementBase
     //! @brief std::array<string_t, N>
     template<typename U = T,
              typename std::enable_if<is_std_array<U>::value &&
-                                     std::is_same<typename U::value_type, string_t>::value,
+                                     is_string<typename U::value_type>::value,
                                      std::nullptr_t>::type = nullptr>
     void _store(const ElementValue& ev, const int index)
     {
@@ -229,22 +270,232 @@ template<typename T> struct Element : public ElementBase
     //!@brief vector<string_t>
     template<typename U = T,
              typename std::enable_if<is_std_vector<U>::value &&
-                                     std::is_same<typename U::value_type, string_t>::value,
+                                     is_string<typename U::value_type>::value,
                                      std::nullptr_t>::type = nullptr>
-    void _store(const ElementValue& ev,const int)
+    void _store(const ElementValue& ev,const int index)
     {
         //GOB_JSON_LOGD("str v");
-        value->emplace_back(ev.isString() ? ev.getString(): "");
+        _reserve(index);
+        value->emplace_back(_makeString<typename U::value_type>(ev.isString() ? ev.getString(): "", value->get_allocator()));
+    }
+    //! @brief char[N] (Fixed capacity string, truncated if too long)
+    template<typename U = T,
+             typename std::enable_if<is_char_array<U>::value, std::nullptr_t>::type = nullptr>
+    void _store(const ElementValue& ev, const int)
+    {
+        //GOB_JSON_LOGD("char[N]");
+        _copyString(*value, std::extent<U>::value, ev.isString() ? ev.getString() : "");
+    }
+    //! @brief char[M][N] (Array of fixed capacity string)
+    template<typename U = T,
+             typename std::enable_if<std::is_array<U>::value &&
+                                     is_char_array<typename std::remove_extent<U>::type>::value,
+                                     std::nullptr_t>::type = nullptr>
+    void _store(const ElementValue& ev, const int index)
+    {
+        //GOB_JSON_LOGD("char[M][N] %d", index);
+        assert(index >= 0);
+        if(index < 0 || index >= (int)std::extent<U>::value) { return; }
+        _copyString((*value)[index], std::extent<U, 1>::value, ev.isString() ? ev.getString() : "");
     }
     ///@}
 
+    ///@name Conversion without memory allocation
+    ///@{
+    template<typename V> static V _toIntegral(const ElementValue& ev)
+    {
+        // Range-checked directly from the text. (Raw number or string)
+        const char* text = ev.isString() ? ev.getString() : (ev.isInt() ? ev.getRaw() : nullptr);
+        V v{};
+        if(!text && ev.isFloat())
+        {
+            if(!number::floatToIntegral(ev.getFloat(), v)) { GOB_JSON_LOGW("Out of range or not a number [%g]", (double)ev.getFloat()); }
+            return v;
+        }
+        if(!text) { return static_cast<V>(ev.getInt()); }
+        if(!number::parseIntegral(text, v)) { GOB_JSON_LOGW("Out of range or not a number [%s]", text); }
+        return v;
+    }
+    template<typename V> static V _toFloat(const ElementValue& ev)
+    {
+        const char* text = ev.isString() ? ev.getString() : ev.getRaw();
+        return text ? number::parseFloat<V>(text) : static_cast<V>(ev.getFloat());
+    }
+    static bool _toBool(const ElementValue& ev)
+    {
+        return !ev.isString() ? ev.getBool() : (std::strcmp(ev.getString(), "true") == 0);
+    }
+    // Copy string to fixed capacity buffer. Truncate at UTF-8 character boundary.
+    static void _copyString(char* dst, const size_t capacity, const char* src)
+    {
+        if(capacity == 0) { return; }
+        auto e = static_cast<const char*>(std::memchr(src, '\0', capacity));
+        size_t len = e ? e - src : capacity - 1;
+        if(!e)
+        {
+            GOB_JSON_LOGW("Truncated [%s]", src);
+            while(len > 0 && (static_cast<uint8_t>(src[len]) & 0xC0) == 0x80) { --len; }
+        }
+        std::memcpy(dst, src, len);
+        dst[len] = '\0';
+    }
+    ///@}
+
+    //! @brief Make string element with the allocator of the container.
+    template<typename V, typename A,
+             typename std::enable_if<is_std_basic_string<V>::value, std::nullptr_t>::type = nullptr>
+    static V _makeString(const char* s, const A& alloc) { return V(s, typename V::allocator_type(alloc)); }
+    template<typename V, typename A,
+             typename std::enable_if<!is_std_basic_string<V>::value, std::nullptr_t>::type = nullptr>
+    static V _makeString(const char* s, const A&) { return V(s); }
+
+    //! @brief Reserve std::vector by capacity hint before the first element.
+    template<typename U = T,
+             typename std::enable_if<is_std_vector<U>::value, std::nullptr_t>::type = nullptr>
+    void _reserve(const int index)
+    {
+        if(index <= 0 && capacity > value->capacity()) { value->reserve(capacity); }
+    }
+
     //
     template<std::nullptr_t U = nullptr>
     void _store(...)
     {
         assert(0 && "The value cannot be obtained because the appropriate TEMPLATE IS NOT PROVIDED");
     }
+
+    ///@name Write functions for generic type.
+    ///@{
+    /*! @brief Integer, floating-point, bool and string_t */
+    template<typename U = T,
+             typename std::enable_if<is_element_scalar<U>::value, std::nullptr_t>::type = nullptr>
+    void _write(StreamingWriter& w) const
+    {
+        _writeValue(w, *value);
+    }
+    /*! @brief Array of them */
+    template<typename U = T,
+             typename std::enable_if<std::is_array<U>::value && !is_char_array<U>::value &&
+                                     is_element_scalar<typename std::remove_extent<U>::type>::value,
+                                     std::nullptr_t>::type = nullptr>
+    void _write(StreamingWriter& w) const
+    {
+        w.beginArray();
+        for(auto& e : *value) { _writeValue(w, e); }
+        w.endArray();
+    }
+    /*! @brief std::array and std::vector of them */
+    template<typename U = T,
+             typename std::enable_if<(is_std_array<U>::value || is_std_vector<U>::value) &&
+                                     is_element_scalar<typename U::value_type>::value,
+                                     std::nullptr_t>::type = nullptr>
+    void _write(StreamingWriter& w) const
+    {
+        w.beginArray();
+        for(auto&& e : *value) { _writeValue(w, static_cast<typename U::value_type>(e)); } // std::vector<bool> returns proxy
+        w.endArray();
+    }
+    /*! @brief char[N] */
+    template<typename U = T,
+             typename std::enable_if<is_char_array<U>::value, std::nullptr_t>::type = nullptr>
+    void _write(StreamingWriter& w) const
+    {
+        _writeValue(w, *value);
+    }
+    /*! @brief char[M][N] */
+    template<typename U = T,
+             typename std::enable_if<std::is_array<U>::value &&
+                                     is_char_array<typename std::remove_extent<U>::type>::value,
+                                     std::nullptr_t>::type = nullptr>
+    void _write(StreamingWriter& w) const
+    {
+        w.beginArray();
+        for(auto& e : *value) { _writeValue(w, e); }
+        w.endArray();
+    }
+    ///@}
+
+    template<size_t N> static void _writeValue(StreamingWriter& w, const char (&s)[N])
+    {
+        auto e = static_cast<const char*>(std::memchr(s, '\0', N));
+        w.value(s, e ? e - s : N);
+    }
+    template<typename V,
+             typename std::enable_if<std::is_integral<V>::value, std::nullptr_t>::type = nullptr>
+    static void _writeValue(StreamingWriter& w, const V& v) { w.value(v); }
+    // Always in floating-point form, whole values would be read back as Int. (1.0f => "1.0")
+    template<typename V,
+             typename std::enable_if<std::is_floating_point<V>::value, std::nullptr_t>::type = nullptr>
+    static void _writeValue(StreamingWriter& w, const V& v)
+    {
+        if(!std::isfinite(v)) { w.value(v); return; } // null
+        char tmp[number::FORMAT_MAX_LENGTH + 2];
+        auto len = number::formatFloat(tmp, v);
+        if(!std::memchr(tmp, '.', len) && !std::memchr(tmp, 'e', len) && !std::memchr(tmp, 'E', len) && !std::memchr(tmp, 'n', len))
+        {
+            tmp[len++] = '.';
+            tmp[len++] = '0';
+        }
+        w.rawValue(tmp, len);
+    }
+    template<typename V,
+             typename std::enable_if<is_string<V>::value, std::nullptr_t>::type = nullptr>
+    static void _writeValue(StreamingWriter& w, const V& v) { w.value(v.c_str(), v.length()); }
+
+    // Pointer (The number of elements is unknown) or not provided type.
+    template<class W>
+    void _write(W& w) const
+    {
+        // The key is already written, keep the output valid.
+        GOB_JSON_LOGE("The value cannot be written because the appropriate TEMPLATE IS NOT PROVIDED [%s]", this->key);
+        w.value(nullptr);
+    }
+};
+
+///@cond
+template<typename... Es> struct ElementsWriter;
+template<> struct ElementsWriter<>
+{
+    static void write(StreamingWriter&) {}
 };
+template<typename E, typename... Es> struct ElementsWriter<E, Es...>
+{
+    static void write(StreamingWriter& w, const E& e, const Es&... es)
+    {
+        e.E::write(w); // Qualified call, no virtual dispatch.
+        ElementsWriter<Es...>::write(w, es...);
+    }
+};
+///@endcond
+
+/*!
+  @brief Write elements as the members of JSON object.
+  @details The sequence of calls is expanded at compile time from the argument list.
+  @code
+  Element<decltype(v.i)> e_i { "integer", &v.i };
+  Element<decltype(v.s)> e_s { "string",  &v.s };
+  writer.key("values");
+  writeObject(writer, e_i, e_s); // "values":{"integer":...,"string":...}
+  @endcode
+ */
+template<typename... Es> void writeMembers(StreamingWriter& w, const Es&... es)
+{
+    ElementsWriter<Es...>::write(w, es...);
+}
+/*! @brief Write elements as JSON object */
+template<typename... Es> void writeObject(StreamingWriter& w, const Es&... es)
+{
+    w.beginObject();
+    writeMembers(w, es...);
+    w.endObject();
+}
+/*! @brief Write table of elements as JSON object */
+template<size_t N> void writeObject(StreamingWriter& w, ElementBase* const (&tbl)[N])
+{
+    w.beginObject();
+    for(auto& e : tbl) { e->write(w); }
+    w.endObject();
+}
 //
 }}
 #endif
@@ -75,5 +75,53 @@ string_t ElementPath::toString() const
     return s;
 }
 #endif
+
+bool ElementPath::match(const char* pattern) const
+{
+    auto p = pattern;
+    for(int index = 0; index < count; index++)
+    {
+        auto& sel = selectors[index];
+        if(sel.isObject())
+        {
+            if(index > 0 && *p++ != '.') { return false; }
+            auto len = std::strlen(sel.key);
+            if(std::strncmp(p, sel.key, len) != 0) { return false; }
+            p += len;
+            continue;
+        }
+        if(*p++ != '[') { return false; }
+        if(*p == '*') { ++p; }
+        else
+        {
+            if(*p < '0' || *p > '9') { return false; }
+            int v{};
+            while(*p >= '0' && *p <= '9') { v = v * 10 + (*p++ - '0'); }
+            if(v != sel.index) { return false; }
+        }
+        if(*p++ != ']') { return false; }
+    }
+    return *p == '\0';
+}
+
+size_t ElementPath::toPattern(char* buf, const size_t len) const
+{
+    if(!buf || !len) { return 0; }
+    size_t pos{};
+    auto put = [&](const char* s) { while(*s && pos + 1 < len) { buf[pos++] = *s++; } };
+    for(int index = 0; index < count; index++)
+    {
+        auto& sel = selectors[index];
+        if(sel.isObject())
+        {
+            if(index > 0) { put("."); }
+            put(sel.key);
+            continue;
+        }
+        put("[*]");
+    }
+    buf[pos] = '\0';
+    return pos;
+}
 //
 }}
@@ -61,6 +61,9 @@ class ElementSelector
     char key[GOB_JSON_PARSER_KEY_MAX_LENGTH]{0,};
     friend class ElementPath;
     friend class StreamingParser;
+    friend class PipelineHandler;
+    friend class TapePlayer;
+    friend class BinaryParser;
 };
 
 /*!
@@ -71,6 +74,20 @@ class ElementSelector
 class ElementPath
 {
   public:
+    ElementPath() = default;
+    /*! @brief Copy the levels in use (getCurrent() points into the copy) */
+    ElementPath(const ElementPath& o) { *this = o; }
+    ElementPath& operator=(const ElementPath& o)
+    {
+        if(this != &o)
+        {
+            count = o.count;
+            for(int i = 0; i < count; ++i) { selectors[i] = o.selectors[i]; }
+            current = count > 0 ? &selectors[count - 1] : nullptr;
+        }
+        return *this;
+    }
+
     int getCount() const { return count; }
 
     /*! @brief Gets current element selector. */
@@ -110,6 +127,21 @@ class ElementPath
     */    
     string_t toString() const;
 
+    /*!
+      @brief Compare with the path pattern without building string.
+      @param pattern Same notation as toString(). "[*]" matches any index.
+      e.g. "weather[0].id", "weather[*].id", "samples"
+     */
+    bool match(const char* pattern) const;
+    /*!
+      @brief Builds the path with array indices collapsed to "[*]" without allocation.
+      @param buf Output (Null terminated, truncated if not enough)
+      @param len Size of buf
+      @return Length of the pattern
+      e.g. "weather[*].id"
+     */
+    size_t toPattern(char* buf, const size_t len) const;
+
   protected:
     int getIndex(const ElementSelector* selector) const { return (selector != nullptr) ? selector->index : -1; }
     const char* getKey(const ElementSelector* selector) const { return (selector != nullptr) ? selector->key : "\0"; }
@@ -121,6 +153,9 @@ class ElementPath
     ElementSelector* current{nullptr};
     ElementSelector selectors[GOB_JSON_PARSER_STACK_MAX_DEPTH]{};
     friend class StreamingParser;
+    friend class PipelineHandler;
+    friend class TapePlayer;
+    friend class BinaryParser;
 };
 
 //
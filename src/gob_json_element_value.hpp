@@ -7,12 +7,16 @@
 
 #include <cstdint>
 #include <cstddef>
+#include <cstdlib>
 #include "gob_json_typedef.hpp"
+#include "internal/gob_json_number.hpp"
 
 namespace goblib { namespace json {
 /*!
   @struct ElementValue
   @brief Structure in which JSON values are stored.
+  @note Numbers from the parser hold the raw text and are converted on demand by getInt()/getFloat().
+  The raw text is valid only during Handler::value.
  */
 struct ElementValue
 {
@@ -29,6 +33,14 @@ struct ElementValue
         String,
         Bool,
     };
+    /*! @enum NumberFlag Lexical features of the raw number */
+    enum NumberFlag : uint8_t
+    {
+        Negative = 0x01, //!< Leading '-'
+        Fraction = 0x02, //!< Has '.'
+        Exponent = 0x04, //!< Has 'e' or 'E'
+    };
+
     ///@name Setter
     ///@{
     /*! @brief From integral value */
@@ -36,6 +48,7 @@ struct ElementValue
     {
         data.numValue = value;
         type = Type::Int;
+        clearRaw();
         return *this;
     }
     /*! @brief From floating-point value */
@@ -43,6 +56,7 @@ struct ElementValue
     {
         data.floatValue = value;
         type = Type::Float;
+        clearRaw();
         return *this;
     }
     /*! @brief From boolean value */
@@ -50,6 +64,7 @@ struct ElementValue
     {
         data.boolValue = value;
         type = Type::Bool;
+        clearRaw();
         return *this;
     }
     /*! @brief From string value */
@@ -57,12 +72,29 @@ struct ElementValue
     {
         data.stringValue = value;
         type = Type::String;
+        clearRaw();
         return *this;
     }
     /*! @brief Null value */
     ElementValue with()
     {
         type = Type::Null;
+        clearRaw();
+        return *this;
+    }
+    /*!
+      @brief From raw number text (Not converted)
+      @param text Null-terminated number text
+      @param len Length of text
+      @param flags NumberFlag
+      @note Float if fraction or exponent exists, otherwise Int.
+     */
+    ElementValue withNumber(const char* text, const size_t len, const uint8_t flags)
+    {
+        data.stringValue = text;
+        type = (flags & (Fraction | Exponent)) ? Type::Float : Type::Int;
+        rawLength = len;
+        numberFlags = flags;
         return *this;
     }
     ///@}
@@ -70,14 +102,48 @@ struct ElementValue
     ///@name Getter
     ///@warning Note that I have not checked to see if it is the correct type.
     ///@{
-    /*! @brief Get the integer value*/
-    inline number_t getInt() const       { return data.numValue;  }
-    /*! @brief Get the floating-point value*/
-    inline fp_t getFloat() const         { return data.floatValue;}
+    /*!
+      @brief Get the integer value
+      @note Negative value is stored as two's complement. Float is truncated, and clamped to the range of intmax_t.
+     */
+    number_t getInt() const
+    {
+        if(hasRaw())
+        {
+            if(isFloat()) { return floatToInt(getFloat()); }
+            if(numberFlags & Negative)
+            {
+                intmax_t v{};
+                number::parseIntegral(data.stringValue, v);
+                return static_cast<number_t>(v);
+            }
+            number_t v{};
+            number::parseIntegral(data.stringValue, v);
+            return v;
+        }
+        return isFloat() ? floatToInt(data.floatValue) : data.numValue;
+    }
+    /*! @brief Get the floating-point value */
+    fp_t getFloat() const
+    {
+        if(hasRaw()) { return std::strtod(data.stringValue, nullptr); }
+        return isInt() ? static_cast<fp_t>(data.numValue) : data.floatValue;
+    }
     /*! @brief Get the boolean value*/
     inline bool getBool() const          { return data.boolValue; }
     /*! @brief Get the string value */
     inline const char* getString() const { return data.stringValue; }
+    /*!
+      @brief Get the raw number text for exact passthrough
+      @return Null-terminated text, nullptr if not from raw text
+     */
+    inline const char* getRaw() const { return hasRaw() ? data.stringValue : nullptr; }
+    /*! @brief Length of the raw number text */
+    inline size_t getRawLength() const { return rawLength; }
+    /*! @brief NumberFlag of the raw number text */
+    inline uint8_t getNumberFlags() const { return numberFlags; }
+    /*! @brief Has raw number text? */
+    inline bool hasRaw() const { return rawLength != 0; }
     ///@}
 
     ///@name Detect type
@@ -104,7 +170,7 @@ struct ElementValue
         string_t s("?unknown?");
         switch(type)
         {
-        case Type::Int:    s = formatString("%jd", getInt());    break;
+        case Type::Int:    s = hasRaw() ? getRaw() : formatString("%jd", getInt()); break;
         case Type::Float:  s = formatString("%f",  getFloat());  break;
         case Type::String: s = formatString("%s",  getString()); break;
         case Type::Bool:   s = getBool() ? "true" : "false";     break;
@@ -114,6 +180,14 @@ struct ElementValue
     }
 
   private:
+    void clearRaw() { rawLength = 0; numberFlags = 0; }
+    static number_t floatToInt(const double v)
+    {
+        intmax_t i{};
+        number::floatToIntegral(v, i);
+        return static_cast<number_t>(i);
+    }
+
     union Variant
     {
         bool boolValue;
@@ -123,6 +197,8 @@ struct ElementValue
     };
     Variant data{};
     Type type{Type::Null};
+    uint8_t numberFlags{};
+    size_t rawLength{}; // Not zero if data.stringValue is raw number text
 };
 
 //
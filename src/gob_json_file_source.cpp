@@ -0,0 +1,90 @@
+/*!
+  @file gob_json_file_source.cpp
+  @brief Memory-mapped file source for StreamingParser. (Native only)
+ */
+#include "gob_json_file_source.hpp"
+
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(ARDUINO)
+
+#include "internal/gob_json_log.hpp"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+namespace goblib { namespace json {
+
+namespace
+{
+size_t pageSize()
+{
+    static const size_t sz = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return sz;
+}
+//
+}
+
+bool MappedFileSource::open(const char* path)
+{
+    close();
+    _fd = ::open(path, O_RDONLY);
+    if(_fd < 0)
+    {
+        GOB_JSON_LOGE("Failed to open %s:%s", path, std::strerror(errno));
+        return false;
+    }
+    struct stat st{};
+    if(fstat(_fd, &st) != 0)
+    {
+        GOB_JSON_LOGE("Failed to stat %s:%s", path, std::strerror(errno));
+        close();
+        return false;
+    }
+    _size = static_cast<uint64_t>(st.st_size);
+    return true;
+}
+
+void MappedFileSource::close()
+{
+    if(_fd >= 0) { ::close(_fd); }
+    _fd = -1;
+    _size = 0;
+}
+
+void MappedFileSource::setWindowSize(const size_t sz)
+{
+    auto ps = pageSize();
+    _window = sz ? (sz + ps - 1) / ps * ps : ps;
+}
+
+bool MappedFileSource::parse(StreamingParser& parser)
+{
+    if(!isOpen()) { return false; }
+
+    uint64_t offset{};
+    while(offset < _size && !parser.hasError())
+    {
+        // offset is always multiple of the window, so it is page aligned.
+        const size_t len = (_size - offset) < _window ? static_cast<size_t>(_size - offset) : _window;
+        void* p = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, _fd, static_cast<off_t>(offset));
+        if(p == MAP_FAILED)
+        {
+            GOB_JSON_LOGE("Failed to mmap %zu at %ju:%s", len, (uintmax_t)offset, std::strerror(errno));
+            return false;
+        }
+        madvise(p, len, MADV_SEQUENTIAL);
+#if defined(MADV_HUGEPAGE)
+        if(_hugePages) { madvise(p, len, MADV_HUGEPAGE); }
+#endif
+        parser.parse(static_cast<const char*>(p), len);
+        munmap(p, len);
+        offset += len;
+    }
+    return !parser.hasError();
+}
+
+//
+}}
+#endif
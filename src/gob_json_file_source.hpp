@@ -0,0 +1,81 @@
+/*!
+  @file gob_json_file_source.hpp
+  @brief Memory-mapped file source for StreamingParser. (Native only)
+ */
+#ifndef GOB_JSON_FILE_SOURCE_HPP
+#define GOB_JSON_FILE_SOURCE_HPP
+
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(ARDUINO)
+
+#include "gob_json.hpp"
+#include <cstdint>
+#include <cstddef>
+
+namespace goblib { namespace json {
+
+#ifndef GOB_JSON_MAPPED_FILE_WINDOW_SIZE
+# pragma message "[gob_json] Mapped file window size as default"
+# define GOB_JSON_MAPPED_FILE_WINDOW_SIZE  (256 * 1024 * 1024)
+#else
+# pragma message "[gob_json] Defined mapped file window size=" GOB_JSON_STRINGIFY(GOB_JSON_MAPPED_FILE_WINDOW_SIZE)
+#endif
+
+/*!
+  @class MappedFileSource
+  @brief Parse a file through mmap without copying to a buffer.
+  @details The file is mapped by window (GOB_JSON_MAPPED_FILE_WINDOW_SIZE by default) with MADV_SEQUENTIAL,
+  and each window is passed to StreamingParser::parse(buf, len) then unmapped.
+  Files larger than the window are remapped window by window, so the address space used is bounded.
+  @code
+  MappedFileSource src;
+  if(src.open("large.json")) { src.parse(parser); }
+  @endcode
+ */
+class MappedFileSource
+{
+  public:
+    MappedFileSource() {}
+    explicit MappedFileSource(const size_t windowSize) { setWindowSize(windowSize); }
+    ~MappedFileSource() { close(); }
+    MappedFileSource(const MappedFileSource&) = delete;
+    MappedFileSource& operator=(const MappedFileSource&) = delete;
+
+    /*! @brief Open the file */
+    bool open(const char* path);
+    /*! @brief Close the file */
+    void close();
+    /*! @brief Opened? */
+    bool isOpen() const { return _fd >= 0; }
+    /*! @brief File size */
+    uint64_t size() const { return _size; }
+
+    /*!
+      @brief Set the window size
+      @note Rounded up to the page size.
+     */
+    void setWindowSize(const size_t sz);
+    /*! @brief Gets the window size */
+    size_t getWindowSize() const { return _window; }
+    /*!
+      @brief Request transparent huge pages for the mapping. (Linux, MADV_HUGEPAGE)
+      @note Advisory. Ignored if not supported by the kernel or the file system.
+     */
+    void setHugePages(const bool b) { _hugePages = b; }
+
+    /*!
+      @brief Parse whole file
+      @return True if all bytes passed to the parser without errors
+     */
+    bool parse(StreamingParser& parser);
+
+  private:
+    int _fd{-1};
+    uint64_t _size{};
+    size_t _window{GOB_JSON_MAPPED_FILE_WINDOW_SIZE};
+    bool _hugePages{};
+};
+
+//
+}}
+#endif
+#endif
@@ -0,0 +1,213 @@
+/*!
+  @file gob_json_formatter.cpp
+  @brief Minify / pretty-print JSON in flight.
+ */
+#include "gob_json_formatter.hpp"
+#include "internal/gob_json_log.hpp"
+#include "internal/gob_json_swar.hpp"
+#include <cstring>
+#include <algorithm>
+
+namespace
+{
+// Terminates numbers and literals
+inline bool isDelimiter(const char c)
+{
+    switch(c)
+    {
+    case ' ': case '\t': case '\n': case '\r':
+    case '{': case '}': case '[': case ']': case ',': case ':': case '"':
+        return true;
+    default:
+        return false;
+    }
+}
+//
+}
+
+namespace goblib { namespace json {
+
+void StreamingFormatter::reset()
+{
+    _state = State::Outside;
+    _stackPos = 0;
+    _open = false;
+    _document = false;
+    _error = false;
+    _bufferPos = 0;
+    _flushed = 0;
+}
+
+void StreamingFormatter::error(const char* estr)
+{
+    GOB_JSON_LOGE("%s depth:%d written:%zu", estr, _stackPos, getWrittenSize());
+    _error = true;
+}
+
+bool StreamingFormatter::flush()
+{
+    if(_bufferPos == 0 || _error) { return !_error; }
+    if(!_sink || !_sink->write(_buffer, _bufferPos))
+    {
+        error("Failed to write to sink");
+        _bufferPos = 0;
+        return false;
+    }
+    _flushed += _bufferPos;
+    _bufferPos = 0;
+    return true;
+}
+
+// Does not fit in the rest of the buffer
+void StreamingFormatter::putLong(const char* s, size_t len)
+{
+    if(_error || !flush()) { return; }
+    // Long run goes to the sink directly.
+    if(len >= sizeof(_buffer))
+    {
+        if(!_sink || !_sink->write(s, len)) { error("Failed to write to sink"); return; }
+        _flushed += len;
+        return;
+    }
+    std::memcpy(_buffer + _bufferPos, s, len);
+    _bufferPos += len;
+}
+
+void StreamingFormatter::newline(const int depth)
+{
+    static constexpr char spaces[] = "\n                                                               ";
+    size_t n = 1 + static_cast<size_t>(depth) * _indent;
+    const char* s = spaces;
+    while(n)
+    {
+        const size_t sz = std::min(n, sizeof(spaces) - 1 - (s - spaces));
+        put(s, sz);
+        n -= sz;
+        s = spaces + 1;
+    }
+}
+
+// Output the verbatim run up to p
+void StreamingFormatter::cut(const char*& run, const char* p)
+{
+    put(run, p - run);
+    run = p;
+}
+
+void StreamingFormatter::beginValue(const char*& run, const char* p)
+{
+    if(_stackPos == 0)
+    {
+        if(_document) { cut(run, p); put('\n'); } // Next document
+        return;
+    }
+    if(_open)
+    {
+        cut(run, p);
+        newline(_stackPos);
+        _open = false;
+    }
+}
+
+void StreamingFormatter::endValue(const char*& run, const char* p)
+{
+    if(_stackPos > 0) { return; }
+    cut(run, p);
+    _document = true;
+    flush();
+}
+
+void StreamingFormatter::parse(const char* buf, size_t len)
+{
+    const bool pretty = _style == FormatStyle::Pretty;
+    const char* e = buf + len;
+    const char* run = buf; // Not yet output, copied as is
+    auto p = buf;
+    while(p < e && !_error)
+    {
+        switch(_state)
+        {
+        case State::String: // Until the closing '"', escapes and control characters are passed through
+            p = swar::findSpecial(p, e);
+            if(p == e) { break; }
+            if(*p == '"')
+            {
+                _state = State::Outside;
+                endValue(run, ++p);
+            }
+            else if(*p == '\\')
+            {
+                if(e - p < 2) { p = e; _state = State::Escape; }
+                else { p += 2; }
+            }
+            else { ++p; }
+            break;
+        case State::Escape: // The escaped character was in the previous buffer
+            ++p;
+            _state = State::String;
+            break;
+        case State::Scalar:
+            while(p < e && !isDelimiter(*p)) { ++p; }
+            if(p < e)
+            {
+                _state = State::Outside;
+                endValue(run, p);
+            }
+            break;
+        default:
+            switch(*p)
+            {
+            case ' ': case '\t': case '\n': case '\r':
+                cut(run, p);
+                run = p = swar::skipWhitespace(p, e);
+                break;
+            case '"':
+                beginValue(run, p++);
+                _state = State::String;
+                break;
+            case '{': case '[':
+                beginValue(run, p);
+                if(_stackPos >= (int)(sizeof(_stack) / sizeof(_stack[0])))
+                {
+                    error("Stack overflow");
+                    break;
+                }
+                _stack[_stackPos++] = (*p++ == '{');
+                _open = pretty;
+                break;
+            case '}': case ']':
+                if(_stackPos <= 0 || _stack[_stackPos - 1] != (*p == '}'))
+                {
+                    error("Unexpected end of container");
+                    break;
+                }
+                --_stackPos;
+                if(pretty && !_open)
+                {
+                    cut(run, p);
+                    newline(_stackPos);
+                }
+                _open = false;
+                endValue(run, ++p);
+                break;
+            case ',':
+                ++p;
+                if(pretty) { cut(run, p); newline(_stackPos); }
+                break;
+            case ':':
+                ++p;
+                if(pretty) { cut(run, p); put(' '); }
+                break;
+            default:
+                beginValue(run, p);
+                _state = State::Scalar;
+                break;
+            }
+            break;
+        }
+    }
+    if(!_error) { cut(run, p); }
+}
+
+//
+}}
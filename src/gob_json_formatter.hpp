@@ -0,0 +1,107 @@
+/*!
+  @file gob_json_formatter.hpp
+  @brief Minify / pretty-print JSON in flight.
+ */
+#ifndef GOB_JSON_FORMATTER_HPP
+#define GOB_JSON_FORMATTER_HPP
+
+#include "gob_json_writer.hpp" // Sink
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+namespace goblib { namespace json {
+
+#ifndef GOB_JSON_FORMATTER_BUFFER_LENGTH
+# pragma message "[gob_json] Formatter buffer length as default"
+# define GOB_JSON_FORMATTER_BUFFER_LENGTH  (512)
+#else
+# pragma message "[gob_json] Defined formatter buffer length=" GOB_JSON_STRINGIFY(GOB_JSON_FORMATTER_BUFFER_LENGTH)
+#endif
+
+/*! @enum FormatStyle Output style of StreamingFormatter */
+enum class FormatStyle : uint8_t
+{
+    Minify, //!< No whitespace outside strings
+    Pretty, //!< A member/element per line, indented. Empty containers stay as {} and []
+};
+
+/*!
+  @class StreamingFormatter
+  @brief Rewrites the whitespace of JSON text, and passes the result to the sink.
+  @details Strings, numbers and literals are copied verbatim. (No escape or number round-trip)
+  Input is copied in runs that end only where the whitespace changes, strings are scanned a word at a time.
+  Output is buffered (GOB_JSON_FORMATTER_BUFFER_LENGTH) and passed to the sink when full and at the end of each document.
+  Multiple documents are separated by a newline.
+  No memory allocation.
+  @code
+  StreamingFormatter fmt(FormatStyle::Minify, &sink);
+  fmt.parse(json, len);
+  fmt.flush();
+  @endcode
+  @note Only the nesting is checked, use StreamingParser::validate for the grammar.
+  @note Nesting level is limited to GOB_JSON_PARSER_STACK_MAX_DEPTH.
+ */
+class StreamingFormatter
+{
+  public:
+    /*!
+      @brief Constructor
+      @param style Output style
+      @param s Sink
+      @param indent Spaces per level (Pretty)
+     */
+    explicit StreamingFormatter(const FormatStyle style, Sink* s = nullptr, const uint8_t indent = 2)
+            : _style(style), _sink(s), _indent(indent) {}
+
+    /*! @brief Set sink */
+    void setSink(Sink* s) { _sink = s; }
+    /*! @brief Output style */
+    FormatStyle getStyle() const { return _style; }
+    /*! @brief Reset inner state. (Unflushed output is discarded) */
+    void reset();
+    /*! @brief Pass buffered output to the sink */
+    bool flush();
+    /*! @brief Any errors? */
+    bool hasError() const { return _error; }
+    /*! @brief Total bytes output. (Including unflushed) */
+    size_t getWrittenSize() const { return _flushed + _bufferPos; }
+
+    /*! @brief Parse 1 character */
+    void parse(const char ch) { parse(&ch, 1); }
+    /*! @brief Parse buffer */
+    void parse(const char* buf, size_t len);
+
+  protected:
+    void cut(const char*& run, const char* p);
+    void beginValue(const char*& run, const char* p);
+    void endValue(const char*& run, const char* p);
+    void newline(const int depth);
+    void put(const char* s, size_t len)
+    {
+        if(len <= sizeof(_buffer) - _bufferPos) { std::memcpy(_buffer + _bufferPos, s, len); _bufferPos += len; return; }
+        putLong(s, len);
+    }
+    void putLong(const char* s, size_t len);
+    void put(const char c) { if(_bufferPos == sizeof(_buffer) && !flush()) { return; } _buffer[_bufferPos++] = c; }
+    void error(const char* estr);
+
+  private:
+    enum class State : uint8_t { Outside, String, Escape, Scalar };
+
+    FormatStyle _style{};
+    Sink* _sink{};
+    uint8_t _indent{};
+    State _state{State::Outside};
+    bool _stack[GOB_JSON_PARSER_STACK_MAX_DEPTH]{}; // true if object
+    int _stackPos{};
+    bool _open{};     // Just after '{' or '[' (Pretty)
+    bool _document{}; // Top-level value written
+    bool _error{};
+    char _buffer[GOB_JSON_FORMATTER_BUFFER_LENGTH]{};
+    size_t _bufferPos{}, _flushed{};
+};
+
+//
+}}
+#endif
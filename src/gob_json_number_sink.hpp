@@ -0,0 +1,192 @@
+/*!
+  @file gob_json_number_sink.hpp
+  @brief Direct binding of numeric JSON array to container.
+ */
+#ifndef GOB_JSON_NUMBER_SINK_HPP
+#define GOB_JSON_NUMBER_SINK_HPP
+
+#include "gob_json_typedef.hpp"
+#include "internal/gob_json_number.hpp"
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+namespace goblib { namespace json {
+
+#ifndef GOB_JSON_STRINGIFY
+# define GOB_JSON_STRINGIFY(x) GOB_JSON_STRINGIFY_AGAIN(x)
+#endif
+#ifndef GOB_JSON_STRINGIFY_AGAIN
+# define GOB_JSON_STRINGIFY_AGAIN(x) #x
+#endif
+
+#ifndef GOB_JSON_NUMBER_SINK_BATCH
+# pragma message "[gob_json] Number sink batch as default"
+# define GOB_JSON_NUMBER_SINK_BATCH  (16)
+#else
+# pragma message "[gob_json] Defined number sink batch=" GOB_JSON_STRINGIFY(GOB_JSON_NUMBER_SINK_BATCH)
+#endif
+
+/*!
+  @class NumberSink
+  @brief Destination of numeric JSON array.
+  @details StreamingParser converts each number of the bound array into the batch without Handler::value,
+  and passes the batch to write() when it is full or the array ends.
+  On a parse error the stored numbers are passed, StreamingParser::reset discards them.
+  @sa StreamingParser::addNumberSink
+  @note Non-numeric elements are passed to the Handler as usual.
+ */
+class NumberSink
+{
+  public:
+    virtual ~NumberSink(){}
+
+    /*!
+      @brief Store number text (Called by parser)
+      @note Integral sinks convert the text with fraction or exponent as floating-point (truncated, clamped), same as Element.
+     */
+    void put(const char* text)
+    {
+        auto& n = _batch[_count];
+        const bool real = _kind != Kind::Float && std::strpbrk(text, ".eE");
+        switch(_kind)
+        {
+        case Kind::Signed:
+            if(real) { number::floatToIntegral(number::parseFloat<double>(text), n.i); }
+            else     { number::parseIntegral(text, n.i); }
+            break;
+        case Kind::Unsigned:
+            if(real) { number::floatToIntegral(number::parseFloat<double>(text), n.u); }
+            else     { number::parseIntegral(text, n.u); }
+            break;
+        case Kind::Float:    n.f = number::parseFloat<double>(text); break;
+        }
+        if(++_count == GOB_JSON_NUMBER_SINK_BATCH) { flush(); }
+    }
+    /*! @brief Pass stored numbers to write() */
+    void flush()
+    {
+        if(_count) { write(_batch, _count); _count = 0; }
+    }
+    /*! @brief Discard stored numbers */
+    void clear() { _count = 0; }
+
+  protected:
+    /*! @brief Representation in the batch */
+    enum class Kind : uint8_t { Signed, Unsigned, Float };
+    union Number
+    {
+        intmax_t i;
+        uintmax_t u;
+        double f;
+    };
+    explicit NumberSink(const Kind k) : _kind(k) {}
+
+    /*! @brief Kind for type T */
+    template<typename T> static constexpr Kind kindOf()
+    {
+        return std::is_floating_point<T>::value ? Kind::Float : (std::is_signed<T>::value ? Kind::Signed : Kind::Unsigned);
+    }
+    /*! @brief Convert to T (Clamped to the range of T) */
+    template<typename T, typename std::enable_if<std::is_floating_point<T>::value, std::nullptr_t>::type = nullptr>
+    static T convert(const Number& n) { return static_cast<T>(n.f); }
+    template<typename T, typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value, std::nullptr_t>::type = nullptr>
+    static T convert(const Number& n)
+    {
+        return n.i < (intmax_t)std::numeric_limits<T>::min() ? std::numeric_limits<T>::min()
+                : (n.i > (intmax_t)std::numeric_limits<T>::max() ? std::numeric_limits<T>::max() : static_cast<T>(n.i));
+    }
+    template<typename T, typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value, std::nullptr_t>::type = nullptr>
+    static T convert(const Number& n)
+    {
+        return n.u > (uintmax_t)std::numeric_limits<T>::max() ? std::numeric_limits<T>::max() : static_cast<T>(n.u);
+    }
+
+    /*! @brief Receive converted numbers */
+    virtual void write(const Number* nums, const size_t n) = 0;
+
+  private:
+    Number _batch[GOB_JSON_NUMBER_SINK_BATCH]{};
+    size_t _count{};
+    Kind _kind{};
+};
+
+/*!
+  @class VectorNumberSink
+  @brief Append to std::vector
+  @tparam V std::vector of arithmetic type (Any allocator)
+ */
+template<class V> class VectorNumberSink : public NumberSink
+{
+  public:
+    using value_type = typename V::value_type;
+    explicit VectorNumberSink(V& v) : NumberSink(kindOf<value_type>()), _v(v) {}
+
+  protected:
+    virtual void write(const Number* nums, const size_t n) override
+    {
+        for(size_t i = 0; i < n; ++i) { _v.push_back(convert<value_type>(nums[i])); }
+    }
+  private:
+    V& _v;
+};
+
+/*!
+  @class BufferNumberSink
+  @brief Store to fixed length buffer
+  @tparam T Arithmetic type
+  @note Numbers that exceed the capacity are counted in dropped()
+ */
+template<typename T> class BufferNumberSink : public NumberSink
+{
+  public:
+    BufferNumberSink(T* buf, const size_t capacity) : NumberSink(kindOf<T>()), _buf(buf), _capacity(capacity) {}
+
+    size_t size() const { return _size; }        //!< @brief Number of stored
+    size_t dropped() const { return _dropped; }  //!< @brief Number of dropped
+    void clear() { NumberSink::clear(); _size = _dropped = 0; } //!< @brief Store from beginning (Pending numbers are discarded)
+
+  protected:
+    virtual void write(const Number* nums, const size_t n) override
+    {
+        for(size_t i = 0; i < n; ++i)
+        {
+            if(_size < _capacity) { _buf[_size++] = convert<T>(nums[i]); }
+            else { ++_dropped; }
+        }
+    }
+  private:
+    T* _buf{};
+    size_t _capacity{}, _size{}, _dropped{};
+};
+
+/*!
+  @class CallbackNumberSink
+  @brief Pass span of numbers to user function
+  @tparam T Arithmetic type
+ */
+template<typename T> class CallbackNumberSink : public NumberSink
+{
+  public:
+    /*! @brief Callback function type. Called with up to GOB_JSON_NUMBER_SINK_BATCH numbers */
+    using function_t = void(*)(const T* values, size_t len, void* arg);
+
+    explicit CallbackNumberSink(function_t func, void* arg = nullptr) : NumberSink(kindOf<T>()), _func(func), _arg(arg) {}
+
+  protected:
+    virtual void write(const Number* nums, const size_t n) override
+    {
+        T tmp[GOB_JSON_NUMBER_SINK_BATCH];
+        for(size_t i = 0; i < n; ++i) { tmp[i] = convert<T>(nums[i]); }
+        if(_func) { _func(tmp, n, _arg); }
+    }
+  private:
+    function_t _func{};
+    void* _arg{};
+};
+
+//
+}}
+#endif
@@ -0,0 +1,318 @@
+/*!
+  @file gob_json_pipeline_handler.cpp
+  @brief Handler that passes events to another thread.
+ */
+#include "gob_json_pipeline_handler.hpp"
+#include "internal/gob_json_log.hpp"
+#include <cstring>
+#include <cassert>
+
+namespace goblib { namespace json {
+
+namespace
+{
+/*
+  Record layout (8 bytes aligned)
+  [Header][Selector x nsel][Value]
+  Selector: int32 index, uint8 key length, key bytes
+  Value: Int/Float 8 bytes, Bool 1 byte,
+         Raw number uint8 flags, uint32 length, bytes and '\0'
+         String uint32 length, bytes and '\0'
+ */
+struct Header
+{
+    uint32_t size;  // Including this header
+    uint8_t kind;
+    uint8_t keep;   // Levels of the path unchanged from the previous event
+    uint8_t nsel;   // Number of selectors that follow
+    uint8_t vtype;  // ElementValue::Type | RAW
+};
+constexpr uint8_t RAW = 0x80;
+constexpr size_t ALIGN = 8;
+// Key length (excluding '\0'), keep and nsel are stored as uint8
+static_assert(GOB_JSON_PARSER_KEY_MAX_LENGTH <= 256, "Key length does not fit in the record");
+static_assert(GOB_JSON_PARSER_STACK_MAX_DEPTH <= 255, "Depth does not fit in the record");
+
+constexpr size_t align(const size_t sz) { return (sz + ALIGN - 1) & ~(ALIGN - 1); }
+
+constexpr size_t MAX_RECORD = align(sizeof(Header)
+                                    + GOB_JSON_PARSER_STACK_MAX_DEPTH * (sizeof(int32_t) + 1 + GOB_JSON_PARSER_KEY_MAX_LENGTH)
+                                    + 1 + sizeof(uint32_t) + GOB_JSON_PARSER_BUFFER_MAX_LENGTH + 1);
+
+inline bool sameSelector(const ElementSelector& a, const ElementSelector& b)
+{
+    return a.getIndex() == b.getIndex() && std::strcmp(a.getKey(), b.getKey()) == 0;
+}
+
+template<typename T> inline uint8_t* put(uint8_t* p, const T& v)
+{
+    std::memcpy(p, &v, sizeof(v));
+    return p + sizeof(v);
+}
+inline uint8_t* put(uint8_t* p, const char* s, const size_t len)
+{
+    std::memcpy(p, s, len);
+    p[len] = '\0';
+    return p + len + 1;
+}
+template<typename T> inline const uint8_t* get(const uint8_t* p, T& v)
+{
+    std::memcpy(&v, p, sizeof(v));
+    return p + sizeof(v);
+}
+//
+}
+
+PipelineHandler::PipelineHandler(Handler* target, const size_t capacity)
+        : _target(target), _capacity(align(capacity < MAX_RECORD * 2 ? MAX_RECORD * 2 : capacity))
+        , _ring(new uint8_t[_capacity])
+{
+    _thread = std::thread(&PipelineHandler::consumer, this);
+}
+
+template<class Pred> void PipelineHandler::waitFor(Pred pred)
+{
+    // The notifier checks _sleepers after updating the counters, so that wake-up is not lost.
+    std::unique_lock<std::mutex> lk(_mutex);
+    _sleepers.fetch_add(1);
+    _cv.wait(lk, pred);
+    _sleepers.fetch_sub(1);
+}
+
+void PipelineHandler::wakeUp()
+{
+    if(_sleepers.load() > 0)
+    {
+        { std::lock_guard<std::mutex> lk(_mutex); }
+        _cv.notify_all();
+    }
+}
+
+void PipelineHandler::drain()
+{
+    waitFor([this]() { return _tail.load() == _head.load(); });
+}
+
+void PipelineHandler::stop()
+{
+    if(!_thread.joinable()) { return; }
+    _stop.store(true);
+    { std::lock_guard<std::mutex> lk(_mutex); }
+    _cv.notify_all();
+    _thread.join();
+}
+
+// ----------------------------------------------------------------------------
+// Producer
+uint8_t* PipelineHandler::reserve(const size_t size)
+{
+    assert(size <= MAX_RECORD);
+    size_t pos = _reserved % _capacity;
+    // Record does not fit at the end, skip to the beginning.
+    const size_t skip = (_capacity - pos < size) ? _capacity - pos : 0;
+    const size_t need = skip + size;
+    if(_capacity - (_reserved - _tail.load()) < need)
+    {
+        // Wait until half empty to avoid waking up for every record.
+        const size_t resume = need > _capacity / 2 ? need : _capacity / 2;
+        _stalls.fetch_add(1, std::memory_order_relaxed);
+        waitFor([this, resume]() { return _capacity - (_reserved - _tail.load()) >= resume; });
+    }
+    if(skip)
+    {
+        Header h{static_cast<uint32_t>(skip), static_cast<uint8_t>(Kind::Wrap), 0, 0, 0};
+        std::memcpy(_ring.get() + pos, &h, sizeof(h));
+        _reserved += skip;
+        pos = 0;
+    }
+    return _ring.get() + pos;
+}
+
+void PipelineHandler::publish(const size_t size)
+{
+    _reserved += size;
+    _head.store(_reserved);
+    wakeUp();
+}
+
+void PipelineHandler::push(const Kind kind, const ElementPath* path, const ElementValue* value, const char ch)
+{
+    // Difference of the path from the previous event
+    int keep{}, count{};
+    if(path)
+    {
+        count = path->getCount();
+        while(keep < count && keep < _lastCount && sameSelector(*path->get(keep), _last[keep])) { ++keep; }
+    }
+    else { keep = _lastCount; count = _lastCount; }
+
+    // Size
+    size_t size = sizeof(Header);
+    for(int i = keep; i < count; ++i) { size += sizeof(int32_t) + 1 + std::strlen(path->get(i)->getKey()); }
+    uint8_t vtype{};
+    size_t slen{};
+    if(value)
+    {
+        vtype = static_cast<uint8_t>(value->getType());
+        switch(value->getType())
+        {
+        case ElementValue::Type::Int:
+        case ElementValue::Type::Float:
+            if(value->hasRaw())
+            {
+                vtype |= RAW;
+                slen = value->getRawLength();
+                size += 1 + sizeof(uint32_t) + slen + 1;
+            }
+            else { size += sizeof(uint64_t); }
+            break;
+        case ElementValue::Type::String:
+            slen = std::strlen(value->getString());
+            size += sizeof(uint32_t) + slen + 1;
+            break;
+        case ElementValue::Type::Bool: size += 1; break;
+        default: break;
+        }
+    }
+    if(kind == Kind::Whitespace) { size += 1; }
+    size = align(size);
+
+    // Encode
+    uint8_t* rec = reserve(size);
+    Header h{static_cast<uint32_t>(size), static_cast<uint8_t>(kind), static_cast<uint8_t>(keep),
+             static_cast<uint8_t>(count - keep), vtype};
+    uint8_t* p = put(rec, h);
+    for(int i = keep; i < count; ++i)
+    {
+        auto sel = path->get(i);
+        auto klen = static_cast<uint8_t>(std::strlen(sel->getKey()));
+        p = put(p, static_cast<int32_t>(sel->getIndex()));
+        p = put(p, klen);
+        std::memcpy(p, sel->getKey(), klen);
+        p += klen;
+        _last[i] = *sel;
+    }
+    _lastCount = count;
+
+    if(value)
+    {
+        switch(value->getType())
+        {
+        case ElementValue::Type::Int:
+        case ElementValue::Type::Float:
+            if(vtype & RAW)
+            {
+                p = put(p, value->getNumberFlags());
+                p = put(p, static_cast<uint32_t>(slen));
+                p = put(p, value->getRaw(), slen);
+            }
+            else if(value->isInt()) { p = put(p, static_cast<uint64_t>(value->getInt())); }
+            else { p = put(p, value->getFloat()); }
+            break;
+        case ElementValue::Type::String:
+            p = put(p, static_cast<uint32_t>(slen));
+            p = put(p, value->getString(), slen);
+            break;
+        case ElementValue::Type::Bool:
+            p = put(p, static_cast<uint8_t>(value->getBool()));
+            break;
+        default: break;
+        }
+    }
+    if(kind == Kind::Whitespace) { p = put(p, ch); }
+    publish(size);
+}
+
+void PipelineHandler::startDocument()                     { push(Kind::StartDocument, nullptr); }
+void PipelineHandler::endDocument()                       { push(Kind::EndDocument, nullptr); }
+void PipelineHandler::startObject(const ElementPath& path) { push(Kind::StartObject, &path); }
+void PipelineHandler::endObject(const ElementPath& path)   { push(Kind::EndObject, &path); }
+void PipelineHandler::startArray(const ElementPath& path)  { push(Kind::StartArray, &path); }
+void PipelineHandler::endArray(const ElementPath& path)    { push(Kind::EndArray, &path); }
+void PipelineHandler::value(const ElementPath& path, const ElementValue& value) { push(Kind::Value, &path, &value); }
+void PipelineHandler::whitespace(const char ch)           { push(Kind::Whitespace, nullptr, nullptr, ch); }
+
+// ----------------------------------------------------------------------------
+// Consumer
+void PipelineHandler::consumer()
+{
+    for(;;)
+    {
+        const size_t tail = _tail.load();
+        if(_head.load() == tail)
+        {
+            if(_stop.load()) { break; }
+            waitFor([this, tail]() { return _stop.load() || _head.load() != tail; });
+            continue;
+        }
+        const uint8_t* rec = _ring.get() + tail % _capacity;
+        Header h;
+        get(rec, h);
+        if(h.kind != static_cast<uint8_t>(Kind::Wrap)) { replay(rec); }
+        _tail.store(tail + h.size);
+        wakeUp();
+    }
+}
+
+void PipelineHandler::replay(const uint8_t* rec)
+{
+    Header h;
+    const uint8_t* p = get(rec, h);
+
+    // Rebuild the path
+    while(_path.getCount() > h.keep) { _path.pop(); }
+    for(int i = 0; i < h.nsel; ++i)
+    {
+        int32_t index;
+        uint8_t klen;
+        p = get(p, index);
+        p = get(p, klen);
+        _path.push();
+        auto cur = _path.getCurrent();
+        std::memcpy(cur->key, p, klen);
+        cur->key[klen] = '\0';
+        cur->index = index;
+        p += klen;
+    }
+
+    if(!_target) { return; }
+    switch(static_cast<Kind>(h.kind))
+    {
+    case Kind::StartDocument: _target->startDocument();    break;
+    case Kind::EndDocument:   _target->endDocument();      break;
+    case Kind::StartObject:   _target->startObject(_path); break;
+    case Kind::EndObject:     _target->endObject(_path);   break;
+    case Kind::StartArray:    _target->startArray(_path);  break;
+    case Kind::EndArray:      _target->endArray(_path);    break;
+    case Kind::Whitespace:    _target->whitespace(static_cast<char>(*p)); break;
+    case Kind::Value:
+    {
+        const auto type = static_cast<ElementValue::Type>(h.vtype & ~RAW);
+        if(h.vtype & RAW)
+        {
+            uint8_t flags;
+            uint32_t len;
+            p = get(p, flags);
+            p = get(p, len);
+            _value.withNumber(reinterpret_cast<const char*>(p), len, flags);
+        }
+        else
+        {
+            switch(type)
+            {
+            case ElementValue::Type::Int:    { uint64_t v; get(p, v); _value.with(static_cast<ElementValue::number_t>(v)); } break;
+            case ElementValue::Type::Float:  { double v; get(p, v); _value.with(static_cast<ElementValue::fp_t>(v)); } break;
+            case ElementValue::Type::String: _value.with(reinterpret_cast<const char*>(p + sizeof(uint32_t))); break;
+            case ElementValue::Type::Bool:   _value.with(*p != 0); break;
+            default:                         _value.with(); break;
+            }
+        }
+        _target->value(_path, _value);
+    }
+        break;
+    default: GOB_JSON_LOGE("Unknown event %u", h.kind); break;
+    }
+}
+
+//
+}}
@@ -0,0 +1,127 @@
+/*!
+  @file gob_json_pipeline_handler.hpp
+  @brief Handler that passes events to another thread.
+ */
+#ifndef GOB_JSON_PIPELINE_HANDLER_HPP
+#define GOB_JSON_PIPELINE_HANDLER_HPP
+
+#include "gob_json_handler.hpp"
+#include "gob_json.hpp" // GOB_JSON_PARSER_BUFFER_MAX_LENGTH
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace goblib { namespace json {
+
+#ifndef GOB_JSON_PIPELINE_BUFFER_SIZE
+# pragma message "[gob_json] Pipeline buffer size as default"
+# define GOB_JSON_PIPELINE_BUFFER_SIZE  (16 * 1024)
+#else
+# pragma message "[gob_json] Defined pipeline buffer size=" GOB_JSON_STRINGIFY(GOB_JSON_PIPELINE_BUFFER_SIZE)
+#endif
+
+/*!
+  @class PipelineHandler
+  @brief Replays the parser events into the target handler on the consumer thread.
+  @details Each event is encoded into a single-producer single-consumer ring of fixed size
+  with the difference of the path from the previous event and a copy of the value bytes.
+  The consumer thread rebuilds the path and the value, then calls the target handler,
+  so parsing and handling run concurrently.
+  When the ring is full, the parser thread waits for the consumer. (Backpressure)
+  @code
+  MyHandler heavy;
+  PipelineHandler pipe(&heavy);
+  StreamingParser parser(&pipe);
+  parser.parse(buf, len);
+  pipe.drain(); // All events are handled
+  @endcode
+  @note The target handler is called only from the consumer thread.
+  @note The capacity is increased to hold at least 2 events of the maximum size.
+ */
+class PipelineHandler : public Handler
+{
+  public:
+    /*!
+      @param target Handler called on the consumer thread
+      @param capacity Ring size in bytes
+     */
+    explicit PipelineHandler(Handler* target, const size_t capacity = GOB_JSON_PIPELINE_BUFFER_SIZE);
+    virtual ~PipelineHandler() { stop(); }
+    PipelineHandler(const PipelineHandler&) = delete;
+    PipelineHandler& operator=(const PipelineHandler&) = delete;
+
+    /*! @brief Wait until all events queued are handled */
+    void drain();
+    /*! @brief Handle the remaining events and stop the consumer thread */
+    void stop();
+
+    /*! @brief Ring size in bytes */
+    size_t capacity() const { return _capacity; }
+    /*! @brief Number of times the parser thread waited for room */
+    uint32_t getStallCount() const { return _stalls.load(std::memory_order_relaxed); }
+
+    ///@name Handler (Called by the parser thread)
+    ///@{
+    virtual void startDocument() override;
+    virtual void endDocument() override;
+    virtual void startObject(const ElementPath& path) override;
+    virtual void endObject(const ElementPath& path) override;
+    virtual void startArray(const ElementPath& path) override;
+    virtual void endArray(const ElementPath& path) override;
+    virtual void value(const ElementPath& path, const ElementValue& value) override;
+    virtual void whitespace(const char ch) override;
+    ///@}
+
+  protected:
+    enum class Kind : uint8_t
+    {
+        Wrap, // Rest of the ring is unused
+        StartDocument, EndDocument,
+        StartObject, EndObject,
+        StartArray, EndArray,
+        Value,
+        Whitespace,
+    };
+    // Producer
+    void push(const Kind kind, const ElementPath* path, const ElementValue* value = nullptr, const char ch = 0);
+    uint8_t* reserve(const size_t size);
+    void publish(const size_t size);
+    // Consumer
+    void consumer();
+    void replay(const uint8_t* rec);
+
+    template<class Pred> void waitFor(Pred pred);
+    void wakeUp();
+
+  private:
+    Handler* _target{};
+    size_t _capacity{};
+    std::unique_ptr<uint8_t[]> _ring{};
+
+    // Ring counters (monotonically increasing, offset is counter % capacity)
+    std::atomic<size_t> _head{0}; // Written by the producer
+    std::atomic<size_t> _tail{0}; // Written by the consumer
+    size_t _reserved{}; // Head including the wrap in progress (producer only)
+    std::atomic<bool> _stop{false};
+    std::atomic<int> _sleepers{0};
+    std::atomic<uint32_t> _stalls{0};
+    std::mutex _mutex{};
+    std::condition_variable _cv{};
+
+    // Path of the last event (producer only)
+    int _lastCount{};
+    ElementSelector _last[GOB_JSON_PARSER_STACK_MAX_DEPTH]{};
+    // Rebuilt path (consumer only)
+    ElementPath _path{};
+    ElementValue _value{};
+
+    std::thread _thread{};
+};
+
+//
+}}
+#endif
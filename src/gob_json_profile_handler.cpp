@@ -0,0 +1,204 @@
+/*!
+  @file gob_json_profile_handler.cpp
+  @brief Handler that attributes the parsing cost to path patterns.
+ */
+#include "gob_json_profile_handler.hpp"
+#include "internal/gob_json_stats.hpp"
+#include <cstdio>
+#include <cstring>
+#include <cinttypes>
+
+namespace goblib { namespace json {
+
+namespace
+{
+// Is the pattern p the descendant of (or same as) the pattern a?
+bool isDescendant(const char* a, const char* p)
+{
+    const size_t len = std::strlen(a);
+    if(len == 0) { return true; } // Root
+    if(std::strncmp(a, p, len) != 0) { return false; }
+    return p[len] == '\0' || p[len] == '.' || p[len] == '[';
+}
+
+inline double percent(const uint64_t v, const uint64_t total)
+{
+    return total ? 100.0 * static_cast<double>(v) / static_cast<double>(total) : 0.0;
+}
+//
+}
+
+void ProfileHandler::clear()
+{
+    for(auto& e : _entries) { e = Entry{}; }
+    _other = Entry{};
+    std::strcpy(_other.pattern, "(other)");
+    _size = 0;
+    _last = nullptr;
+    _tick = 0;
+    _position = 0;
+}
+
+const ProfileHandler::Entry* ProfileHandler::find(const char* pattern) const
+{
+    for(size_t i = 0; i < _size; ++i)
+    {
+        if(std::strcmp(_entries[i].pattern, pattern) == 0) { return &_entries[i]; }
+    }
+    return nullptr;
+}
+
+ProfileHandler::Entry& ProfileHandler::lookup(const ElementPath* path)
+{
+    if(path) { path->toPattern(_pattern, sizeof(_pattern)); }
+    else { _pattern[0] = '\0'; }
+
+    // Consecutive events often have the same pattern (array elements).
+    if(_last && std::strcmp(_last->pattern, _pattern) == 0) { return *_last; }
+    for(size_t i = 0; i < _size; ++i)
+    {
+        if(std::strcmp(_entries[i].pattern, _pattern) == 0) { return *(_last = &_entries[i]); }
+    }
+    if(_size >= GOB_JSON_PROFILE_MAX_PATHS) { return _other; }
+
+    auto& e = _entries[_size++];
+    e = Entry{};
+    std::strcpy(e.pattern, _pattern);
+    return *(_last = &e);
+}
+
+ProfileHandler::Entry& ProfileHandler::enter(const ElementPath* path)
+{
+    const auto now = stats::ticks();
+    size_t bytes{};
+    if(_parser)
+    {
+        const size_t pos = _parser->getPosition();
+        if(pos < _position) { _position = 0; } // Parser was reset
+        bytes = pos - _position;
+        _position = pos;
+    }
+    auto& e = lookup(path);
+    e.bytes += bytes;
+    if(_tick) { e.parseTicks += stats::elapsed(_tick, now); }
+    ++e.events;
+    _tick = stats::ticks();
+    return e;
+}
+
+void ProfileHandler::leave(Entry& e)
+{
+    const auto now = stats::ticks();
+    e.handlerTicks += stats::elapsed(_tick, now);
+    _tick = now;
+}
+
+void ProfileHandler::startDocument()
+{
+    auto& e = enter(nullptr);
+    if(_target) { _target->startDocument(); }
+    leave(e);
+}
+
+void ProfileHandler::endDocument()
+{
+    auto& e = enter(nullptr);
+    if(_target) { _target->endDocument(); }
+    leave(e);
+}
+
+void ProfileHandler::startObject(const ElementPath& path)
+{
+    auto& e = enter(&path);
+    if(_target) { _target->startObject(path); }
+    leave(e);
+}
+
+void ProfileHandler::endObject(const ElementPath& path)
+{
+    auto& e = enter(&path);
+    if(_target) { _target->endObject(path); }
+    leave(e);
+}
+
+void ProfileHandler::startArray(const ElementPath& path)
+{
+    auto& e = enter(&path);
+    if(_target) { _target->startArray(path); }
+    leave(e);
+}
+
+void ProfileHandler::endArray(const ElementPath& path)
+{
+    auto& e = enter(&path);
+    if(_target) { _target->endArray(path); }
+    leave(e);
+}
+
+void ProfileHandler::value(const ElementPath& path, const ElementValue& value)
+{
+    auto& e = enter(&path);
+    ++e.values;
+    if(_target) { _target->value(path, value); }
+    leave(e);
+}
+
+void ProfileHandler::summarize()
+{
+    for(size_t i = 0; i < _size; ++i)
+    {
+        auto& a = _entries[i];
+        a.totalBytes = a.totalTicks = 0;
+        for(size_t j = 0; j < _size; ++j)
+        {
+            auto& d = _entries[j];
+            if(!isDescendant(a.pattern, d.pattern)) { continue; }
+            a.totalBytes += d.bytes;
+            a.totalTicks += d.parseTicks + d.handlerTicks;
+        }
+    }
+    _other.totalBytes = _other.bytes;
+    _other.totalTicks = _other.parseTicks + _other.handlerTicks;
+}
+
+void ProfileHandler::dump(output_function_t out, void* arg)
+{
+    if(!out) { return; }
+    summarize();
+
+    uint64_t ticks{}, bytes{};
+    const size_t n = size();
+    for(size_t i = 0; i < n; ++i)
+    {
+        auto& e = (*this)[i];
+        ticks += e.parseTicks + e.handlerTicks;
+        bytes += e.bytes;
+    }
+
+    // Sort by inclusive ticks (Insertion sort, small table)
+    uint16_t order[GOB_JSON_PROFILE_MAX_PATHS + 1];
+    for(size_t i = 0; i < n; ++i)
+    {
+        size_t j = i;
+        while(j > 0 && (*this)[order[j - 1]].totalTicks < (*this)[i].totalTicks) { order[j] = order[j - 1]; --j; }
+        order[j] = static_cast<uint16_t>(i);
+    }
+
+    char line[GOB_JSON_PROFILE_PATTERN_LENGTH + 96];
+    snprintf(line, sizeof(line), "%7s %7s %7s %8s %12s %9s %9s  %s",
+             "incl%", "self%", "bytes%", "handler%", "bytes", "events", "values", "pattern");
+    out(line, arg);
+    for(size_t i = 0; i < n; ++i)
+    {
+        auto& e = (*this)[order[i]];
+        const uint64_t self = e.parseTicks + e.handlerTicks;
+        snprintf(line, sizeof(line), "%6.2f%% %6.2f%% %6.2f%% %7.2f%% %12" PRIu64 " %9" PRIu32 " %9" PRIu32 "  %s",
+                 percent(e.totalTicks, ticks), percent(self, ticks), percent(e.totalBytes, bytes),
+                 percent(e.handlerTicks, self), e.totalBytes, e.events, e.values,
+                 e.pattern[0] ? e.pattern : "(root)");
+        out(line, arg);
+    }
+}
+
+//
+}}
@@ -0,0 +1,129 @@
+/*!
+  @file gob_json_profile_handler.hpp
+  @brief Handler that attributes the parsing cost to path patterns.
+ */
+#ifndef GOB_JSON_PROFILE_HANDLER_HPP
+#define GOB_JSON_PROFILE_HANDLER_HPP
+
+#include "gob_json_handler.hpp"
+#include "gob_json.hpp"
+#include <cstdint>
+#include <cstddef>
+
+namespace goblib { namespace json {
+
+#ifndef GOB_JSON_PROFILE_MAX_PATHS
+# pragma message "[gob_json] Profile max paths as default"
+# define GOB_JSON_PROFILE_MAX_PATHS (64)
+#else
+# pragma message "[gob_json] Defined profile max paths=" GOB_JSON_STRINGIFY(GOB_JSON_PROFILE_MAX_PATHS)
+#endif
+
+#ifndef GOB_JSON_PROFILE_PATTERN_LENGTH
+# pragma message "[gob_json] Profile pattern length as default"
+# define GOB_JSON_PROFILE_PATTERN_LENGTH (96)
+#else
+# pragma message "[gob_json] Defined profile pattern length=" GOB_JSON_STRINGIFY(GOB_JSON_PROFILE_PATTERN_LENGTH)
+#endif
+
+/*!
+  @class ProfileHandler
+  @brief Passes the events to the target handler, and attributes bytes, events and time to the path patterns.
+  @details The key of each event is ElementPath::toPattern (array indices are collapsed to "[*]").
+  - bytes: characters consumed since the previous event
+  - parse: ticks since the previous event (parser time)
+  - handler: ticks in the target handler
+  dump() prints the patterns sorted by the inclusive cost (the pattern and its descendants).
+  @code
+  MyHandler my;
+  StreamingParser parser;
+  ProfileHandler prof(&my, &parser);
+  parser.setHandler(&prof);
+  parser.parse(buf, len);
+  prof.dump([](const char* line, void*) { puts(line); });
+  @endcode
+  @note Time between the events includes the time out of parse() (e.g. reading the input), feed the data without waiting to profile.
+  @note When the table is full, the rest are attributed to "(other)".
+  @note Ticks are counted by the same clock as ParserStats. (GOB_JSON_STATS is not required)
+ */
+class ProfileHandler : public Handler
+{
+  public:
+    /*! @brief Cost of the pattern */
+    struct Entry
+    {
+        char pattern[GOB_JSON_PROFILE_PATTERN_LENGTH]; //!< Path pattern ("" is the root)
+        uint64_t bytes;         //!< Characters consumed
+        uint64_t parseTicks;    //!< Ticks in the parser
+        uint64_t handlerTicks;  //!< Ticks in the target handler
+        uint32_t events;        //!< Number of events
+        uint32_t values;        //!< Number of values
+        ///@name Inclusive (Pattern and descendants, updated by summarize())
+        ///@{
+        uint64_t totalBytes;
+        uint64_t totalTicks;
+        ///@}
+    };
+    using output_function_t = void(*)(const char* line, void* arg); //!< Output for dump()
+
+    /*!
+      @param target Handler to pass the events (nullptr: profile only)
+      @param parser Parser to read the position (nullptr: no bytes)
+     */
+    explicit ProfileHandler(Handler* target, const StreamingParser* parser = nullptr)
+            : _target(target), _parser(parser) { clear(); }
+
+    /*! @brief Set the parser to read the position */
+    void setParser(const StreamingParser* parser) { _parser = parser; }
+    /*! @brief Clear all entries */
+    void clear();
+
+    /*! @brief Number of entries (Including "(other)" if used) */
+    size_t size() const { return _size + (_other.events ? 1 : 0); }
+    /*! @brief Entry */
+    const Entry& operator[](const size_t i) const { return i < _size ? _entries[i] : _other; }
+    /*! @brief Find the entry of the pattern (nullptr if not exists) */
+    const Entry* find(const char* pattern) const;
+
+    /*! @brief Update inclusive fields of all entries */
+    void summarize();
+    /*!
+      @brief Output the report sorted by inclusive ticks (descending)
+      @param out Called for each line (without line feed)
+      @param arg Passed to out
+     */
+    void dump(output_function_t out, void* arg = nullptr);
+
+    ///@name Handler
+    ///@{
+    virtual void startDocument() override;
+    virtual void endDocument() override;
+    virtual void startObject(const ElementPath& path) override;
+    virtual void endObject(const ElementPath& path) override;
+    virtual void startArray(const ElementPath& path) override;
+    virtual void endArray(const ElementPath& path) override;
+    virtual void value(const ElementPath& path, const ElementValue& value) override;
+    virtual void whitespace(const char ch) override { if(_target) { _target->whitespace(ch); } }
+    ///@}
+
+  protected:
+    Entry& lookup(const ElementPath* path);
+    // Attributes the parser cost before the event, and returns the entry.
+    Entry& enter(const ElementPath* path);
+    void leave(Entry& e);
+
+  private:
+    Handler* _target{};
+    const StreamingParser* _parser{};
+    Entry _entries[GOB_JSON_PROFILE_MAX_PATHS]{};
+    Entry _other{};
+    size_t _size{};
+    Entry* _last{};       // Cache of the previous lookup
+    uint64_t _tick{};     // End of the previous event
+    size_t _position{};   // Parser position at the previous event
+    char _pattern[GOB_JSON_PROFILE_PATTERN_LENGTH]{};
+};
+
+//
+}}
+#endif
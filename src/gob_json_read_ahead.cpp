@@ -0,0 +1,164 @@
+/*!
+  @file gob_json_read_ahead.cpp
+  @brief Read-ahead source that reads on its own thread. (Native only)
+ */
+#include "gob_json_read_ahead.hpp"
+
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(ARDUINO)
+
+#include "internal/gob_json_log.hpp"
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <cerrno>
+#include <cstring>
+
+namespace goblib { namespace json {
+
+ReadAheadSource::ReadAheadSource(const int fd, const size_t chunkSize, const size_t chunkCount)
+        : _fd(fd)
+{
+    allocate(chunkSize, chunkCount);
+    if(::pipe(_wake) == 0)
+    {
+        for(auto w : _wake) { ::fcntl(w, F_SETFD, FD_CLOEXEC); ::fcntl(w, F_SETFL, O_NONBLOCK); }
+    }
+    else
+    {
+        GOB_JSON_LOGE("Failed to create pipe:%s", std::strerror(errno));
+        _wake[0] = _wake[1] = -1;
+    }
+}
+
+ReadAheadSource::ReadAheadSource(read_function_t func, void* arg, const size_t chunkSize, const size_t chunkCount)
+        : _func(func), _arg(arg)
+{
+    allocate(chunkSize, chunkCount);
+}
+
+ReadAheadSource::~ReadAheadSource()
+{
+    stop();
+    for(auto w : _wake) { if(w >= 0) { ::close(w); } }
+}
+
+void ReadAheadSource::allocate(const size_t chunkSize, const size_t chunkCount)
+{
+    _chunkSize = chunkSize ? chunkSize : 1;
+    _chunkCount = chunkCount < 2 ? 2 : chunkCount;
+    _chunks.reset(new char[_chunkSize * _chunkCount]);
+    _lengths.reset(new size_t[_chunkCount]());
+}
+
+// Returns 0 if interrupted by stop()
+ssize_t ReadAheadSource::readFd(char* buf, size_t len)
+{
+    if(_wake[0] >= 0)
+    {
+        struct pollfd fds[2] = { { _fd, POLLIN, 0 }, { _wake[0], POLLIN, 0 } };
+        int r;
+        while((r = ::poll(fds, 2, -1)) < 0 && errno == EINTR) {}
+        if(r < 0) { GOB_JSON_LOGE("Failed to poll %d:%s", _fd, std::strerror(errno)); return -1; }
+        if(fds[1].revents) { return 0; }
+    }
+    ssize_t sz;
+    while((sz = ::read(_fd, buf, len)) < 0 && errno == EINTR) {}
+    if(sz < 0) { GOB_JSON_LOGE("Failed to read %d:%s", _fd, std::strerror(errno)); }
+    return sz;
+}
+
+bool ReadAheadSource::start()
+{
+    if(_thread.joinable()) { return true; }
+    if(!_func && _fd < 0) { return false; }
+    _thread = std::thread(&ReadAheadSource::reader, this);
+    return true;
+}
+
+void ReadAheadSource::stop()
+{
+    _stop.store(true);
+    if(_wake[1] >= 0)
+    {
+        const char c{};
+        while(::write(_wake[1], &c, 1) < 0 && errno == EINTR) {}
+    }
+    { std::lock_guard<std::mutex> lk(_mutex); }
+    _cv.notify_all();
+    if(_thread.joinable()) { _thread.join(); }
+}
+
+void ReadAheadSource::reader()
+{
+    while(!_stop.load())
+    {
+        const size_t head = _head.load(std::memory_order_relaxed);
+        if(head - _tail.load() == _chunkCount)
+        {
+            // Full. Wait for the consumer.
+            waitFor([this, head]() { return _stop.load() || head - _tail.load() != _chunkCount; });
+            continue;
+        }
+
+        const size_t slot = head % _chunkCount;
+        char* buf = _chunks.get() + slot * _chunkSize;
+        const ssize_t sz = _func ? _func(_arg, buf, _chunkSize) : readFd(buf, _chunkSize);
+        if(sz <= 0)
+        {
+            if(sz < 0) { _readError.store(true); }
+            break;
+        }
+        _lengths[slot] = static_cast<size_t>(sz);
+        _readSize.fetch_add(sz, std::memory_order_relaxed);
+        _head.store(head + 1); // Publish
+        wakeUp();
+    }
+    _eof.store(true);
+    wakeUp();
+}
+
+const char* ReadAheadSource::acquire(size_t& len)
+{
+    len = 0;
+    const size_t tail = _tail.load(std::memory_order_relaxed);
+    for(;;)
+    {
+        // Check eof before head, chunks published before eof are not missed.
+        const bool eof = _eof.load();
+        if(_head.load() != tail)
+        {
+            const size_t slot = tail % _chunkCount;
+            len = _lengths[slot];
+            return _chunks.get() + slot * _chunkSize;
+        }
+        if(eof) { return nullptr; }
+
+        // Empty. Wait for the reader.
+        waitFor([this, tail]() { return _eof.load() || _head.load() != tail; });
+    }
+}
+
+void ReadAheadSource::release()
+{
+    _tail.store(_tail.load(std::memory_order_relaxed) + 1);
+    wakeUp();
+}
+
+bool ReadAheadSource::parse(StreamingParser& parser)
+{
+    if(!start()) { return false; }
+    size_t len{};
+    const char* p{};
+    while(!parser.hasError() && (p = acquire(len)) != nullptr)
+    {
+        parser.parse(p, len);
+        release();
+    }
+    const bool reachedEnd = (p == nullptr);
+    stop();
+    return reachedEnd && !parser.hasError() && !hasError();
+}
+
+//
+}}
+#endif
@@ -0,0 +1,152 @@
+/*!
+  @file gob_json_read_ahead.hpp
+  @brief Read-ahead source that reads on its own thread. (Native only)
+ */
+#ifndef GOB_JSON_READ_AHEAD_HPP
+#define GOB_JSON_READ_AHEAD_HPP
+
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(ARDUINO)
+
+#include "gob_json.hpp"
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <sys/types.h>
+
+namespace goblib { namespace json {
+
+#ifndef GOB_JSON_READ_AHEAD_CHUNK_SIZE
+# pragma message "[gob_json] Read-ahead chunk size as default"
+# define GOB_JSON_READ_AHEAD_CHUNK_SIZE  (64 * 1024)
+#else
+# pragma message "[gob_json] Defined read-ahead chunk size=" GOB_JSON_STRINGIFY(GOB_JSON_READ_AHEAD_CHUNK_SIZE)
+#endif
+
+#ifndef GOB_JSON_READ_AHEAD_CHUNK_COUNT
+# pragma message "[gob_json] Read-ahead chunk count as default"
+# define GOB_JSON_READ_AHEAD_CHUNK_COUNT  (4)
+#else
+# pragma message "[gob_json] Defined read-ahead chunk count=" GOB_JSON_STRINGIFY(GOB_JSON_READ_AHEAD_CHUNK_COUNT)
+#endif
+
+/*!
+  @class ReadAheadSource
+  @brief Reads on the reader thread while the parser consumes the previous chunks.
+  @details Fixed-size chunks are allocated once and circulate in a single-producer single-consumer ring.
+  The reader thread fills a chunk and publishes it, the consumer parses it in place and returns it.
+  The ring indices are lock-free; a thread blocks only when the ring is full or empty,
+  and the other side takes the mutex only if a thread is sleeping.
+  A file descriptor is polled together with a self-pipe, so stop() interrupts the read in progress.
+  @code
+  ReadAheadSource src(fd);     // pipe, socket, file...
+  src.parse(parser);           // Returns at EOF, read error or parse error
+  @endcode
+ */
+class ReadAheadSource
+{
+  public:
+    /*!
+      @brief Read function type
+      @return Bytes read, 0 at EOF, negative on error (Like read(2))
+     */
+    using read_function_t = ssize_t(*)(void* arg, char* buf, size_t len);
+
+    /*!
+      @brief Read from file descriptor
+      @param fd File descriptor (Not closed by this class)
+      @param chunkSize Size of each chunk
+      @param chunkCount Number of chunks (At least 2)
+     */
+    explicit ReadAheadSource(const int fd,
+                             const size_t chunkSize = GOB_JSON_READ_AHEAD_CHUNK_SIZE,
+                             const size_t chunkCount = GOB_JSON_READ_AHEAD_CHUNK_COUNT);
+    /*! @brief Read by user function */
+    ReadAheadSource(read_function_t func, void* arg,
+                    const size_t chunkSize = GOB_JSON_READ_AHEAD_CHUNK_SIZE,
+                    const size_t chunkCount = GOB_JSON_READ_AHEAD_CHUNK_COUNT);
+    ~ReadAheadSource();
+    ReadAheadSource(const ReadAheadSource&) = delete;
+    ReadAheadSource& operator=(const ReadAheadSource&) = delete;
+
+    /*! @brief Start the reader thread */
+    bool start();
+    /*!
+      @brief Stop and join the reader thread. (Unconsumed chunks are discarded)
+      @warning With the user read function, waits for the read in progress to return.
+     */
+    void stop();
+
+    ///@name Consumer
+    ///@{
+    /*!
+      @brief Acquire the next filled chunk (Blocks until available)
+      @param[out] len Bytes in the chunk
+      @return Pointer to the chunk, nullptr at the end
+      @note The chunk is valid until release().
+     */
+    const char* acquire(size_t& len);
+    /*! @brief Return the acquired chunk to the reader */
+    void release();
+    /*!
+      @brief Parse until the end of input
+      @return True if the input reached EOF without read or parse errors
+      @note Starts the reader thread if not started.
+     */
+    bool parse(StreamingParser& parser);
+    ///@}
+
+    /*! @brief Read error occurred? */
+    bool hasError() const { return _readError.load(std::memory_order_acquire); }
+    /*! @brief Total bytes read */
+    uint64_t getReadSize() const { return _readSize.load(std::memory_order_relaxed); }
+
+  private:
+    void allocate(const size_t chunkSize, const size_t chunkCount);
+    void reader();
+    ssize_t readFd(char* buf, size_t len);
+    template<class Pred> void waitFor(Pred pred)
+    {
+        // The notifier checks _sleepers after updating the indices, so that wake-up is not lost.
+        std::unique_lock<std::mutex> lk(_mutex);
+        _sleepers.fetch_add(1);
+        _cv.wait(lk, pred);
+        _sleepers.fetch_sub(1);
+    }
+    void wakeUp()
+    {
+        if(_sleepers.load() > 0)
+        {
+            { std::lock_guard<std::mutex> lk(_mutex); }
+            _cv.notify_all();
+        }
+    }
+
+    read_function_t _func{};
+    void* _arg{};
+    int _fd{-1};
+    int _wake[2]{-1, -1}; // Self-pipe to interrupt poll
+
+    size_t _chunkSize{}, _chunkCount{};
+    std::unique_ptr<char[]> _chunks{};
+    std::unique_ptr<size_t[]> _lengths{};
+
+    // Ring indices (monotonically increasing, slot is index % count)
+    std::atomic<size_t> _head{0}; // Next slot the reader fills
+    std::atomic<size_t> _tail{0}; // Next slot the consumer takes
+    std::atomic<bool> _eof{false}, _stop{false}, _readError{false};
+    std::atomic<uint64_t> _readSize{0};
+    std::atomic<int> _sleepers{0};
+
+    std::mutex _mutex{};
+    std::condition_variable _cv{};
+    std::thread _thread{};
+};
+
+//
+}}
+#endif
+#endif
@@ -0,0 +1,425 @@
+/*!
+  @file gob_json_tape.cpp
+  @brief Binary event tape. Record the parser events once, replay them many times.
+ */
+#include "gob_json_tape.hpp"
+#include "internal/gob_json_log.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(ARDUINO)
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <fcntl.h>
+# include <unistd.h>
+# include <cerrno>
+# define GOB_JSON_TAPE_MMAP 1
+#endif
+
+namespace goblib { namespace json {
+
+namespace
+{
+constexpr uint8_t MAGIC[] = { 'G', 'J', 'T', 1 };
+
+enum Kind : uint8_t
+{
+    StartDocument, EndDocument,
+    StartObject, EndObject,
+    StartArray, EndArray,
+    Value, Whitespace,
+    DefineKey,
+};
+constexpr uint8_t KIND_MASK = 0x0F;
+constexpr uint8_t TYPE_SHIFT = 4;
+constexpr uint8_t RAW = 0x80;
+
+inline uint64_t zigzag(const int64_t v) { return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63); }
+inline int64_t unzigzag(const uint64_t v) { return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1); }
+
+// FNV-1a
+inline uint32_t hash(const char* s)
+{
+    uint32_t h = 2166136261u;
+    while(*s) { h = (h ^ static_cast<uint8_t>(*s++)) * 16777619u; }
+    return h;
+}
+
+// Bounds checked reader
+struct Reader
+{
+    const uint8_t* p;
+    const uint8_t* end;
+
+    bool byte(uint8_t& v)
+    {
+        if(p >= end) { return false; }
+        v = *p++;
+        return true;
+    }
+    bool varint(uint64_t& v)
+    {
+        v = 0;
+        for(int shift = 0; shift < 64; shift += 7)
+        {
+            if(p >= end) { return false; }
+            const uint8_t b = *p++;
+            v |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if(!(b & 0x80)) { return true; }
+        }
+        return false;
+    }
+    // Text with '\0'
+    bool text(const char*& s, uint64_t& len)
+    {
+        if(!varint(len) || len >= static_cast<uint64_t>(end - p) || p[len] != '\0') { return false; }
+        s = reinterpret_cast<const char*>(p);
+        p += len + 1;
+        return true;
+    }
+};
+//
+}
+
+// ----------------------------------------------------------------------------
+// TapeRecorder
+void TapeRecorder::clear()
+{
+    _tape.assign(MAGIC, MAGIC + sizeof(MAGIC));
+    _keyPool.clear();
+    _keyOffsets.clear();
+    _slots.assign(64, 0);
+    _lastCount = 0;
+}
+
+bool TapeRecorder::save(const char* path) const
+{
+    FILE* fp = std::fopen(path, "wb");
+    if(!fp)
+    {
+        GOB_JSON_LOGE("Failed to open %s", path);
+        return false;
+    }
+    const bool ok = std::fwrite(_tape.data(), 1, _tape.size(), fp) == _tape.size();
+    return (std::fclose(fp) == 0) && ok;
+}
+
+void TapeRecorder::putVarint(uint64_t v)
+{
+    while(v >= 0x80)
+    {
+        _tape.push_back(static_cast<uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    _tape.push_back(static_cast<uint8_t>(v));
+}
+
+void TapeRecorder::putText(const char* s, const size_t len)
+{
+    putVarint(len);
+    _tape.insert(_tape.end(), s, s + len);
+    _tape.push_back('\0');
+}
+
+uint32_t TapeRecorder::intern(const char* key)
+{
+    const size_t mask = _slots.size() - 1;
+    size_t i = hash(key) & mask;
+    for(; _slots[i]; i = (i + 1) & mask)
+    {
+        const uint32_t id = _slots[i] - 1;
+        if(std::strcmp(&_keyPool[_keyOffsets[id]], key) == 0) { return id; }
+    }
+
+    // New key
+    const uint32_t id = static_cast<uint32_t>(_keyOffsets.size());
+    const size_t len = std::strlen(key);
+    _keyOffsets.push_back(static_cast<uint32_t>(_keyPool.size()));
+    _keyPool.insert(_keyPool.end(), key, key + len + 1);
+    _slots[i] = id + 1;
+    _tape.push_back(DefineKey);
+    putText(key, len);
+
+    // Rehash at load factor 1/2
+    if(_keyOffsets.size() * 2 > _slots.size())
+    {
+        _slots.assign(_slots.size() * 2, 0);
+        const size_t m = _slots.size() - 1;
+        for(uint32_t k = 0; k < _keyOffsets.size(); ++k)
+        {
+            size_t j = hash(&_keyPool[_keyOffsets[k]]) & m;
+            while(_slots[j]) { j = (j + 1) & m; }
+            _slots[j] = k + 1;
+        }
+    }
+    return id;
+}
+
+void TapeRecorder::putEvent(const uint8_t tag, const ElementPath& path)
+{
+    // Difference from the previous path
+    const int count = path.getCount();
+    int keep{};
+    while(keep < count && keep < _lastCount)
+    {
+        auto& a = *path.get(keep);
+        auto& b = _last[keep];
+        if(a.getIndex() != b.getIndex() || std::strcmp(a.getKey(), b.getKey()) != 0) { break; }
+        ++keep;
+    }
+    // Key definitions must precede the event.
+    for(int i = keep; i < count; ++i)
+    {
+        auto sel = path.get(i);
+        _encoded[i] = sel->isObject() ? (intern(sel->getKey()) << 1) : ((static_cast<uint32_t>(sel->getIndex()) << 1) | 1);
+        _last[i] = *sel;
+    }
+    _lastCount = count;
+
+    // keep << 2 | nsel (nsel >= 3 follows)
+    const int nsel = count - keep;
+    _tape.push_back(tag);
+    putVarint((static_cast<uint64_t>(keep) << 2) | (nsel < 3 ? nsel : 3));
+    if(nsel >= 3) { putVarint(nsel); }
+    for(int i = keep; i < count; ++i) { putVarint(_encoded[i]); }
+}
+
+void TapeRecorder::startDocument()                     { _tape.push_back(StartDocument); }
+void TapeRecorder::endDocument()                       { _tape.push_back(EndDocument); }
+void TapeRecorder::startObject(const ElementPath& path) { putEvent(StartObject, path); }
+void TapeRecorder::endObject(const ElementPath& path)   { putEvent(EndObject, path); }
+void TapeRecorder::startArray(const ElementPath& path)  { putEvent(StartArray, path); }
+void TapeRecorder::endArray(const ElementPath& path)    { putEvent(EndArray, path); }
+
+void TapeRecorder::whitespace(const char ch)
+{
+    _tape.push_back(Whitespace);
+    _tape.push_back(static_cast<uint8_t>(ch));
+}
+
+void TapeRecorder::value(const ElementPath& path, const ElementValue& value)
+{
+    const auto type = value.getType();
+    const bool raw = value.hasRaw() && !_convert;
+    putEvent(static_cast<uint8_t>(Value | (static_cast<uint8_t>(type) << TYPE_SHIFT) | (raw ? RAW : 0)), path);
+    if(raw)
+    {
+        // length << 3 | flags
+        const size_t len = value.getRawLength();
+        putVarint((static_cast<uint64_t>(len) << 3) | (value.getNumberFlags() & 0x07));
+        _tape.insert(_tape.end(), value.getRaw(), value.getRaw() + len);
+        _tape.push_back('\0');
+        return;
+    }
+    switch(type)
+    {
+    case ElementValue::Type::Int:
+        putVarint(zigzag(static_cast<int64_t>(value.getInt())));
+        break;
+    case ElementValue::Type::Float:
+    {
+        const double d = value.getFloat();
+        uint8_t b[sizeof(d)];
+        std::memcpy(b, &d, sizeof(d));
+        _tape.insert(_tape.end(), b, b + sizeof(b));
+    }
+        break;
+    case ElementValue::Type::String:
+    {
+        const char* s = value.getString();
+        putText(s, std::strlen(s));
+    }
+        break;
+    case ElementValue::Type::Bool:
+        _tape.push_back(value.getBool() ? 1 : 0);
+        break;
+    default: break;
+    }
+}
+
+// ----------------------------------------------------------------------------
+// TapePlayer
+#if defined(GOB_JSON_TAPE_MMAP)
+bool TapePlayer::open(const char* path)
+{
+    close();
+    int fd = ::open(path, O_RDONLY);
+    if(fd < 0)
+    {
+        GOB_JSON_LOGE("Failed to open %s:%s", path, std::strerror(errno));
+        return false;
+    }
+    struct stat st{};
+    if(fstat(fd, &st) != 0 || st.st_size <= 0)
+    {
+        GOB_JSON_LOGE("Failed to fstat or empty %s", path);
+        ::close(fd);
+        return false;
+    }
+    void* p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if(p == MAP_FAILED)
+    {
+        GOB_JSON_LOGE("Failed to mmap %s:%s", path, std::strerror(errno));
+        return false;
+    }
+    madvise(p, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+    _data = static_cast<const uint8_t*>(p);
+    _size = static_cast<size_t>(st.st_size);
+    _mapped = true;
+    return true;
+}
+#endif
+
+void TapePlayer::close()
+{
+#if defined(GOB_JSON_TAPE_MMAP)
+    if(_mapped) { munmap(const_cast<uint8_t*>(_data), _size); }
+#endif
+    _mapped = false;
+    _data = nullptr;
+    _size = 0;
+}
+
+bool TapePlayer::replay(Handler& handler)
+{
+    _error = true;
+    _keys.clear();
+    _keyLengths.clear();
+    while(_path.getCount() > 0) { _path.pop(); }
+
+    if(!_data || _size < sizeof(MAGIC) || std::memcmp(_data, MAGIC, sizeof(MAGIC)) != 0)
+    {
+        GOB_JSON_LOGE("Not a tape");
+        return false;
+    }
+    Reader r{_data + sizeof(MAGIC), _data + _size};
+    uint8_t tag;
+    while(r.byte(tag))
+    {
+        const uint8_t kind = tag & KIND_MASK;
+        switch(kind)
+        {
+        case DefineKey:
+        {
+            const char* s;
+            uint64_t len;
+            if(!r.text(s, len)) { GOB_JSON_LOGE("Broken key"); return false; }
+            _keys.push_back(s);
+            _keyLengths.push_back(static_cast<uint32_t>(len));
+        }
+            continue;
+        case StartDocument: handler.startDocument(); continue;
+        case EndDocument:   handler.endDocument();   continue;
+        case Whitespace:
+        {
+            uint8_t ch;
+            if(!r.byte(ch)) { GOB_JSON_LOGE("Broken whitespace"); return false; }
+            handler.whitespace(static_cast<char>(ch));
+        }
+            continue;
+        case StartObject: case EndObject: case StartArray: case EndArray: case Value:
+            break;
+        default:
+            GOB_JSON_LOGE("Unknown tag %02x", tag);
+            return false;
+        }
+
+        // Rebuild the path
+        uint64_t keep, nsel;
+        if(!r.varint(keep)) { GOB_JSON_LOGE("Broken path"); return false; }
+        nsel = keep & 3;
+        keep >>= 2;
+        if((nsel == 3 && !r.varint(nsel)) || keep > static_cast<uint64_t>(_path.getCount()) ||
+           keep + nsel > GOB_JSON_PARSER_STACK_MAX_DEPTH)
+        {
+            GOB_JSON_LOGE("Broken path");
+            return false;
+        }
+        while(_path.getCount() > static_cast<int>(keep)) { _path.pop(); }
+        for(uint64_t i = 0; i < nsel; ++i)
+        {
+            uint64_t v;
+            if(!r.varint(v)) { GOB_JSON_LOGE("Broken selector"); return false; }
+            _path.push();
+            auto cur = _path.getCurrent();
+            if(v & 1) { cur->index = static_cast<int>(v >> 1); continue; }
+            const uint64_t id = v >> 1;
+            if(id >= _keys.size()) { GOB_JSON_LOGE("Unknown key %llu", (unsigned long long)id); return false; }
+            const size_t len = std::min<size_t>(_keyLengths[id], sizeof(cur->key) - 1);
+            std::memcpy(cur->key, _keys[id], len);
+            cur->key[len] = '\0';
+        }
+
+        switch(kind)
+        {
+        case StartObject: handler.startObject(_path); continue;
+        case EndObject:   handler.endObject(_path);   continue;
+        case StartArray:  handler.startArray(_path);  continue;
+        case EndArray:    handler.endArray(_path);    continue;
+        default: break;
+        }
+
+        // Value
+        const auto type = static_cast<ElementValue::Type>((tag & ~RAW) >> TYPE_SHIFT);
+        bool ok = true;
+        if(tag & RAW)
+        {
+            uint64_t v{};
+            ok = r.varint(v);
+            const uint64_t len = v >> 3;
+            ok = ok && len < static_cast<uint64_t>(r.end - r.p) && r.p[len] == '\0';
+            if(ok)
+            {
+                _value.withNumber(reinterpret_cast<const char*>(r.p), static_cast<size_t>(len), static_cast<uint8_t>(v & 0x07));
+                r.p += len + 1;
+            }
+        }
+        else
+        {
+            switch(type)
+            {
+            case ElementValue::Type::Int:
+            {
+                uint64_t v{};
+                ok = r.varint(v);
+                _value.with(static_cast<ElementValue::number_t>(unzigzag(v)));
+            }
+                break;
+            case ElementValue::Type::Float:
+            {
+                double d{};
+                ok = (r.end - r.p) >= static_cast<ptrdiff_t>(sizeof(d));
+                if(ok) { std::memcpy(&d, r.p, sizeof(d)); r.p += sizeof(d); }
+                _value.with(static_cast<ElementValue::fp_t>(d));
+            }
+                break;
+            case ElementValue::Type::String:
+            {
+                const char* s{};
+                uint64_t len{};
+                ok = r.text(s, len);
+                _value.with(s);
+            }
+                break;
+            case ElementValue::Type::Bool:
+            {
+                uint8_t b{};
+                ok = r.byte(b);
+                _value.with(b != 0);
+            }
+                break;
+            case ElementValue::Type::Null: _value.with(); break;
+            default: ok = false; break;
+            }
+        }
+        if(!ok) { GOB_JSON_LOGE("Broken value"); return false; }
+        handler.value(_path, _value);
+    }
+    _error = false;
+    return true;
+}
+
+//
+}}
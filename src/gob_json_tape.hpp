@@ -0,0 +1,140 @@
+/*!
+  @file gob_json_tape.hpp
+  @brief Binary event tape. Record the parser events once, replay them many times.
+ */
+#ifndef GOB_JSON_TAPE_HPP
+#define GOB_JSON_TAPE_HPP
+
+#include "gob_json_handler.hpp"
+#include "gob_json.hpp" // GOB_JSON_PARSER_STACK_MAX_DEPTH
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace goblib { namespace json {
+
+/*!
+  @class TapeRecorder
+  @brief Handler that records the events into a compact binary tape.
+  @details Tape format (version 1)
+  - Header "GJT" and the version byte
+  - Each record is a tag byte (kind, value type) followed by the operands in LEB128 varint.
+    - Key definition: length, bytes and '\0'. The id is the order of definition, each key is stored once.
+    - Path: levels kept from the previous event << 2 | number of selectors that follow (3: followed by the number),
+      and selectors (index << 1 | 1, or key id << 1)
+    - Value: zigzag integer, IEEE754 double, raw number (length << 3 | flags, text and '\0'),
+      string (length, text and '\0') or bool
+  Raw numbers are kept as text by default, so the consumer can convert them as it likes.
+  With setConvertNumbers(true), converted values are stored instead. (Smaller, no conversion on replay)
+  @code
+  TapeRecorder rec;
+  StreamingParser parser(&rec);
+  parser.parse(buf, len);
+  rec.save("doc.tape");
+
+  TapePlayer player;
+  if(player.open("doc.tape"))
+  {
+      player.replay(consumerA);
+      player.replay(consumerB);
+  }
+  @endcode
+ */
+class TapeRecorder : public Handler
+{
+  public:
+    explicit TapeRecorder(const bool convertNumbers = false) : _convert(convertNumbers) { clear(); }
+
+    /*! @brief Store converted numbers instead of the raw text */
+    void setConvertNumbers(const bool b) { _convert = b; }
+    /*! @brief Discard the tape */
+    void clear();
+
+    /*! @brief Tape */
+    const uint8_t* data() const { return _tape.data(); }
+    /*! @brief Tape size in bytes */
+    size_t size() const { return _tape.size(); }
+    /*! @brief Number of interned keys */
+    size_t keys() const { return _keyOffsets.size(); }
+    /*! @brief Write the tape to the file */
+    bool save(const char* path) const;
+
+    ///@name Handler
+    ///@{
+    virtual void startDocument() override;
+    virtual void endDocument() override;
+    virtual void startObject(const ElementPath& path) override;
+    virtual void endObject(const ElementPath& path) override;
+    virtual void startArray(const ElementPath& path) override;
+    virtual void endArray(const ElementPath& path) override;
+    virtual void value(const ElementPath& path, const ElementValue& value) override;
+    virtual void whitespace(const char ch) override;
+    ///@}
+
+  protected:
+    uint32_t intern(const char* key);
+    void putVarint(uint64_t v);
+    void putText(const char* s, const size_t len);
+    void putEvent(const uint8_t tag, const ElementPath& path);
+
+  private:
+    std::vector<uint8_t> _tape{};
+    // Interned keys (Open addressing table of id + 1)
+    std::vector<char> _keyPool{};
+    std::vector<uint32_t> _keyOffsets{};
+    std::vector<uint32_t> _slots{};
+    // Previous path
+    ElementSelector _last[GOB_JSON_PARSER_STACK_MAX_DEPTH]{};
+    int _lastCount{};
+    // Selectors that differ from the previous path
+    uint32_t _encoded[GOB_JSON_PARSER_STACK_MAX_DEPTH]{};
+    bool _convert{};
+};
+
+/*!
+  @class TapePlayer
+  @brief Replays the tape recorded by TapeRecorder into any handler.
+  @details Strings, raw numbers and keys are passed without copying from the tape.
+  Replaying does not tokenize the text, so it is much faster than parsing again.
+  @note The tape must be alive while replaying. (set)
+ */
+class TapePlayer
+{
+  public:
+    TapePlayer() {}
+    ~TapePlayer() { close(); }
+    TapePlayer(const TapePlayer&) = delete;
+    TapePlayer& operator=(const TapePlayer&) = delete;
+
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(ARDUINO)
+    /*! @brief Map the tape file (Native only) */
+    bool open(const char* path);
+#endif
+    /*! @brief Unmap the file, or forget the tape set */
+    void close();
+    /*! @brief Set the tape in memory (Not owned) */
+    void set(const uint8_t* data, const size_t len) { close(); _data = data; _size = len; }
+    /*! @brief Tape size */
+    size_t size() const { return _size; }
+
+    /*!
+      @brief Pass all events to the handler
+      @return False if the tape is broken (Events until the broken record are passed)
+     */
+    bool replay(Handler& handler);
+    /*! @brief Broken tape detected? */
+    bool hasError() const { return _error; }
+
+  private:
+    const uint8_t* _data{};
+    size_t _size{};
+    bool _mapped{}, _error{};
+    ElementPath _path{};
+    ElementValue _value{};
+    std::vector<const char*> _keys{};
+    std::vector<uint32_t> _keyLengths{};
+};
+
+//
+}}
+#endif
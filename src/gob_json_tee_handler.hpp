@@ -0,0 +1,249 @@
+/*!
+  @file gob_json_tee_handler.hpp
+  @brief Handler that forwards the events to several handlers. (Fan-out)
+ */
+#ifndef GOB_JSON_TEE_HANDLER_HPP
+#define GOB_JSON_TEE_HANDLER_HPP
+
+#include "gob_json_handler.hpp"
+#include "gob_json_element_path.hpp" // GOB_JSON_STRINGIFY
+#include <cstdint>
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+
+namespace goblib { namespace json {
+
+#ifndef GOB_JSON_TEE_MAX_HANDLERS
+# pragma message "[gob_json] Tee max handlers as default"
+# define GOB_JSON_TEE_MAX_HANDLERS  (4)
+#else
+# pragma message "[gob_json] Defined tee max handlers=" GOB_JSON_STRINGIFY(GOB_JSON_TEE_MAX_HANDLERS)
+#endif
+
+/*!
+  @class TeeControl
+  @brief Mute and skip of each child of the tee handlers.
+  @tparam N Number of children
+  @details
+  - mute: The child receives no events until unmuted.
+  - skip: The child receives no events until the end of the current container, then receives its end event.
+    Called in startObject/startArray, the container just started is skipped.
+    Called in value or the end event, the rest of the container that holds it is skipped.
+  @note Change the state of the child itself during the event, or between the documents. Otherwise the child may see unbalanced events.
+ */
+template<size_t N> class TeeControl
+{
+  public:
+    /*! @brief Mute or unmute the child */
+    void mute(const size_t index, const bool b = true) { if(index < N) { _channels[index].muted = b; } }
+    /*! @brief Is the child muted? */
+    bool isMuted(const size_t index) const { return index < N && _channels[index].muted; }
+    /*! @brief Skip the rest of the current container for the child */
+    void skip(const size_t index) { if(index < N && _depth > 0) { _channels[index].skipDepth = _depth; } }
+    /*! @brief Is the child skipping? */
+    bool isSkipping(const size_t index) const { return index < N && _channels[index].skipDepth; }
+    /*! @brief Current nesting level */
+    int getDepth() const { return _depth; }
+
+  protected:
+    enum class Event : uint8_t { StartDocument, EndDocument, StartObject, EndObject, StartArray, EndArray, Value, Whitespace };
+
+    struct Channel
+    {
+        int skipDepth; // Depth of the skipped container, 0 if not skipping
+        bool muted;
+    };
+
+    // Update the depth before passing the event
+    void enter(const Event e)
+    {
+        if(e == Event::StartObject || e == Event::StartArray) { ++_depth; }
+        else if(e == Event::EndObject || e == Event::EndArray) { _depth -= (_depth > 0); }
+        else if(e == Event::StartDocument) { _depth = 0; }
+    }
+
+    // Pass the event to the child?
+    bool accept(const size_t index, const Event e)
+    {
+        auto& c = _channels[index];
+        if(c.muted) { return false; }
+        if(!c.skipDepth) { return true; }
+        if((e == Event::EndObject || e == Event::EndArray) && _depth < c.skipDepth)
+        {
+            c.skipDepth = 0; // End of the skipped container
+            return true;
+        }
+        return false;
+    }
+
+    // Forward the event to the handler
+    template<class H> static void call(H& h, const Event e, const ElementPath* path, const ElementValue* value, const char ch)
+    {
+        switch(e)
+        {
+        case Event::StartDocument: h.H::startDocument(); break;
+        case Event::EndDocument:   h.H::endDocument(); break;
+        case Event::StartObject:   h.H::startObject(*path); break;
+        case Event::EndObject:     h.H::endObject(*path); break;
+        case Event::StartArray:    h.H::startArray(*path); break;
+        case Event::EndArray:      h.H::endArray(*path); break;
+        case Event::Value:         h.H::value(*path, *value); break;
+        case Event::Whitespace:    h.H::whitespace(ch); break;
+        }
+    }
+
+    void clearChannels() { for(auto& c : _channels) { c = Channel{}; } _depth = 0; }
+
+  private:
+    Channel _channels[N]{};
+    int _depth{};
+};
+
+/*!
+  @class TeeHandler
+  @brief Forwards each event to the children in order of addition. (Runtime, fixed capacity)
+  @details The path and the value are passed by reference, no copies.
+  @code
+  TeeHandler tee;
+  tee.add(&logger);
+  tee.add(&binder);
+  StreamingParser parser(&tee);
+  parser.parse(buf, len); // Parsed once, handled twice
+  @endcode
+  @note Capacity is GOB_JSON_TEE_MAX_HANDLERS.
+ */
+class TeeHandler : public Handler, public TeeControl<GOB_JSON_TEE_MAX_HANDLERS>
+{
+  public:
+    TeeHandler() {}
+
+    /*!
+      @brief Add the child
+      @return False if no room
+     */
+    bool add(Handler* h)
+    {
+        if(!h || _size >= GOB_JSON_TEE_MAX_HANDLERS) { return false; }
+        _children[_size++] = h;
+        return true;
+    }
+    /*! @brief Remove all children */
+    void clear() { _size = 0; clearChannels(); }
+    /*! @brief Number of children */
+    size_t size() const { return _size; }
+    /*! @brief Gets the child */
+    Handler* get(const size_t index) const { return index < _size ? _children[index] : nullptr; }
+    /*! @brief Index of the child, size() if not found */
+    size_t indexOf(const Handler* h) const
+    {
+        size_t i{};
+        while(i < _size && _children[i] != h) { ++i; }
+        return i;
+    }
+
+    ///@name Handler
+    ///@{
+    virtual void startDocument() override { emit(Event::StartDocument); }
+    virtual void endDocument() override { emit(Event::EndDocument); }
+    virtual void startObject(const ElementPath& path) override { emit(Event::StartObject, &path); }
+    virtual void endObject(const ElementPath& path) override { emit(Event::EndObject, &path); }
+    virtual void startArray(const ElementPath& path) override { emit(Event::StartArray, &path); }
+    virtual void endArray(const ElementPath& path) override { emit(Event::EndArray, &path); }
+    virtual void value(const ElementPath& path, const ElementValue& value) override { emit(Event::Value, &path, &value); }
+    virtual void whitespace(const char ch) override { emit(Event::Whitespace, nullptr, nullptr, ch); }
+    ///@}
+
+  protected:
+    void emit(const Event e, const ElementPath* path = nullptr, const ElementValue* value = nullptr, const char ch = 0)
+    {
+        enter(e);
+        for(size_t i = 0; i < _size; ++i)
+        {
+            if(accept(i, e)) { dispatch(*_children[i], e, path, value, ch); }
+        }
+    }
+
+  private:
+    // Virtual call
+    static void dispatch(Handler& h, const Event e, const ElementPath* path, const ElementValue* value, const char ch)
+    {
+        switch(e)
+        {
+        case Event::StartDocument: h.startDocument(); break;
+        case Event::EndDocument:   h.endDocument(); break;
+        case Event::StartObject:   h.startObject(*path); break;
+        case Event::EndObject:     h.endObject(*path); break;
+        case Event::StartArray:    h.startArray(*path); break;
+        case Event::EndArray:      h.endArray(*path); break;
+        case Event::Value:         h.value(*path, *value); break;
+        case Event::Whitespace:    h.whitespace(ch); break;
+        }
+    }
+
+    Handler* _children[GOB_JSON_TEE_MAX_HANDLERS]{};
+    size_t _size{};
+};
+
+/*!
+  @class StaticTeeHandler
+  @brief Forwards each event to the children of the types known at compile time.
+  @tparam Hs Concrete types of the children
+  @details The calls are bound to Hs statically (not virtual), so they can be inlined.
+  @code
+  Logger logger;
+  Binder binder;
+  auto tee = makeTeeHandler(logger, binder);
+  StreamingParser parser(&tee);
+  @endcode
+  @warning Hs must be the actual types of the children. Overrides in the types derived from Hs are not called.
+ */
+template<class... Hs> class StaticTeeHandler : public Handler, public TeeControl<sizeof...(Hs)>
+{
+    static_assert(sizeof...(Hs) > 0, "Requires at least one handler");
+    using Control = TeeControl<sizeof...(Hs)>;
+    using Event = typename Control::Event;
+
+  public:
+    explicit StaticTeeHandler(Hs&... hs) : _children(&hs...) {}
+
+    /*! @brief Number of children */
+    static constexpr size_t size() { return sizeof...(Hs); }
+
+    ///@name Handler
+    ///@{
+    virtual void startDocument() override { emit(Event::StartDocument); }
+    virtual void endDocument() override { emit(Event::EndDocument); }
+    virtual void startObject(const ElementPath& path) override { emit(Event::StartObject, &path); }
+    virtual void endObject(const ElementPath& path) override { emit(Event::EndObject, &path); }
+    virtual void startArray(const ElementPath& path) override { emit(Event::StartArray, &path); }
+    virtual void endArray(const ElementPath& path) override { emit(Event::EndArray, &path); }
+    virtual void value(const ElementPath& path, const ElementValue& value) override { emit(Event::Value, &path, &value); }
+    virtual void whitespace(const char ch) override { emit(Event::Whitespace, nullptr, nullptr, ch); }
+    ///@}
+
+  protected:
+    void emit(const Event e, const ElementPath* path = nullptr, const ElementValue* value = nullptr, const char ch = 0)
+    {
+        this->enter(e);
+        forward<0>(e, path, value, ch);
+    }
+    template<size_t I> typename std::enable_if<(I < sizeof...(Hs))>::type
+    forward(const Event e, const ElementPath* path, const ElementValue* value, const char ch)
+    {
+        if(this->accept(I, e)) { Control::call(*std::get<I>(_children), e, path, value, ch); }
+        forward<I + 1>(e, path, value, ch);
+    }
+    template<size_t I> typename std::enable_if<(I >= sizeof...(Hs))>::type
+    forward(const Event, const ElementPath*, const ElementValue*, const char) {}
+
+  private:
+    std::tuple<Hs*...> _children;
+};
+
+/*! @brief Make StaticTeeHandler from the children */
+template<class... Hs> StaticTeeHandler<Hs...> makeTeeHandler(Hs&... hs) { return StaticTeeHandler<Hs...>(hs...); }
+
+//
+}}
+#endif
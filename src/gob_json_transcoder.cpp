@@ -0,0 +1,307 @@
+/*!
+  @file gob_json_transcoder.cpp
+  @brief Transcode the parser events to CBOR / MessagePack without DOM.
+ */
+#include "gob_json_transcoder.hpp"
+#include "internal/gob_json_log.hpp"
+#include <cstring>
+#include <algorithm>
+
+namespace
+{
+// CBOR major types
+constexpr uint8_t CBOR_UNSIGNED = 0;
+constexpr uint8_t CBOR_NEGATIVE = 1;
+constexpr uint8_t CBOR_TEXT = 3;
+constexpr uint8_t CBOR_ARRAY = 4;
+constexpr uint8_t CBOR_MAP = 5;
+constexpr uint8_t CBOR_INDEFINITE = 31;
+constexpr uint8_t CBOR_BREAK = 0xFF;
+// MessagePack map32/array32 header placeholder
+constexpr size_t MSGPACK_CONTAINER_HEAD = 5;
+
+// Big-endian
+size_t storeBE(uint8_t* out, const uint64_t v, const size_t bytes)
+{
+    for(size_t i = 0; i < bytes; ++i) { out[i] = static_cast<uint8_t>(v >> ((bytes - 1 - i) * 8)); }
+    return bytes;
+}
+
+// Initial byte with the smallest argument
+size_t encodeCborHead(uint8_t* out, const uint8_t major, const uint64_t v)
+{
+    const uint8_t mt = major << 5;
+    if(v < 24)           { out[0] = mt | static_cast<uint8_t>(v); return 1; }
+    if(v <= 0xFF)        { out[0] = mt | 24; return 1 + storeBE(out + 1, v, 1); }
+    if(v <= 0xFFFF)      { out[0] = mt | 25; return 1 + storeBE(out + 1, v, 2); }
+    if(v <= 0xFFFFFFFFU) { out[0] = mt | 26; return 1 + storeBE(out + 1, v, 4); }
+    out[0] = mt | 27;
+    return 1 + storeBE(out + 1, v, 8);
+}
+
+size_t encodeMsgpackContainer(uint8_t* out, const bool object, const uint32_t count)
+{
+    if(count < 16)      { out[0] = (object ? 0x80 : 0x90) | static_cast<uint8_t>(count); return 1; }
+    if(count <= 0xFFFF) { out[0] = object ? 0xDE : 0xDC; return 1 + storeBE(out + 1, count, 2); }
+    out[0] = object ? 0xDF : 0xDD;
+    return 1 + storeBE(out + 1, count, 4);
+}
+//
+}
+
+namespace goblib { namespace json {
+
+void TranscodeHandler::reset()
+{
+    _stackPos = 0;
+    _error = false;
+    _bufferPos = 0;
+    _flushed = 0;
+}
+
+void TranscodeHandler::error(const char* estr)
+{
+    GOB_JSON_LOGE("%s depth:%d written:%zu", estr, _stackPos, getWrittenSize());
+    _error = true;
+}
+
+void TranscodeHandler::endDocument()
+{
+    flush();
+}
+
+bool TranscodeHandler::flush()
+{
+    if(_bufferPos == 0 || _error) { return !_error; }
+
+    // MessagePack headers must stay in the buffer if the sink cannot patch them.
+    size_t len = _bufferPos;
+    if(_format == BinaryFormat::MessagePack && _stackPos > 0 && !(_sink && _sink->canPatch()))
+    {
+        len = _stack[0].pos - _flushed;
+    }
+    if(len == 0) { return true; }
+
+    if(!_sink || !_sink->write(reinterpret_cast<const char*>(_buffer), len))
+    {
+        error("Failed to write to sink");
+        _bufferPos = 0;
+        return false;
+    }
+    std::memmove(_buffer, _buffer + len, _bufferPos - len);
+    _bufferPos -= len;
+    _flushed += len;
+    return true;
+}
+
+bool TranscodeHandler::reserve(const size_t len)
+{
+    if(_error) { return false; }
+    if(len <= sizeof(_buffer) - _bufferPos) { return true; }
+    if(!flush()) { return false; }
+    if(len > sizeof(_buffer) - _bufferPos)
+    {
+        error("Container does not fit in the buffer");
+        return false;
+    }
+    return true;
+}
+
+void TranscodeHandler::put(const uint8_t* s, size_t len)
+{
+    // Long string is passed in pieces.
+    while(len)
+    {
+        if(_bufferPos == sizeof(_buffer) && !reserve(1)) { return; }
+        auto sz = std::min(len, sizeof(_buffer) - _bufferPos);
+        std::memcpy(_buffer + _bufferPos, s, sz);
+        _bufferPos += sz;
+        s += sz;
+        len -= sz;
+    }
+}
+
+void TranscodeHandler::putHead(const uint8_t major, const uint64_t v)
+{
+    uint8_t head[9];
+    put(head, encodeCborHead(head, major, v));
+}
+
+void TranscodeHandler::putUnsigned(const uintmax_t v)
+{
+    if(_format == BinaryFormat::CBOR) { putHead(CBOR_UNSIGNED, v); return; }
+
+    uint8_t b[9];
+    size_t len{};
+    if(v < 0x80)             { b[0] = static_cast<uint8_t>(v); len = 1; } // positive fixint
+    else if(v <= 0xFF)       { b[0] = 0xCC; len = 1 + storeBE(b + 1, v, 1); }
+    else if(v <= 0xFFFF)     { b[0] = 0xCD; len = 1 + storeBE(b + 1, v, 2); }
+    else if(v <= 0xFFFFFFFF) { b[0] = 0xCE; len = 1 + storeBE(b + 1, v, 4); }
+    else                     { b[0] = 0xCF; len = 1 + storeBE(b + 1, v, 8); }
+    put(b, len);
+}
+
+void TranscodeHandler::putSigned(const intmax_t v)
+{
+    if(v >= 0) { putUnsigned(static_cast<uintmax_t>(v)); return; }
+    if(_format == BinaryFormat::CBOR) { putHead(CBOR_NEGATIVE, ~static_cast<uint64_t>(v)); return; } // -1 - v
+
+    uint8_t b[9];
+    size_t len{};
+    const uint64_t u = static_cast<uint64_t>(v);
+    if(v >= -32)             { b[0] = static_cast<uint8_t>(u); len = 1; } // negative fixint
+    else if(v >= INT8_MIN)   { b[0] = 0xD0; len = 1 + storeBE(b + 1, u, 1); }
+    else if(v >= INT16_MIN)  { b[0] = 0xD1; len = 1 + storeBE(b + 1, u, 2); }
+    else if(v >= INT32_MIN)  { b[0] = 0xD2; len = 1 + storeBE(b + 1, u, 4); }
+    else                     { b[0] = 0xD3; len = 1 + storeBE(b + 1, u, 8); }
+    put(b, len);
+}
+
+void TranscodeHandler::putFloat(const double v)
+{
+    const bool cbor = _format == BinaryFormat::CBOR;
+    uint8_t b[9];
+    const float f = static_cast<float>(v);
+    if(static_cast<double>(f) == v || v != v)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &f, sizeof(bits));
+        b[0] = cbor ? 0xFA : 0xCA;
+        put(b, 1 + storeBE(b + 1, bits, 4));
+        return;
+    }
+    uint64_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    b[0] = cbor ? 0xFB : 0xCB;
+    put(b, 1 + storeBE(b + 1, bits, 8));
+}
+
+void TranscodeHandler::putString(const char* s, const size_t len)
+{
+    if(_format == BinaryFormat::CBOR) { putHead(CBOR_TEXT, len); }
+    else
+    {
+        uint8_t b[5];
+        size_t hlen{};
+        if(len < 32)          { b[0] = 0xA0 | static_cast<uint8_t>(len); hlen = 1; } // fixstr
+        else if(len <= 0xFF)   { b[0] = 0xD9; hlen = 1 + storeBE(b + 1, len, 1); }
+        else if(len <= 0xFFFF) { b[0] = 0xDA; hlen = 1 + storeBE(b + 1, len, 2); }
+        else                   { b[0] = 0xDB; hlen = 1 + storeBE(b + 1, len, 4); }
+        put(b, hlen);
+    }
+    put(reinterpret_cast<const uint8_t*>(s), len);
+}
+
+// Count the element, and write the key if in object
+bool TranscodeHandler::beforeValue(const ElementPath& path)
+{
+    if(_error) { return false; }
+    if(_stackPos > 0)
+    {
+        auto& c = _stack[_stackPos - 1];
+        ++c.count;
+        if(c.object)
+        {
+            auto key = path.getKey();
+            putString(key, std::strlen(key));
+        }
+    }
+    return !_error;
+}
+
+void TranscodeHandler::begin(const ElementPath& path, const bool object)
+{
+    if(!beforeValue(path)) { return; }
+    if(_stackPos >= (int)(sizeof(_stack) / sizeof(_stack[0])))
+    {
+        error("Stack overflow");
+        return;
+    }
+    // Header is written as indefinite (CBOR) or the largest (MessagePack), and patched at the end.
+    const size_t hlen = (_format == BinaryFormat::CBOR) ? 1 : MSGPACK_CONTAINER_HEAD;
+    if(!reserve(hlen)) { return; }
+    _stack[_stackPos++] = { _flushed + _bufferPos, 0, object };
+    if(_format == BinaryFormat::CBOR)
+    {
+        _buffer[_bufferPos] = ((object ? CBOR_MAP : CBOR_ARRAY) << 5) | CBOR_INDEFINITE;
+    }
+    else
+    {
+        encodeMsgpackContainer(_buffer + _bufferPos, object, 0xFFFFFFFF);
+    }
+    _bufferPos += hlen;
+}
+
+void TranscodeHandler::end(const bool object)
+{
+    if(_error) { return; }
+    if(_stackPos <= 0 || _stack[_stackPos - 1].object != object)
+    {
+        error("Unexpected end of container");
+        return;
+    }
+    const auto c = _stack[--_stackPos];
+    const size_t placeholder = (_format == BinaryFormat::CBOR) ? 1 : MSGPACK_CONTAINER_HEAD;
+    uint8_t head[9];
+    if(c.pos < _flushed)
+    {
+        if(_format == BinaryFormat::CBOR) { put(CBOR_BREAK); return; } // Flushed, stay indefinite
+        // Overwrite the map32/array32 placeholder in the sink.
+        head[0] = object ? 0xDF : 0xDD;
+        storeBE(head + 1, c.count, 4);
+        if(!_sink->patch(_flushed - c.pos, reinterpret_cast<const char*>(head), MSGPACK_CONTAINER_HEAD))
+        {
+            error("Failed to patch the container header");
+        }
+        return;
+    }
+
+    // Replace the placeholder with the definite length header.
+    const size_t offset = c.pos - _flushed;
+    const size_t hlen = (_format == BinaryFormat::CBOR)
+            ? encodeCborHead(head, object ? CBOR_MAP : CBOR_ARRAY, c.count)
+            : encodeMsgpackContainer(head, object, c.count);
+    if(hlen > placeholder && hlen - placeholder > sizeof(_buffer) - _bufferPos)
+    {
+        put(CBOR_BREAK); // No room to grow (CBOR only)
+        return;
+    }
+    uint8_t* body = _buffer + offset + placeholder;
+    const size_t blen = _bufferPos - (offset + placeholder);
+    std::memmove(_buffer + offset + hlen, body, blen);
+    std::memcpy(_buffer + offset, head, hlen);
+    _bufferPos = _bufferPos + hlen - placeholder;
+}
+
+void TranscodeHandler::value(const ElementPath& path, const ElementValue& value)
+{
+    if(!beforeValue(path)) { return; }
+    const bool cbor = _format == BinaryFormat::CBOR;
+    switch(value.getType())
+    {
+    case ElementValue::Type::Int:
+        if(value.hasRaw() && !(value.getNumberFlags() & ElementValue::Negative)) { putUnsigned(value.getInt()); }
+        else { putSigned(static_cast<intmax_t>(value.getInt())); }
+        break;
+    case ElementValue::Type::Float:
+        putFloat(value.getFloat());
+        break;
+    case ElementValue::Type::String:
+        if(value.getString())
+        {
+            putString(value.getString(), std::strlen(value.getString()));
+            break;
+        }
+        put(cbor ? 0xF6 : 0xC0);
+        break;
+    case ElementValue::Type::Bool:
+        put(value.getBool() ? (cbor ? 0xF5 : 0xC3) : (cbor ? 0xF4 : 0xC2));
+        break;
+    default:
+        put(cbor ? 0xF6 : 0xC0); // null
+        break;
+    }
+}
+
+//
+}}
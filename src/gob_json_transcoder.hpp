@@ -0,0 +1,116 @@
+/*!
+  @file gob_json_transcoder.hpp
+  @brief Transcode the parser events to CBOR / MessagePack without DOM.
+ */
+#ifndef GOB_JSON_TRANSCODER_HPP
+#define GOB_JSON_TRANSCODER_HPP
+
+#include "gob_json_handler.hpp"
+#include "gob_json_writer.hpp" // Sink
+#include <cstdint>
+#include <cstddef>
+
+namespace goblib { namespace json {
+
+#ifndef GOB_JSON_TRANSCODER_BUFFER_LENGTH
+# pragma message "[gob_json] Transcoder buffer length as default"
+# define GOB_JSON_TRANSCODER_BUFFER_LENGTH  (512)
+#else
+# pragma message "[gob_json] Defined transcoder buffer length=" GOB_JSON_STRINGIFY(GOB_JSON_TRANSCODER_BUFFER_LENGTH)
+#endif
+
+/*! @enum BinaryFormat Binary representation of JSON */
+enum class BinaryFormat : uint8_t
+{
+    CBOR,        //!< RFC 8949
+    MessagePack, //!< MessagePack
+};
+
+/*!
+  @class TranscodeHandler
+  @brief Handler that writes the events as CBOR or MessagePack to the sink.
+  @details Output is buffered (GOB_JSON_TRANSCODER_BUFFER_LENGTH) and passed to the sink when full and at the end of each document.
+  The length of the map/array is known when it closes within the buffer, then it is written as definite length.
+  - CBOR: Containers that are flushed before closing are written as indefinite length. Any size of document can be streamed.
+  - MessagePack: Definite length only. Containers flushed before closing keep the map32/array32 header,
+    and it is overwritten with the count by Sink::patch. If the sink cannot patch, the outermost container must fit in the buffer.
+  Integers and floats use the smallest representation. (float32 if the value is exact)
+  Multiple documents are written as a sequence. (RFC 8742 for CBOR)
+  No memory allocation.
+  @code
+  FixedBufferSink sink(buf, sizeof(buf));
+  TranscodeHandler cbor(BinaryFormat::CBOR, &sink);
+  StreamingParser parser(&cbor);
+  parser.parse(json, len);
+  @endcode
+  @note Integer without raw text (not from the parser) is treated as signed.
+ */
+class TranscodeHandler : public Handler
+{
+  public:
+    /*!
+      @brief Constructor
+      @param format Output format
+      @param s Sink
+     */
+    explicit TranscodeHandler(const BinaryFormat format, Sink* s = nullptr) : _format(format), _sink(s) {}
+
+    /*! @brief Set sink */
+    void setSink(Sink* s) { _sink = s; }
+    /*! @brief Output format */
+    BinaryFormat getFormat() const { return _format; }
+    /*! @brief Reset inner state. (Unflushed output is discarded) */
+    void reset();
+    /*! @brief Pass buffered output to the sink */
+    bool flush();
+    /*! @brief Any errors? */
+    bool hasError() const { return _error; }
+    /*! @brief Total bytes output. (Including unflushed) */
+    size_t getWrittenSize() const { return _flushed + _bufferPos; }
+
+    ///@name Handler
+    ///@{
+    virtual void startDocument() override {}
+    virtual void endDocument() override;
+    virtual void startObject(const ElementPath& path) override { begin(path, true); }
+    virtual void endObject(const ElementPath& ) override { end(true); }
+    virtual void startArray(const ElementPath& path) override { begin(path, false); }
+    virtual void endArray(const ElementPath& ) override { end(false); }
+    virtual void value(const ElementPath& path, const ElementValue& value) override;
+    virtual void whitespace(const char) override {}
+    ///@}
+
+  protected:
+    bool beforeValue(const ElementPath& path);
+    void begin(const ElementPath& path, const bool object);
+    void end(const bool object);
+    void putHead(const uint8_t major, const uint64_t v);
+    void putSigned(const intmax_t v);
+    void putUnsigned(const uintmax_t v);
+    void putFloat(const double v);
+    void putString(const char* s, const size_t len);
+    bool reserve(const size_t len);
+    void put(const uint8_t* s, size_t len);
+    void put(const uint8_t b) { if(reserve(1)) { _buffer[_bufferPos++] = b; } }
+    void error(const char* estr);
+
+  private:
+    struct Container
+    {
+        size_t pos;     // Offset of the header in the whole output (In the buffer if >= _flushed)
+        uint32_t count; // Number of elements (members)
+        bool object;
+    };
+
+    BinaryFormat _format{};
+    Sink* _sink{};
+    Container _stack[GOB_JSON_PARSER_STACK_MAX_DEPTH]{};
+    int _stackPos{};
+    bool _error{};
+    uint8_t _buffer[GOB_JSON_TRANSCODER_BUFFER_LENGTH]{};
+    size_t _bufferPos{}, _flushed{};
+};
+
+//
+}}
+#endif
@@ -0,0 +1,183 @@
+/*!
+  @file gob_json_validate.cpp
+  @brief Validation only mode of StreamingParser.
+ */
+#include "gob_json.hpp"
+#include "internal/gob_json_swar.hpp"
+#include "internal/gob_json_utf8.hpp"
+#include <cstring>
+
+namespace
+{
+using namespace goblib::json;
+
+inline bool isHex(const char c)
+{
+    return static_cast<uint8_t>(c - '0') < 10 || static_cast<uint8_t>((c | 0x20) - 'a') < 6;
+}
+
+// Grammar checker. p points to the failed character when returning false.
+struct Validator
+{
+    const char* p;
+    const char* e;
+
+    // After the opening '"'
+    bool string()
+    {
+        utf8::Validator u8;
+        for(;;)
+        {
+            auto run = p;
+            p = swar::findSpecial(p, e);
+            auto bad = u8.validate(run, p);
+            if(bad != p) { p = bad; return false; }
+            if(p == e) { return false; }
+            if(!u8.complete()) { return false; } // Truncated sequence
+            switch(*p)
+            {
+            case '"': ++p; return true;
+            case '\\':
+                if(e - p < 2) { p = e; return false; }
+                switch(p[1])
+                {
+                case '"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't':
+                    p += 2;
+                    break;
+                case 'u':
+                    for(int i = 2; i < 6; ++i)
+                    {
+                        if(p + i >= e) { p = e; return false; }
+                        if(!isHex(p[i])) { p += i; return false; }
+                    }
+                    p += 6;
+                    break;
+                default: ++p; return false;
+                }
+                break;
+            default: return false; // Control character
+            }
+        }
+    }
+
+    // -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+    bool number()
+    {
+        if(*p == '-') { ++p; }
+        if(p == e) { return false; }
+        if(*p == '0') { ++p; }
+        else if(static_cast<uint8_t>(*p - '1') < 9) { p = swar::skipDigits(p + 1, e); }
+        else { return false; }
+
+        if(p < e && *p == '.')
+        {
+            auto q = swar::skipDigits(++p, e);
+            if(q == p) { return false; }
+            p = q;
+        }
+        if(p < e && (*p | 0x20) == 'e')
+        {
+            if(++p < e && (*p == '+' || *p == '-')) { ++p; }
+            auto q = swar::skipDigits(p, e);
+            if(q == p) { return false; }
+            p = q;
+        }
+        return true;
+    }
+
+    bool literal(const char* s, const size_t len)
+    {
+        if((size_t)(e - p) < len) { p = e; return false; }
+        for(size_t i = 0; i < len; ++i) { if(p[i] != s[i]) { p += i; return false; } }
+        p += len;
+        return true;
+    }
+
+    // Any value except containers
+    bool scalar()
+    {
+        switch(*p)
+        {
+        case '"': ++p; return string();
+        case 't': return literal("true", 4);
+        case 'f': return literal("false", 5);
+        case 'n': return literal("null", 4);
+        default:  return number();
+        }
+    }
+
+    bool document()
+    {
+        bool stack[GOB_JSON_PARSER_STACK_MAX_DEPTH]; // true if object
+        constexpr int maxDepth = sizeof(stack) / sizeof(stack[0]);
+        int depth{};
+        enum class Expect : uint8_t { Value, Key, After } expect = Expect::Value;
+
+        for(;;)
+        {
+            p = swar::skipWhitespace(p, e);
+            if(p == e) { return expect == Expect::After && depth == 0; }
+            switch(expect)
+            {
+            case Expect::Value:
+                if(*p == '{' || *p == '[')
+                {
+                    if(depth >= maxDepth) { return false; }
+                    const bool object = (*p++ == '{');
+                    stack[depth++] = object;
+                    p = swar::skipWhitespace(p, e);
+                    if(p < e && *p == (object ? '}' : ']'))
+                    {
+                        ++p;
+                        --depth;
+                        expect = Expect::After;
+                        break;
+                    }
+                    expect = object ? Expect::Key : Expect::Value;
+                    break;
+                }
+                // parse() takes a slot of the stack for a string as well
+                if(*p == '"' && depth >= maxDepth) { return false; }
+                if(!scalar()) { return false; }
+                expect = Expect::After;
+                break;
+            case Expect::Key:
+                if(*p != '"' || depth >= maxDepth) { return false; }
+                ++p;
+                if(!string()) { return false; }
+                p = swar::skipWhitespace(p, e);
+                if(p == e || *p != ':') { return false; }
+                ++p;
+                expect = Expect::Value;
+                break;
+            case Expect::After:
+                if(depth == 0) { return false; } // Trailing garbage
+                if(*p == ',')
+                {
+                    ++p;
+                    expect = stack[depth - 1] ? Expect::Key : Expect::Value;
+                    break;
+                }
+                if(*p != (stack[depth - 1] ? '}' : ']')) { return false; }
+                ++p;
+                --depth;
+                break;
+            }
+        }
+    }
+};
+//
+}
+
+namespace goblib { namespace json {
+
+bool StreamingParser::validate(const char* buf, const size_t len, size_t* errorPos)
+{
+    Validator v{ buf, buf + len };
+    const bool ok = buf && v.document();
+    if(errorPos) { *errorPos = ok ? len : static_cast<size_t>(v.p - buf); }
+    return ok;
+}
+
+//
+}}
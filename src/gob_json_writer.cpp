@@ -0,0 +1,288 @@
+/*!
+  @file gob_json_writer.cpp
+  @brief JSON streaming writer
+ */
+#include "gob_json_writer.hpp"
+#include "internal/gob_json_log.hpp"
+#include "internal/gob_json_swar.hpp"
+#include "internal/gob_json_number.hpp"
+#include <cmath>
+#include <algorithm>
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(ARDUINO)
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#endif
+
+namespace goblib { namespace json {
+
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(ARDUINO)
+bool FileDescriptorSink::write(const char* buf, size_t len)
+{
+    while(len)
+    {
+        auto sz = ::write(_fd, buf, len);
+        if(sz < 0)
+        {
+            if(errno == EINTR) { continue; }
+            return false;
+        }
+        buf += sz;
+        len -= sz;
+    }
+    return true;
+}
+
+bool FileDescriptorSink::canPatch() const
+{
+    const int flags = ::fcntl(_fd, F_GETFL);
+    return flags >= 0 && !(flags & O_APPEND) && ::lseek(_fd, 0, SEEK_CUR) >= 0;
+}
+
+bool FileDescriptorSink::patch(size_t back, const char* buf, size_t len)
+{
+    const off_t end = ::lseek(_fd, 0, SEEK_CUR);
+    if(end < 0 || (size_t)end < back || len > back) { return false; }
+    off_t pos = end - static_cast<off_t>(back);
+    while(len)
+    {
+        auto sz = ::pwrite(_fd, buf, len, pos);
+        if(sz < 0)
+        {
+            if(errno == EINTR) { continue; }
+            return false;
+        }
+        buf += sz;
+        len -= sz;
+        pos += sz;
+    }
+    return true;
+}
+#endif
+
+void StreamingWriter::reset()
+{
+    state = State::VALUE;
+    stackPos = 0;
+    first = true;
+    bufferPos = 0;
+    flushed = 0;
+}
+
+void StreamingWriter::error(const char* estr)
+{
+    GOB_JSON_LOGE("%s depth:%d written:%zu", estr, stackPos, getWrittenSize());
+    state = State::ERROR;
+}
+
+bool StreamingWriter::flush()
+{
+    if(bufferPos == 0) { return !hasError(); }
+    if(!sink || !sink->write(buffer, bufferPos))
+    {
+        error("Failed to write to sink");
+        bufferPos = 0;
+        return false;
+    }
+    flushed += bufferPos;
+    bufferPos = 0;
+    return !hasError();
+}
+
+void StreamingWriter::putSlow(const char* s, size_t len)
+{
+    // Fill the rest of the buffer, and flush.
+    while(len)
+    {
+        if(bufferPos == sizeof(buffer) && !flush()) { return; }
+        auto sz = std::min(len, sizeof(buffer) - bufferPos);
+        std::memcpy(buffer + bufferPos, s, sz);
+        bufferPos += sz;
+        s += sz;
+        len -= sz;
+    }
+}
+
+void StreamingWriter::putString(const char* s, const size_t len)
+{
+    static constexpr char hex[] = "0123456789abcdef";
+    const char* e = s + len;
+    put('"');
+    while(s < e)
+    {
+        // Copy as is until the character that needs escaping.
+        auto p = swar::findSpecial(s, e);
+        put(s, p - s);
+        if(p == e) { break; }
+
+        const uint8_t c = static_cast<uint8_t>(*p);
+        char esc[6] = { '\\', 0 };
+        size_t elen = 2;
+        switch(c)
+        {
+        case '"':  esc[1] = '"';  break;
+        case '\\': esc[1] = '\\'; break;
+        case '\b': esc[1] = 'b';  break;
+        case '\f': esc[1] = 'f';  break;
+        case '\n': esc[1] = 'n';  break;
+        case '\r': esc[1] = 'r';  break;
+        case '\t': esc[1] = 't';  break;
+        default:
+            esc[1] = 'u'; esc[2] = '0'; esc[3] = '0';
+            esc[4] = hex[c >> 4]; esc[5] = hex[c & 0x0F];
+            elen = 6;
+            break;
+        }
+        put(esc, elen);
+        s = p + 1;
+    }
+    put('"');
+}
+
+// Separator and state check before value/key/begin*
+bool StreamingWriter::beforeValue()
+{
+    switch(state)
+    {
+    case State::VALUE:
+        if(stackPos > 0 && stack[stackPos - 1] == Stack::ARRAY)
+        {
+            if(!first) { put(','); }
+            first = false;
+        }
+        return true;
+    case State::KEY:
+        error("Key expected in object");
+        return false;
+    case State::DONE:
+        error("Document already completed");
+        return false;
+    default: break;
+    }
+    return false;
+}
+
+void StreamingWriter::afterValue()
+{
+    setState((stackPos == 0) ? State::DONE : (stack[stackPos - 1] == Stack::OBJECT ? State::KEY : State::VALUE));
+}
+
+bool StreamingWriter::push(const char ch)
+{
+    if(!beforeValue()) { return false; }
+    if(stackPos >= (int)(sizeof(stack) / sizeof(stack[0])))
+    {
+        error("Stack overflow");
+        return false;
+    }
+    stack[stackPos++] = (ch == '{') ? Stack::OBJECT : Stack::ARRAY;
+    put(ch);
+    first = true;
+    setState((ch == '{') ? State::KEY : State::VALUE);
+    return true;
+}
+
+bool StreamingWriter::pop(const char ch)
+{
+    if(hasError()) { return false; }
+    auto expected = (ch == '}') ? Stack::OBJECT : Stack::ARRAY;
+    if(stackPos <= 0 || stack[stackPos - 1] != expected)
+    {
+        error("Unexpected end of container");
+        return false;
+    }
+    if(expected == Stack::OBJECT && state != State::KEY)
+    {
+        error("Value expected for key");
+        return false;
+    }
+    --stackPos;
+    put(ch);
+    first = false;
+    afterValue();
+    return true;
+}
+
+StreamingWriter& StreamingWriter::beginObject() { push('{'); return *this; }
+StreamingWriter& StreamingWriter::endObject()   { pop('}');  return *this; }
+StreamingWriter& StreamingWriter::beginArray()  { push('['); return *this; }
+StreamingWriter& StreamingWriter::endArray()    { pop(']');  return *this; }
+
+StreamingWriter& StreamingWriter::key(const char* s, const size_t len)
+{
+    if(state != State::KEY)
+    {
+        if(!hasError()) { error("Key is only allowed in object"); }
+        return *this;
+    }
+    if(!s)
+    {
+        error("Key must not be null");
+        return *this;
+    }
+    if(!first) { put(','); }
+    first = false;
+    putString(s, len);
+    put(':');
+    setState(State::VALUE);
+    return *this;
+}
+
+StreamingWriter& StreamingWriter::value(std::nullptr_t)
+{
+    return rawValue("null", 4);
+}
+
+StreamingWriter& StreamingWriter::value(const bool b)
+{
+    return b ? rawValue("true", 4) : rawValue("false", 5);
+}
+
+StreamingWriter& StreamingWriter::value(const char* s, const size_t len)
+{
+    if(beforeValue())
+    {
+        putString(s, len);
+        afterValue();
+    }
+    return *this;
+}
+
+StreamingWriter& StreamingWriter::valueSigned(const intmax_t v)
+{
+    char tmp[number::FORMAT_MAX_LENGTH];
+    return rawValue(tmp, number::formatSigned(tmp, v));
+}
+
+StreamingWriter& StreamingWriter::valueUnsigned(const uintmax_t v)
+{
+    char tmp[number::FORMAT_MAX_LENGTH];
+    return rawValue(tmp, number::formatUnsigned(tmp, v));
+}
+
+StreamingWriter& StreamingWriter::value(const float v)
+{
+    if(!std::isfinite(v)) { return value(nullptr); }
+    char tmp[number::FORMAT_MAX_LENGTH];
+    return rawValue(tmp, number::formatFloat(tmp, v));
+}
+
+StreamingWriter& StreamingWriter::value(const double v)
+{
+    if(!std::isfinite(v)) { return value(nullptr); }
+    char tmp[number::FORMAT_MAX_LENGTH];
+    return rawValue(tmp, number::formatFloat(tmp, v));
+}
+
+StreamingWriter& StreamingWriter::rawValue(const char* s, const size_t len)
+{
+    if(beforeValue())
+    {
+        put(s, len);
+        afterValue();
+    }
+    return *this;
+}
+
+//
+}}
@@ -0,0 +1,254 @@
+/*!
+  @file gob_json_writer.hpp
+  @brief JSON streaming writer
+ */
+#ifndef GOB_JSON_WRITER_HPP
+#define GOB_JSON_WRITER_HPP
+
+#include "gob_json_typedef.hpp"
+#include "gob_json_element_path.hpp" // GOB_JSON_PARSER_STACK_MAX_DEPTH
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+namespace goblib { namespace json {
+
+#ifndef GOB_JSON_WRITER_BUFFER_LENGTH
+# pragma message "[gob_json] Writer buffer length as default"
+# define GOB_JSON_WRITER_BUFFER_LENGTH  (128)
+#else
+# pragma message "[gob_json] Defined writer buffer length=" GOB_JSON_STRINGIFY(GOB_JSON_WRITER_BUFFER_LENGTH)
+#endif
+
+/*!
+  @class Sink
+  @brief Abstract interface class.
+  @brief Destination of the output.
+ */
+class Sink
+{
+  public:
+    virtual ~Sink(){}
+    /*!
+      @brief Write bytes
+      @return True if all bytes written
+     */
+    virtual bool write(const char* buf, size_t len) = 0;
+
+    /*! @brief Can the output already written be overwritten? (patch) */
+    virtual bool canPatch() const { return false; }
+    /*!
+      @brief Overwrite bytes already written
+      @param back Distance from the end of the output to the first byte to overwrite
+      @param buf Bytes
+      @param len Length (Must be less than or equal to back)
+      @return True if overwritten. False if not supported or out of range
+     */
+    virtual bool patch(size_t back, const char* buf, size_t len) { (void)back; (void)buf; (void)len; return false; }
+};
+
+/*!
+  @class FixedBufferSink
+  @brief Output to fixed size memory.
+  @note Output is null-terminated if there is room.
+ */
+class FixedBufferSink : public Sink
+{
+  public:
+    FixedBufferSink(char* buf, size_t capacity) : _buf(buf), _capacity(capacity) { clear(); }
+
+    virtual bool write(const char* buf, size_t len) override
+    {
+        if(len > _capacity - _size) { return false; }
+        std::memcpy(_buf + _size, buf, len);
+        _size += len;
+        if(_size < _capacity) { _buf[_size] = '\0'; }
+        return true;
+    }
+    virtual bool canPatch() const override { return true; }
+    virtual bool patch(size_t back, const char* buf, size_t len) override
+    {
+        if(back > _size || len > back) { return false; }
+        std::memcpy(_buf + _size - back, buf, len);
+        return true;
+    }
+
+    const char* data() const { return _buf; } //!< @brief Gets the output
+    size_t size() const { return _size; }     //!< @brief Gets the output length
+    void clear() { _size = 0; if(_capacity) { _buf[0] = '\0'; } } //!< @brief Discard the output
+
+  private:
+    char* _buf{};
+    size_t _capacity{}, _size{};
+};
+
+/*!
+  @class CallbackSink
+  @brief Output by user function.
+ */
+class CallbackSink : public Sink
+{
+  public:
+    /*! @brief Callback function type. Return true if succeeded */
+    using function_t = bool(*)(const char* buf, size_t len, void* arg);
+
+    explicit CallbackSink(function_t func, void* arg = nullptr) : _func(func), _arg(arg) {}
+    virtual bool write(const char* buf, size_t len) override { return _func && _func(buf, len, _arg); }
+
+  private:
+    function_t _func{};
+    void* _arg{};
+};
+
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(ARDUINO)
+/*!
+  @class FileDescriptorSink
+  @brief Output to file descriptor. (Native only)
+ */
+class FileDescriptorSink : public Sink
+{
+  public:
+    explicit FileDescriptorSink(int fd) : _fd(fd) {}
+    virtual bool write(const char* buf, size_t len) override;
+    /*! @brief Seekable and not O_APPEND (regular file) */
+    virtual bool canPatch() const override;
+    virtual bool patch(size_t back, const char* buf, size_t len) override;
+
+  private:
+    int _fd{-1};
+};
+#endif
+
+/*!
+  @class StreamingWriter
+  @brief JSON streaming writer
+  @details Writes JSON to the fixed length buffer, and passes it to the sink when full.
+  No memory allocation.
+  @code
+  writer.beginObject().key("temp").value(23.5f).key("tags").beginArray().value("a").endArray().endObject();
+  writer.flush();
+  @endcode
+  @note Nesting level is limited to GOB_JSON_PARSER_STACK_MAX_DEPTH.
+  @note Non-finite floating-point values are written as null.
+ */
+class StreamingWriter
+{
+  public:
+    /*!
+      @brief Constructor
+      @param sink Sink
+     */
+    explicit StreamingWriter(Sink* s = nullptr) { setSink(s); }
+
+    /*! @brief Set sink */
+    void setSink(Sink* s) { sink = s; }
+    /*! @brief Reset inner state. (Unflushed output is discarded) */
+    void reset();
+    /*! @brief Pass buffered output to the sink */
+    bool flush();
+
+    ///@name Structure
+    ///@{
+    StreamingWriter& beginObject(); //!< @brief Begin JSON object
+    StreamingWriter& endObject();   //!< @brief End JSON object
+    StreamingWriter& beginArray();  //!< @brief Begin JSON array
+    StreamingWriter& endArray();    //!< @brief End JSON array
+    /*! @brief Key of the member */
+    StreamingWriter& key(const char* s) { return key(s, s ? std::strlen(s) : 0); }
+    StreamingWriter& key(const char* s, const size_t len);
+    ///@}
+
+    ///@name Value
+    ///@{
+    /*! @brief null */
+    StreamingWriter& value(std::nullptr_t);
+    /*! @brief Boolean */
+    StreamingWriter& value(const bool b);
+    /*! @brief String (nullptr is written as null) */
+    StreamingWriter& value(const char* s) { return s ? value(s, std::strlen(s)) : value(nullptr); }
+    StreamingWriter& value(const char* s, const size_t len);
+    StreamingWriter& value(const string_t& s) { return value(s.c_str(), s.length()); }
+    /*! @brief Integer */
+    template<typename T,
+             typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value &&
+                                     std::is_signed<T>::value, std::nullptr_t>::type = nullptr>
+    StreamingWriter& value(const T v) { return valueSigned(v); }
+    template<typename T,
+             typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value &&
+                                     std::is_unsigned<T>::value, std::nullptr_t>::type = nullptr>
+    StreamingWriter& value(const T v) { return valueUnsigned(v); }
+    /*! @brief Floating-point */
+    StreamingWriter& value(const float v);
+    StreamingWriter& value(const double v);
+    StreamingWriter& value(const long double v) { return value(static_cast<double>(v)); }
+    /*!
+      @brief Already formatted value (number etc.)
+      @warning Not validated.
+     */
+    StreamingWriter& rawValue(const char* s, const size_t len);
+    ///@}
+
+    /*! @brief Any errors? */
+    bool hasError() const { return state == State::ERROR; }
+    /*! @brief Current nesting level */
+    int getDepth() const { return stackPos; }
+    /*! @brief Whole document written? */
+    bool isComplete() const { return state == State::DONE; }
+    /*! @brief Total bytes output. (Including unflushed) */
+    size_t getWrittenSize() const { return flushed + bufferPos; }
+
+  protected:
+    StreamingWriter& valueSigned(const intmax_t v);
+    StreamingWriter& valueUnsigned(const uintmax_t v);
+    bool beforeValue();
+    void afterValue();
+    bool push(const char ch);
+    bool pop(const char ch);
+    void error(const char* estr);
+
+    void put(const char* s, size_t len)
+    {
+        if(len <= sizeof(buffer) - bufferPos)
+        {
+            std::memcpy(buffer + bufferPos, s, len);
+            bufferPos += len;
+            return;
+        }
+        putSlow(s, len);
+    }
+    void put(const char ch)
+    {
+        if(bufferPos >= sizeof(buffer) && !flush()) { return; }
+        buffer[bufferPos++] = ch;
+    }
+    void putSlow(const char* s, size_t len);
+    void putString(const char* s, const size_t len);
+
+    enum class State : int8_t
+    {
+        ERROR = -1,
+        DONE,
+        VALUE, // Value expected
+        KEY,   // Key expected (in object)
+    };
+    enum class Stack : uint8_t
+    {
+        OBJECT,
+        ARRAY,
+    };
+    void setState(const State s) { if(!hasError()) { state = s; } } // Keep error state
+
+    Sink* sink{nullptr};
+    State state{State::VALUE};
+    Stack stack[GOB_JSON_PARSER_STACK_MAX_DEPTH]{};
+    int stackPos{0};
+    bool first{true}; // No elements in the current container yet?
+
+    char buffer[GOB_JSON_WRITER_BUFFER_LENGTH]{};
+    size_t bufferPos{0};
+    size_t flushed{0};
+};
+//
+}}
+#endif
@@ -0,0 +1,162 @@
+/*!
+  @file gob_json_number.hpp
+  @brief Number <=> text conversion without printf family.
+*/
+#ifndef GOB_JSON_NUMBER_HPP
+#define GOB_JSON_NUMBER_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#if __cplusplus >= 201703L && defined(__has_include)
+# if __has_include(<charconv>)
+#   include <charconv>
+# endif
+#endif
+
+namespace goblib { namespace json { namespace number {
+
+/*!
+  @brief Maximum length of formatted number.
+  @note "-1.7976931348623157e+308" and "-9223372036854775808" fit.
+ */
+constexpr size_t FORMAT_MAX_LENGTH = 32;
+
+/*!
+  @brief Format unsigned integer.
+  @param out Output buffer (Need 20 characters at least)
+  @return Length of written (Not null-terminated)
+ */
+inline size_t formatUnsigned(char* out, uintmax_t v)
+{
+    static constexpr char digits[] =
+            "00010203040506070809" "10111213141516171819" "20212223242526272829" "30313233343536373839" "40414243444546474849"
+            "50515253545556575859" "60616263646566676869" "70717273747576777879" "80818283848586878889" "90919293949596979899";
+    char tmp[24];
+    char* p = tmp + sizeof(tmp);
+    while(v >= 100)
+    {
+        auto idx = (v % 100) * 2;
+        v /= 100;
+        *--p = digits[idx + 1];
+        *--p = digits[idx];
+    }
+    if(v >= 10)
+    {
+        *--p = digits[v * 2 + 1];
+        *--p = digits[v * 2];
+    }
+    else { *--p = static_cast<char>('0' + v); }
+
+    size_t len = tmp + sizeof(tmp) - p;
+    std::memcpy(out, p, len);
+    return len;
+}
+
+/*! @brief Format signed integer. @return Length of written */
+inline size_t formatSigned(char* out, intmax_t v)
+{
+    if(v >= 0) { return formatUnsigned(out, static_cast<uintmax_t>(v)); }
+    *out = '-';
+    return 1 + formatUnsigned(out + 1, ~static_cast<uintmax_t>(v) + 1);
+}
+
+/*!
+  @brief Format floating-point as shortest text that round-trips.
+  @param out Output buffer (Need FORMAT_MAX_LENGTH characters)
+  @return Length of written
+  @warning v must be finite.
+  @note Using std::to_chars if available.
+  @note Otherwise the fewest digits of %.Ng in 15...17 (float:6...9) that round-trips.
+  If %.15g round-trips, it is already the shortest since trailing zeros are removed.
+ */
+template<typename T> inline size_t formatFloat(char* out, const T v)
+{
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    return std::to_chars(out, out + FORMAT_MAX_LENGTH, v).ptr - out;
+#else
+    constexpr int minDigits = sizeof(T) == sizeof(float) ? 6 : 15;
+    constexpr int maxDigits = sizeof(T) == sizeof(float) ? 9 : 17;
+    int len{};
+    for(int prec = minDigits; prec <= maxDigits; ++prec)
+    {
+        len = snprintf(out, FORMAT_MAX_LENGTH, "%.*g", prec, static_cast<double>(v));
+        if(static_cast<T>(std::strtod(out, nullptr)) == v) { break; }
+    }
+    return static_cast<size_t>(len);
+#endif
+}
+
+/*!
+  @brief Parse integer text directly into T.
+  @param s Text (Leading whitespace and sign are allowed, stops at the first non-digit)
+  @param[out] out Result. Clamped to the range of T if out of range
+  @return False if no digits or out of range
+ */
+template<typename T> inline bool parseIntegral(const char* s, T& out)
+{
+    static_assert(std::is_integral<T>::value, "T must be integral");
+    using limits = std::numeric_limits<T>;
+
+    while(*s == ' ' || *s == '\t' || *s == '\n' || *s == '\r') { ++s; }
+    const bool neg = (*s == '-');
+    if(neg || *s == '+') { ++s; }
+
+    uintmax_t v{};
+    bool overflow{}, digits{};
+    for(; *s >= '0' && *s <= '9'; ++s)
+    {
+        const unsigned d = *s - '0';
+        digits = true;
+        if(v > (UINTMAX_MAX - d) / 10) { overflow = true; continue; }
+        v = v * 10 + d;
+    }
+    if(!digits) { out = 0; return false; }
+
+    if(neg)
+    {
+        // Magnitude of min() as unsigned. (0 if unsigned)
+        const uintmax_t mag = limits::is_signed ? static_cast<uintmax_t>(-(limits::min() + 1)) + 1 : 0;
+        if(overflow || v > mag) { out = limits::min(); return false; }
+        out = static_cast<T>(~v + 1); // Two's complement
+        return true;
+    }
+    if(overflow || v > static_cast<uintmax_t>(limits::max())) { out = limits::max(); return false; }
+    out = static_cast<T>(v);
+    return true;
+}
+
+/*!
+  @brief Convert floating-point to T, truncated toward zero.
+  @param v Value
+  @param[out] out Result. Clamped to the range of T if out of range, 0 if NaN
+  @return False if out of range or NaN
+ */
+template<typename T> inline bool floatToIntegral(const double v, T& out)
+{
+    static_assert(std::is_integral<T>::value, "T must be integral");
+    using limits = std::numeric_limits<T>;
+
+    if(std::isnan(v)) { out = 0; return false; }
+    const double t = std::trunc(v);
+    const double upper = std::ldexp(1.0, limits::digits); // max() + 1
+    if(t >= upper) { out = limits::max(); return false; }
+    if(t < (limits::is_signed ? -upper : 0.0)) { out = limits::min(); return false; }
+    out = static_cast<T>(t);
+    return true;
+}
+
+/*! @brief Parse floating-point text */
+template<typename T> inline T parseFloat(const char* s)
+{
+    return static_cast<T>(std::strtod(s, nullptr));
+}
+
+//
+}}}
+#endif
@@ -0,0 +1,55 @@
+/*!
+  @file gob_json_stats.hpp
+  @brief Tick counter for statistics.
+*/
+#ifndef GOB_JSON_INTERNAL_STATS_HPP
+#define GOB_JSON_INTERNAL_STATS_HPP
+
+#include <cstdint>
+#if defined(__x86_64__) || defined(__i386__)
+# include <x86intrin.h>
+#elif !defined(__XTENSA__) && !defined(__aarch64__)
+# include <chrono>
+#endif
+
+namespace goblib { namespace json { namespace stats {
+
+/*! @brief Tick as the counter width. (CCOUNT of Xtensa is 32 bits and wraps in seconds) */
+#if defined(__XTENSA__)
+using tick_t = uint32_t;
+#else
+using tick_t = uint64_t;
+#endif
+
+/*!
+  @brief Current tick
+  @note x86:TSC, aarch64:Virtual counter, Xtensa(ESP32):CCOUNT, others:steady_clock nanoseconds
+  @warning Use elapsed() for the difference, it is correct across a wrap.
+ */
+inline tick_t ticks()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t v;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(v));
+    return v;
+#elif defined(__XTENSA__)
+    uint32_t v;
+    asm volatile("rsr %0, ccount" : "=a"(v));
+    return v;
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+/*! @brief Ticks from \a from to \a to, taken modulo the counter width */
+inline uint64_t elapsed(const tick_t from, const tick_t to)
+{
+    return static_cast<tick_t>(to - from);
+}
+
+//
+}}}
+#endif
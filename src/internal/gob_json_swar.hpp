@@ -0,0 +1,88 @@
+/*!
+  @file gob_json_swar.hpp
+  @brief SIMD within a register helpers.
+
+  @note Scans a machine word at a time using plain integer arithmetic.
+  @note Works on any target (No SSE/NEON needed), ESP32 uses 32bit words.
+*/
+#ifndef GOB_JSON_SWAR_HPP
+#define GOB_JSON_SWAR_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+namespace goblib { namespace json { namespace swar {
+
+using word_t = uintptr_t;
+
+constexpr word_t ones  = ~static_cast<word_t>(0) / 255;  // 0x0101...
+constexpr word_t highs = ones * 0x80;                    // 0x8080...
+
+/*! @brief Load word from unaligned address */
+inline word_t load(const char* p)
+{
+    word_t w;
+    std::memcpy(&w, p, sizeof(w));
+    return w;
+}
+
+/*! @brief Nonzero if any byte is zero */
+constexpr word_t hasZero(const word_t w) { return (w - ones) & ~w & highs; }
+/*! @brief Nonzero if any byte equals to b */
+constexpr word_t hasByte(const word_t w, const uint8_t b) { return hasZero(w ^ (ones * b)); }
+/*! @brief Nonzero if any byte is less than n (n <= 128) */
+constexpr word_t hasLess(const word_t w, const uint8_t n) { return (w - ones * n) & ~w & highs; }
+
+/*!
+  @brief Find the first character that cannot be copied as is in JSON string.
+  @return Pointer to '"', '\\' or control character. e if not found.
+  @tparam DEL Also stop at 0x7F?
+ */
+template<bool DEL = false> inline const char* findSpecial(const char* p, const char* e)
+{
+    while(e - p >= (ptrdiff_t)sizeof(word_t))
+    {
+        auto w = load(p);
+        if(hasByte(w, '"') | hasByte(w, '\\') | hasLess(w, 0x20) | (DEL ? hasByte(w, 0x7F) : 0)) { break; }
+        p += sizeof(word_t);
+    }
+    while(p < e)
+    {
+        auto c = static_cast<uint8_t>(*p);
+        if(c == '"' || c == '\\' || c < 0x20 || (DEL && c == 0x7F)) { break; }
+        ++p;
+    }
+    return p;
+}
+
+/*! @brief All bytes are '0'-'9'? */
+constexpr bool allDigits(const word_t w)
+{
+    return ((w & (ones * 0xF0)) | (((w + ones * 0x06) & (ones * 0xF0)) >> 4)) == ones * 0x33;
+}
+
+/*! @brief Find the first character that is not '0'-'9' */
+inline const char* skipDigits(const char* p, const char* e)
+{
+    while(e - p >= (ptrdiff_t)sizeof(word_t) && allDigits(load(p))) { p += sizeof(word_t); }
+    while(p < e && static_cast<uint8_t>(*p - '0') < 10) { ++p; }
+    return p;
+}
+
+/*! @brief Find the first character that is not JSON whitespace (Runs of spaces are skipped a word at a time) */
+inline const char* skipWhitespace(const char* p, const char* e)
+{
+    while(p < e)
+    {
+        if(e - p >= (ptrdiff_t)sizeof(word_t) && load(p) == ones * ' ') { p += sizeof(word_t); continue; }
+        const char c = *p;
+        if(c != ' ' && c != '\n' && c != '\r' && c != '\t') { break; }
+        ++p;
+    }
+    return p;
+}
+
+//
+}}}
+#endif
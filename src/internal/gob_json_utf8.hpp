@@ -0,0 +1,96 @@
+/*!
+  @file gob_json_utf8.hpp
+  @brief UTF-8 validation.
+
+  @note Small DFA for a byte at a time, and ASCII runs are skipped a word at a time. (SWAR)
+  @note Rejects overlong forms, surrogates (U+D800-DFFF) and code points over U+10FFFF. (RFC 3629)
+*/
+#ifndef GOB_JSON_UTF8_HPP
+#define GOB_JSON_UTF8_HPP
+
+#include "gob_json_swar.hpp"
+#include <cstdint>
+#include <cstddef>
+
+namespace goblib { namespace json { namespace utf8 {
+
+/*!
+  @class Validator
+  @brief Incremental UTF-8 validator. The state is kept between the calls.
+ */
+class Validator
+{
+  public:
+    /*! @brief Discard the sequence in progress */
+    void reset() { _need = 0; }
+    /*! @brief Not in the middle of a sequence? */
+    bool complete() const { return _need == 0; }
+
+    /*! @brief Feed a byte. False if invalid */
+    bool step(const uint8_t c)
+    {
+        if(_need)
+        {
+            if(c < _lo || c > _hi) { return false; }
+            --_need;
+            _lo = 0x80;
+            _hi = 0xBF;
+            return true;
+        }
+        if(c < 0x80) { return true; }
+        _lo = 0x80;
+        _hi = 0xBF;
+        if(c < 0xC2) { return false; } // Continuation or overlong
+        if(c < 0xE0) { _need = 1; return true; }
+        if(c < 0xF0)
+        {
+            _need = 2;
+            if(c == 0xE0)      { _lo = 0xA0; } // Overlong
+            else if(c == 0xED) { _hi = 0x9F; } // Surrogates
+            return true;
+        }
+        if(c < 0xF5)
+        {
+            _need = 3;
+            if(c == 0xF0)      { _lo = 0x90; } // Overlong
+            else if(c == 0xF4) { _hi = 0x8F; } // Over U+10FFFF
+            return true;
+        }
+        return false;
+    }
+
+    /*!
+      @brief Feed bytes
+      @return Pointer to the first invalid byte, e if all valid
+     */
+    const char* validate(const char* p, const char* e)
+    {
+        for(;;)
+        {
+            // Skip ASCII a word at a time
+            if(!_need)
+            {
+                while(e - p >= (ptrdiff_t)sizeof(swar::word_t) && !(swar::load(p) & swar::highs)) { p += sizeof(swar::word_t); }
+                while(p < e && static_cast<uint8_t>(*p) < 0x80) { ++p; }
+            }
+            if(p == e) { return e; }
+            if(!step(static_cast<uint8_t>(*p))) { return p; }
+            ++p;
+        }
+    }
+
+  private:
+    uint8_t _need{}; // Continuation bytes left
+    uint8_t _lo{0x80}, _hi{0xBF}; // Range of the next continuation byte
+};
+
+/*! @brief Is the whole text valid UTF-8? */
+inline bool isValid(const char* s, const size_t len)
+{
+    Validator v;
+    return v.validate(s, s + len) == s + len && v.complete();
+}
+
+//
+}}}
+#endif
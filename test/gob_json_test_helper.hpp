@@ -0,0 +1,89 @@
+/*
+  Helpers shared by the tests.
+ */
+#ifndef GOB_JSON_TEST_HELPER_HPP
+#define GOB_JSON_TEST_HELPER_HPP
+
+#include <gob_json_handler.hpp>
+#include <gob_json_element_path.hpp>
+#include <gob_json_element_value.hpp>
+#include <gob_json_writer.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cinttypes>
+#include <string>
+#include <vector>
+
+namespace gob_json_test {
+
+// Events as text ("SD", "SO path", "V path=value" ...)
+struct LogHandler : public goblib::json::Handler
+{
+    // How values are written
+    enum class Value : uint8_t
+    {
+        Text,     // ElementValue::toString
+        Typed,    // Type prefix and converted value (i/f/s, true/false/null)
+        TypedRaw, // Typed and the raw text of the number
+    };
+    explicit LogHandler(const Value v = Value::Text) : format(v) {}
+
+    virtual void startDocument() override { log.push_back("SD"); }
+    virtual void endDocument() override { log.push_back("ED"); }
+    virtual void startObject(const goblib::json::ElementPath& path) override { log.push_back("SO " + path.toString()); }
+    virtual void endObject(const goblib::json::ElementPath& path) override { log.push_back("EO " + path.toString()); }
+    virtual void startArray(const goblib::json::ElementPath& path) override { log.push_back("SA " + path.toString()); }
+    virtual void endArray(const goblib::json::ElementPath& path) override { log.push_back("EA " + path.toString()); }
+    virtual void whitespace(const char ch) override { ws += ch; }
+    virtual void value(const goblib::json::ElementPath& path, const goblib::json::ElementValue& v) override
+    {
+        using goblib::json::ElementValue;
+        std::string s = "V " + path.toString() + "=";
+        if(format == Value::Text) { log.push_back(s + v.toString()); return; }
+
+        char buf[64];
+        switch(v.getType())
+        {
+        case ElementValue::Type::Int:    snprintf(buf, sizeof(buf), "i%jd", (intmax_t)v.getInt()); s += buf; break;
+        case ElementValue::Type::Float:  snprintf(buf, sizeof(buf), "f%g", v.getFloat()); s += buf; break;
+        case ElementValue::Type::String: s += std::string("s") + v.getString(); break;
+        case ElementValue::Type::Bool:   s += v.getBool() ? "true" : "false"; break;
+        default:                         s += "null"; break;
+        }
+        if(format == Value::TypedRaw && v.hasRaw()) { s += std::string(" raw:") + v.getRaw(); }
+        log.push_back(s);
+    }
+
+    Value format{};
+    std::vector<std::string> log;
+    std::string ws; // Whitespace passed
+};
+
+// Parse by the chunk, 0 means a character at a time
+template<class P> void feed(P& parser, const std::string& s, const size_t chunk)
+{
+    if(chunk == 0) { for(auto c : s) { parser.parse(c); } return; }
+    for(size_t i = 0; i < s.size(); i += chunk) { parser.parse(s.data() + i, std::min(chunk, s.size() - i)); }
+}
+
+// Sink into a byte vector (supports patch)
+struct VectorSink : public goblib::json::Sink
+{
+    virtual bool write(const char* buf, size_t len) override
+    {
+        out.insert(out.end(), reinterpret_cast<const uint8_t*>(buf), reinterpret_cast<const uint8_t*>(buf) + len);
+        return true;
+    }
+    virtual bool canPatch() const override { return true; }
+    virtual bool patch(size_t back, const char* buf, size_t len) override
+    {
+        if(back > out.size() || len > back) { return false; }
+        std::copy(buf, buf + len, out.end() - back);
+        return true;
+    }
+    std::vector<uint8_t> out;
+};
+
+//
+}
+#endif
@@ -0,0 +1,448 @@
+#include <gtest/gtest.h>
+
+#include <gob_json.hpp>
+#include <gob_json_element.hpp>
+#include <gob_json_delegate_handler.hpp>
+#include <gob_json_writer.hpp>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+/*
+  Heap allocation tracking.
+  glibc: malloc/calloc/realloc are interposed, so that C and C++ allocations are counted.
+  Others (or sanitizers): operator new/delete (and the aligned ones) are replaced.
+  Only the allocations on the thread in Tracker scope are counted.
+ */
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__) && !defined(__SANITIZE_THREAD__)
+# if defined(__has_feature)
+#   if __has_feature(address_sanitizer) || __has_feature(thread_sanitizer) || __has_feature(memory_sanitizer)
+#     define TEST_ALLOC_MALLOC 0
+#   endif
+# endif
+# ifndef TEST_ALLOC_MALLOC
+#   define TEST_ALLOC_MALLOC 1
+# endif
+#else
+# define TEST_ALLOC_MALLOC 0
+#endif
+
+namespace
+{
+thread_local bool tracking{};
+thread_local size_t allocations{};
+inline void countAllocation() { if(tracking) { ++allocations; } }
+
+// Counts allocations while alive.
+struct Tracker
+{
+    Tracker() { allocations = 0; tracking = true; }
+    ~Tracker() { tracking = false; }
+    size_t count() const { return allocations; }
+};
+//
+}
+
+#if TEST_ALLOC_MALLOC
+extern "C"
+{
+void* __libc_malloc(size_t);
+void* __libc_calloc(size_t, size_t);
+void* __libc_realloc(void*, size_t);
+void* __libc_memalign(size_t, size_t);
+void* malloc(size_t sz) __THROW { countAllocation(); return __libc_malloc(sz); }
+void* calloc(size_t n, size_t sz) __THROW { countAllocation(); return __libc_calloc(n, sz); }
+void* realloc(void* p, size_t sz) __THROW { countAllocation(); return __libc_realloc(p, sz); }
+// Over-aligned (aligned operator new uses aligned_alloc)
+void* memalign(size_t al, size_t sz) __THROW { countAllocation(); return __libc_memalign(al, sz); }
+void* aligned_alloc(size_t al, size_t sz) __THROW { countAllocation(); return __libc_memalign(al, sz); }
+int posix_memalign(void** pp, size_t al, size_t sz) __THROW
+{
+    if(al < sizeof(void*) || (al & (al - 1))) { return EINVAL; }
+    countAllocation();
+    *pp = __libc_memalign(al, sz);
+    return *pp ? 0 : ENOMEM;
+}
+}
+#else
+// The heap behind operator new/delete. (Out of line, so that the compiler does not pair new with free)
+namespace
+{
+__attribute__((noinline)) void* allocate(const size_t sz, const size_t al)
+{
+    countAllocation();
+    void* p{};
+    if(al <= alignof(std::max_align_t)) { return std::malloc(sz ? sz : 1); }
+    return posix_memalign(&p, al, sz ? sz : 1) == 0 ? p : nullptr;
+}
+__attribute__((noinline)) void release(void* p) { std::free(p); }
+//
+}
+
+// Each delete forwards to the one that pairs with the allocation.
+void* operator new(size_t sz)
+{
+    if(void* p = allocate(sz, 0)) { return p; }
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { release(p); }
+void* operator new[](size_t sz) { return operator new(sz); }
+void* operator new(size_t sz, const std::nothrow_t&) noexcept { try { return operator new(sz); } catch(...) { return nullptr; } }
+void* operator new[](size_t sz, const std::nothrow_t&) noexcept { return operator new(sz, std::nothrow); }
+void operator delete[](void* p) noexcept { operator delete(p); }
+void operator delete(void* p, size_t) noexcept { operator delete(p); }
+void operator delete[](void* p, size_t) noexcept { operator delete(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { operator delete(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { operator delete(p); }
+
+# if defined(__cpp_aligned_new)
+void* operator new(size_t sz, std::align_val_t al)
+{
+    if(void* p = allocate(sz, static_cast<size_t>(al))) { return p; }
+    throw std::bad_alloc();
+}
+void operator delete(void* p, std::align_val_t) noexcept { release(p); }
+void* operator new[](size_t sz, std::align_val_t al) { return operator new(sz, al); }
+void* operator new(size_t sz, std::align_val_t al, const std::nothrow_t&) noexcept
+{
+    try { return operator new(sz, al); } catch(...) { return nullptr; }
+}
+void* operator new[](size_t sz, std::align_val_t al, const std::nothrow_t&) noexcept { return operator new(sz, al, std::nothrow); }
+void operator delete[](void* p, std::align_val_t al) noexcept { operator delete(p, al); }
+void operator delete(void* p, size_t, std::align_val_t al) noexcept { operator delete(p, al); }
+void operator delete[](void* p, size_t, std::align_val_t al) noexcept { operator delete(p, al); }
+void operator delete(void* p, std::align_val_t al, const std::nothrow_t&) noexcept { operator delete(p, al); }
+void operator delete[](void* p, std::align_val_t al, const std::nothrow_t&) noexcept { operator delete(p, al); }
+# endif
+#endif
+
+using goblib::json::ElementPath;
+using goblib::json::ElementValue;
+using goblib::json::Element;
+using goblib::json::ElementBase;
+
+// TEST(Alloc, RawParser)
+namespace
+{
+constexpr int RECORDS = 50;
+
+// Records with all kinds of tokens.
+std::string makeAllocJson()
+{
+    std::string s(R"({"records":[)");
+    char buf[256];
+    for(int i = 0; i < RECORDS; ++i)
+    {
+        snprintf(buf, sizeof(buf),
+                 R"(%s{"id":%d,"name":"item name over the small string buffer é\n%d","price":%d.25e-1,"tags":["a","b"],)"
+                 R"("active":%s,"none":null,"pos":{"x":-%d,"y":[1,2,3]}})",
+                 i ? "," : "", i, i, i, (i & 1) ? "true" : "false", i);
+        s += buf;
+    }
+    s += "]}";
+    return s;
+}
+
+// Touches the path and the value without copies.
+struct TouchHandler : public goblib::json::Handler
+{
+    virtual void startDocument() override { ++events; }
+    virtual void endDocument() override { ++events; }
+    virtual void startObject(const ElementPath& path) override { ++events; depth += path.getCount(); }
+    virtual void endObject(const ElementPath& ) override { ++events; }
+    virtual void startArray(const ElementPath& ) override { ++events; }
+    virtual void endArray(const ElementPath& ) override { ++events; }
+    virtual void whitespace(const char) override {}
+    virtual void value(const ElementPath& path, const ElementValue& v) override
+    {
+        ++events;
+        if(path.match("records[*].pos.y[*]")) { sum += v.getInt(); }
+        if(v.isFloat()) { fsum += v.getFloat(); }
+        if(v.isString()) { chars += strlen(v.getString()); }
+        if(path.getKey()[0] == 'i' && path.getIndex() < 0) { sum += v.getInt(); }
+    }
+    int events{}, depth{}, chars{};
+    int64_t sum{};
+    double fsum{};
+};
+
+volatile void* escape{};
+//
+}
+
+TEST(Alloc, RawParser)
+{
+    // The tracker works?
+    {
+        Tracker t;
+        auto p = new char[64];
+        escape = p;
+        delete[] p;
+        EXPECT_GE(t.count(), 1U);
+    }
+    // Over-aligned allocations are counted as well
+#if TEST_ALLOC_MALLOC
+    {
+        Tracker t;
+        void* p{};
+        ASSERT_EQ(posix_memalign(&p, 64, 64), 0);
+        escape = p;
+        std::free(p);
+        EXPECT_GE(t.count(), 1U);
+    }
+#endif
+#if defined(__cpp_aligned_new)
+    {
+        struct alignas(64) Aligned { char c[64]; };
+        Tracker t;
+        auto p = new Aligned;
+        escape = p;
+        delete p;
+        EXPECT_GE(t.count(), 1U);
+    }
+#endif
+
+    const std::string json = makeAllocJson();
+    TouchHandler handler;
+    goblib::json::StreamingParser parser(&handler);
+    {
+        Tracker t;
+        parser.parse(json.data(), json.size());
+        EXPECT_EQ(t.count(), 0U);
+    }
+    EXPECT_FALSE(parser.hasError());
+    EXPECT_EQ(handler.sum, RECORDS * 6 + RECORDS * (RECORDS - 1) / 2);
+
+    // Byte by byte, multiple documents
+    parser.reset();
+    parser.setRecursively(true);
+    handler = TouchHandler{};
+    {
+        Tracker t;
+        for(int i = 0; i < 2; ++i) { for(auto c : json) { parser.parse(c); } }
+        EXPECT_EQ(t.count(), 0U);
+    }
+    EXPECT_FALSE(parser.hasError());
+    EXPECT_EQ(handler.sum, 2 * (RECORDS * 6 + RECORDS * (RECORDS - 1) / 2));
+}
+
+// TEST(Alloc, Binding)
+namespace
+{
+struct Record
+{
+    int id{};
+    char name[16]{};
+    float price{};
+    char tags[2][4]{};
+    bool active{};
+};
+
+// Element table with fixed storages.
+struct FixedHandler : public TouchHandler
+{
+    virtual void value(const ElementPath& path, const ElementValue& value) override
+    {
+        if(path.getCount() < 3) { return; }
+        auto& r = records[path.getIndex(1) % 4]; // records[n]...
+        Element<decltype(r.id)>     e_id     { "id",     &r.id };
+        Element<decltype(r.name)>   e_name   { "name",   &r.name };
+        Element<decltype(r.price)>  e_price  { "price",  &r.price };
+        Element<decltype(r.tags)>   e_tags   { "tags",   &r.tags };
+        Element<decltype(r.active)> e_active { "active", &r.active };
+        ElementBase* tbl[] = { &e_id, &e_name, &e_price, &e_tags, &e_active };
+        const char* key = path.getIndex() < 0 ? path.getKey() : path.getParent()->getKey();
+        for(auto& e : tbl) { if(*e == key) { e->store(value, path.getIndex()); ++stored; return; } }
+    }
+    Record records[4]{};
+    int stored{};
+};
+
+// Delegaters for records in the pool.
+class PoolHandler : public goblib::json::DelegateHandler
+{
+  public:
+    struct RecordDelegater : Delegater
+    {
+        explicit RecordDelegater(int& sum) : _sum(sum) {}
+        virtual void value(const ElementPath& path, const ElementValue& value) override
+        {
+            if(strcmp(path.getKey(), "id") == 0) { _sum += value.getInt(); }
+        }
+        int& _sum;
+    };
+    struct RootDelegater : Delegater
+    {
+        explicit RootDelegater(int& sum) : _sum(sum) {}
+        virtual Delegater* startObject(const ElementPath& path) override
+        {
+            return path.getCount() == 2 ? pool.create(_sum) : Delegater::startObject(path);
+        }
+        virtual void dispose() override {}
+        int& _sum;
+        goblib::json::DelegaterPool<RecordDelegater, 1> pool;
+    };
+    PoolHandler() : _root(sum) {}
+    virtual void startObject(const ElementPath& path) override
+    {
+        if(path.getCount() == 0) { pushDelegater(&_root); return; }
+        DelegateHandler::startObject(path);
+    }
+    int sum{};
+    RootDelegater _root;
+};
+//
+}
+
+TEST(Alloc, Binding)
+{
+    const std::string json = makeAllocJson();
+
+    // Element with fixed storages
+    {
+        FixedHandler handler;
+        goblib::json::StreamingParser parser(&handler);
+        Tracker t;
+        parser.parse(json.data(), json.size());
+        EXPECT_EQ(t.count(), 0U);
+        EXPECT_FALSE(parser.hasError());
+        EXPECT_EQ(handler.records[1].id, 49);
+        EXPECT_STREQ(handler.records[1].tags[1], "b");
+        EXPECT_GT(handler.stored, RECORDS * 5);
+    }
+    // NumberSink with fixed buffer and callback
+    {
+        TouchHandler handler;
+        goblib::json::StreamingParser parser(&handler);
+        int32_t ys[RECORDS * 3]{};
+        goblib::json::BufferNumberSink<int32_t> ySink(ys, RECORDS * 3);
+        int64_t ids{};
+        goblib::json::CallbackNumberSink<int64_t> idSink([](const int64_t* v, size_t len, void* arg)
+        {
+            while(len--) { *static_cast<int64_t*>(arg) += *v++; }
+        }, &ids);
+        parser.addNumberSink("records[*].pos.y", &ySink);
+        parser.addNumberSink("records[*].pos.x", &idSink); // Not an array, goes to the handler.
+        Tracker t;
+        parser.parse(json.data(), json.size());
+        EXPECT_EQ(t.count(), 0U);
+        EXPECT_FALSE(parser.hasError());
+        EXPECT_EQ(ySink.size(), (size_t)RECORDS * 3);
+        EXPECT_EQ(ys[RECORDS * 3 - 1], 3);
+    }
+    // DelegateHandler with pooled delegaters
+    {
+        PoolHandler handler;
+        goblib::json::StreamingParser parser(&handler);
+        Tracker t;
+        parser.parse(json.data(), json.size());
+        EXPECT_EQ(t.count(), 0U);
+        EXPECT_FALSE(parser.hasError());
+        EXPECT_EQ(handler.sum, RECORDS * (RECORDS - 1) / 2);
+    }
+    // StreamingWriter to fixed buffer
+    {
+        char out[512];
+        Tracker t;
+        goblib::json::FixedBufferSink sink(out, sizeof(out));
+        goblib::json::StreamingWriter writer(&sink);
+        writer.beginObject().key("id").value(12).key("name").value("abc").key("v").beginArray();
+        for(int i = 0; i < 16; ++i) { writer.value(i * 0.5f); }
+        writer.endArray().endObject();
+        EXPECT_TRUE(writer.flush());
+        EXPECT_EQ(t.count(), 0U);
+    }
+}
+
+// TEST(Alloc, Report)
+namespace
+{
+struct CopyHandler : public TouchHandler
+{
+    virtual void value(const ElementPath& path, const ElementValue& v) override
+    {
+        if(pathString) { bytes += path.toString().length(); }
+        if(valueString) { bytes += v.toString().length(); }
+        if(store && path.getKey()[0] == 'n' && v.isString())
+        {
+            Element<decltype(name)> e_name { "name", &name };
+            e_name.store(v, path.getIndex());
+        }
+    }
+    bool pathString{}, valueString{}, store{};
+    goblib::json::string_t name{};
+    size_t bytes{};
+};
+
+// Not pooled, allocated by new for each record.
+class NewHandler : public goblib::json::DelegateHandler
+{
+  public:
+    struct RootDelegater : Delegater
+    {
+        virtual Delegater* startObject(const ElementPath& path) override
+        {
+            return path.getCount() == 2 ? new Delegater() : Delegater::startObject(path);
+        }
+        virtual void dispose() override {}
+    };
+    virtual void startObject(const ElementPath& path) override
+    {
+        if(path.getCount() == 0) { pushDelegater(&_root); return; }
+        DelegateHandler::startObject(path);
+    }
+    RootDelegater _root;
+};
+
+template<class H> size_t allocationsPerDocument(H& handler, const std::string& json)
+{
+    goblib::json::StreamingParser parser(&handler);
+    Tracker t;
+    parser.parse(json.data(), json.size());
+    EXPECT_FALSE(parser.hasError());
+    return t.count();
+}
+//
+}
+
+TEST(Alloc, Report)
+{
+    const std::string json = makeAllocJson();
+    std::printf("Allocations per document (%d records, %zu bytes)\n", RECORDS, json.size());
+
+    CopyHandler ph; ph.pathString = true;
+    CopyHandler vh; vh.valueString = true;
+    CopyHandler sh; sh.store = true;
+    NewHandler nh;
+    const size_t counts[] =
+    {
+        allocationsPerDocument(ph, json), allocationsPerDocument(vh, json),
+        allocationsPerDocument(sh, json), allocationsPerDocument(nh, json),
+    };
+    const char* names[] =
+    {
+        "ElementPath::toString", "ElementValue::toString", "Element<string_t>::store", "Delegater by new",
+    };
+    for(size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); ++i)
+    {
+        std::printf("  %-28s %6zu (%.2f/record)\n", names[i], counts[i], (double)counts[i] / RECORDS);
+        RecordProperty(names[i], (int)counts[i]);
+    }
+    EXPECT_GE(counts[3], (size_t)RECORDS); // At least one per record.
+
+    // formatString
+    size_t fmt{};
+    {
+        Tracker t;
+        auto s = goblib::json::formatString("%s[%d] %s", "long key name of the element", 123, "over the small string buffer");
+        fmt = t.count();
+        EXPECT_FALSE(s.empty());
+    }
+    std::printf("  %-28s %6zu\n", "formatString", fmt);
+    EXPECT_GE(fmt, 1U);
+}
@@ -2,6 +2,7 @@
 
 #include <gob_json.hpp>
 #include <gob_json_delegate_handler.hpp>
+#include <internal/gob_json_stats.hpp>
 #include <array>
 #include<cmath>
 #include <ctime>
@@ -331,3 +332,322 @@ TEST(Basic, UnicodeEscape)
 
 }
 
+
+// TEST(Basic, DelegaterPool)
+namespace
+{
+struct Item { int id{}; int count{}; };
+
+// Delegaters for item objects are constructed in the pool, nested objects are ignored.
+class ItemsHandler : public goblib::json::DelegateHandler
+{
+  public:
+    struct ItemDelegater : Delegater
+    {
+        ItemDelegater(Item& target) : _v(target) { ++constructed; }
+        ~ItemDelegater() { ++destructed; }
+        virtual void value(const ElementPath& path, const ElementValue& value) override
+        {
+            if(strcmp(path.getKey(), "id") == 0) { _v.id += value.getInt(); ++_v.count; }
+        }
+        Item& _v;
+        static int constructed, destructed;
+    };
+    struct RootDelegater : Delegater
+    {
+        RootDelegater(Item& target) : _v(target) {}
+        virtual Delegater* startObject(const ElementPath& path) override
+        {
+            auto parent = path.getParent();
+            if(parent && strcmp(parent->getKey(), "items") == 0) { return pool.create(_v); }
+            return Delegater::startObject(path);
+        }
+        virtual void dispose() override {} // Not allocated.
+        Item& _v;
+        goblib::json::DelegaterPool<ItemDelegater, 1> pool;
+    };
+
+    ItemsHandler(Item& v) : _root(v) {}
+    void startObject(const ElementPath& path) override
+    {
+        if(path.getCount() == 0) { pushDelegater(&_root); return; }
+        DelegateHandler::startObject(path);
+    }
+    RootDelegater _root;
+};
+int ItemsHandler::ItemDelegater::constructed{};
+int ItemsHandler::ItemDelegater::destructed{};
+//
+}
+
+TEST(Basic, DelegaterPool)
+{
+    Item item;
+    ItemsHandler handler(item);
+    goblib::json::StreamingParser parser(&handler);
+
+    parser.parse(R"({"items":[)", 10);
+    for(int i = 0; i < 100; ++i)
+    {
+        char buf[64];
+        auto len = snprintf(buf, sizeof(buf), R"(%s{"id":%d,"sub":{"id":1000,"x":{}}})", i ? "," : "", i);
+        parser.parse(buf, len);
+    }
+    parser.parse("]}", 2);
+
+    EXPECT_FALSE(parser.hasError());
+    EXPECT_EQ(item.count, 100);
+    EXPECT_EQ(item.id, 4950);
+    EXPECT_EQ(ItemsHandler::ItemDelegater::constructed, 100);
+    EXPECT_EQ(ItemsHandler::ItemDelegater::destructed, 100);
+    EXPECT_EQ(handler._root.pool.available(), 1U);
+}
+
+// TEST(Basic, NumberSink)
+namespace
+{
+struct CountHandler : public DocumentCountHandler
+{
+    virtual void value(const ElementPath& path, const ElementValue& ) override
+    {
+        ++count;
+        last = path.toString();
+    }
+    int count{};
+    goblib::json::string_t last;
+};
+//
+}
+
+TEST(Basic, NumberSink)
+{
+    std::string json = R"({"samples":[)";
+    for(int i = 0; i < 100; ++i) { json += (i ? "," : "") + std::to_string(i) + ".5"; }
+    json += R"(],"nested":{"a":[[1,-2,3000000000],[4,5,6,7]]},"ids":[-1,"str",18446744073709551615],"other":[1,2]})";
+
+    std::vector<float> samples;
+    goblib::json::VectorNumberSink<decltype(samples)> sampleSink(samples);
+    int32_t buf[6]{};
+    goblib::json::BufferNumberSink<int32_t> bufSink(buf, 6);
+    uint64_t sum{};
+    goblib::json::CallbackNumberSink<uint64_t> idSink([](const uint64_t* v, size_t len, void* arg)
+    {
+        while(len--) { *static_cast<uint64_t*>(arg) += *v++; }
+    }, &sum);
+
+    CountHandler handler;
+    goblib::json::StreamingParser parser(&handler);
+    EXPECT_TRUE(parser.addNumberSink("samples", &sampleSink));
+    EXPECT_TRUE(parser.addNumberSink("nested.a[*]", &bufSink));
+    EXPECT_FALSE(parser.addNumberSink("ids", &idSink)); // Over GOB_JSON_PARSER_NUMBER_SINK_MAX
+    parser.clearNumberSinks();
+    EXPECT_TRUE(parser.addNumberSink("samples", &sampleSink));
+    EXPECT_TRUE(parser.addNumberSink("nested.a[*]", &bufSink));
+
+    parser.parse(json.c_str(), json.size());
+    EXPECT_FALSE(parser.hasError());
+
+    ASSERT_EQ(samples.size(), 100U);
+    EXPECT_FLOAT_EQ(samples[0], 0.5f);
+    EXPECT_FLOAT_EQ(samples[99], 99.5f);
+
+    EXPECT_EQ(bufSink.size(), 6U);
+    EXPECT_EQ(bufSink.dropped(), 1U);
+    EXPECT_EQ(buf[0], 1);
+    EXPECT_EQ(buf[1], -2);
+    EXPECT_EQ(buf[2], INT32_MAX); // Clamped
+    EXPECT_EQ(buf[5], 6);
+
+    // Not bound arrays are passed to handler.
+    EXPECT_EQ(handler.count, 5);
+    EXPECT_STREQ(handler.last.c_str(), "other[1]");
+
+    // Other elements than numbers are passed to handler.
+    {
+        CountHandler handler;
+        goblib::json::StreamingParser parser(&handler);
+        parser.addNumberSink("ids", &idSink);
+        parser.parse(json.c_str(), json.size());
+        EXPECT_FALSE(parser.hasError());
+        EXPECT_EQ(sum, UINT64_MAX); // -1 is clamped to 0
+        EXPECT_EQ(handler.count, 100 + 7 + 1 + 2);
+    }
+
+    // Partial batch is discarded by reset, and passed on error
+    {
+        samples.clear();
+        CountHandler handler;
+        goblib::json::StreamingParser parser(&handler);
+        parser.addNumberSink("samples", &sampleSink);
+        const char partial[] = R"({"samples":[1,2,3)";
+        parser.parse(partial, sizeof(partial) - 1);
+        parser.reset();
+        const char bad[] = R"({"samples":[4,5,x]})";
+        parser.parse(bad, sizeof(bad) - 1);
+        EXPECT_TRUE(parser.hasError());
+        EXPECT_EQ(samples, (std::vector<float>{4, 5}));
+        parser.reset();
+        const char good[] = R"({"samples":[6]})";
+        parser.parse(good, sizeof(good) - 1);
+        EXPECT_FALSE(parser.hasError());
+        EXPECT_EQ(samples, (std::vector<float>{4, 5, 6}));
+    }
+
+    // Integral sink converts fraction and exponent as Element does
+    {
+        CountHandler handler;
+        goblib::json::StreamingParser parser(&handler);
+        int32_t ints[6]{};
+        goblib::json::BufferNumberSink<int32_t> intSink(ints, 6);
+        uint8_t bytes[3]{};
+        goblib::json::BufferNumberSink<uint8_t> byteSink(bytes, 3);
+        parser.addNumberSink("i", &intSink);
+        parser.addNumberSink("u", &byteSink);
+        const char json[] = R"({"i":[1e3,2.9,-1e30,1E300,-2.5e0,7],"u":[-3.5,255.9,1e2]})";
+        parser.parse(json, sizeof(json) - 1);
+        EXPECT_FALSE(parser.hasError());
+        EXPECT_EQ(ints[0], 1000);
+        EXPECT_EQ(ints[1], 2);
+        EXPECT_EQ(ints[2], INT32_MIN);
+        EXPECT_EQ(ints[3], INT32_MAX);
+        EXPECT_EQ(ints[4], -2);
+        EXPECT_EQ(ints[5], 7);
+        EXPECT_EQ(bytes[0], 0);
+        EXPECT_EQ(bytes[1], 255);
+        EXPECT_EQ(bytes[2], 100);
+
+        // clear() discards the pending batch as well
+        parser.reset();
+        const char head[] = R"({"i":[1,2,)";
+        parser.parse(head, sizeof(head) - 1);
+        intSink.clear();
+        const char tail[] = R"(3]})";
+        parser.parse(tail, sizeof(tail) - 1);
+        EXPECT_FALSE(parser.hasError());
+        EXPECT_EQ(intSink.size(), 1U);
+        EXPECT_EQ(ints[0], 3);
+    }
+}
+
+// TEST(Basic, RawNumber)
+namespace
+{
+const char raw_number_json[] =
+R"***(
+{
+  "id": 18446744073709551615,
+  "min": -9223372036854775808,
+  "price": 0.1,
+  "exp": 1e3,
+  "neg_exp": -2.5E-3,
+  "int_as_float": -42
+}
+)***";
+
+struct RawHandler : public DocumentCountHandler
+{
+    virtual void value(const ElementPath& path, const ElementValue& v) override
+    {
+        if(!v.hasRaw()) { return; }
+        raw.push_back(goblib::json::string_t(v.getRaw(), v.getRawLength()));
+        types.push_back(v.getType());
+        if     (strcmp(path.getKey(), "id")           == 0) { id = v.getInt(); }
+        else if(strcmp(path.getKey(), "min")          == 0) { min = static_cast<int64_t>(v.getInt()); }
+        else if(strcmp(path.getKey(), "exp")          == 0) { exp = v.getFloat(); expInt = static_cast<int>(v.getInt()); }
+        else if(strcmp(path.getKey(), "neg_exp")      == 0) { negExp = v.getFloat(); flags = v.getNumberFlags(); }
+        else if(strcmp(path.getKey(), "int_as_float") == 0) { intAsFloat = v.getFloat(); }
+    }
+    std::vector<goblib::json::string_t> raw;
+    std::vector<ElementValue::Type> types;
+    uint64_t id{};
+    int64_t min{};
+    double exp{}, negExp{}, intAsFloat{};
+    int expInt{};
+    uint8_t flags{};
+};
+//
+}
+
+TEST(Basic, RawNumber)
+{
+    RawHandler handler;
+    goblib::json::StreamingParser parser(&handler);
+    for(auto& c : raw_number_json) { parser.parse(c); }
+    EXPECT_FALSE(parser.hasError());
+
+    ASSERT_EQ(handler.raw.size(), 6U);
+    // Passthrough without precision loss
+    EXPECT_STREQ(handler.raw[0].c_str(), "18446744073709551615");
+    EXPECT_STREQ(handler.raw[2].c_str(), "0.1");
+    EXPECT_STREQ(handler.raw[4].c_str(), "-2.5E-3");
+
+    EXPECT_EQ(handler.types[0], ElementValue::Type::Int);
+    EXPECT_EQ(handler.types[2], ElementValue::Type::Float);
+    EXPECT_EQ(handler.types[3], ElementValue::Type::Float); // Exponent without fraction
+
+    EXPECT_EQ(handler.id, UINT64_MAX);
+    EXPECT_EQ(handler.min, INT64_C(-9223372036854775807) - 1);
+    EXPECT_DOUBLE_EQ(handler.exp, 1000.0);
+    EXPECT_EQ(handler.expInt, 1000);
+    EXPECT_DOUBLE_EQ(handler.negExp, -0.0025);
+    EXPECT_EQ(handler.flags, ElementValue::Negative | ElementValue::Fraction | ElementValue::Exponent);
+    EXPECT_DOUBLE_EQ(handler.intAsFloat, -42.0);
+
+    // Not from the parser
+    ElementValue ev;
+    EXPECT_FALSE(ev.with((ElementValue::number_t)7).hasRaw());
+    EXPECT_EQ(ev.getRaw(), nullptr);
+    EXPECT_DOUBLE_EQ(ev.getFloat(), 7.0);
+    EXPECT_EQ(ev.with(3.9).getInt(), 3U);
+
+    // Float out of range is clamped to intmax_t
+    EXPECT_EQ((intmax_t)ev.with(1e300).getInt(), INTMAX_MAX);
+    EXPECT_EQ((intmax_t)ev.with(-1e300).getInt(), INTMAX_MIN);
+    EXPECT_EQ((intmax_t)ev.with(std::nan("")).getInt(), 0);
+    EXPECT_EQ((intmax_t)ev.withNumber("1e300", 5, ElementValue::Exponent).getInt(), INTMAX_MAX);
+    EXPECT_EQ((intmax_t)ev.withNumber("-1e300", 6, ElementValue::Negative | ElementValue::Exponent).getInt(), INTMAX_MIN);
+}
+
+#if GOB_JSON_STATS
+// TEST(Basic, Stats)
+TEST(Basic, Stats)
+{
+    std::string json = R"({"a":[1,2.5,{"b":[[true]]}],"s":")";
+    json += std::string(GOB_JSON_PARSER_BUFFER_MAX_LENGTH + 10, 'x') + R"(","k)";
+    json += std::string(GOB_JSON_PARSER_KEY_MAX_LENGTH, 'k') + R"(":null})";
+
+    CountHandler handler;
+    goblib::json::StreamingParser parser(&handler);
+    parser.parse(json.c_str(), json.size());
+    EXPECT_FALSE(parser.hasError());
+
+    auto& st = parser.getStats();
+    using PS = goblib::json::ParserStats;
+    EXPECT_EQ(st.events[PS::StartDocument], 1U);
+    EXPECT_EQ(st.events[PS::EndDocument], 1U);
+    EXPECT_EQ(st.events[PS::StartObject], 2U);
+    EXPECT_EQ(st.events[PS::EndObject], 2U);
+    EXPECT_EQ(st.events[PS::StartArray], 3U);
+    EXPECT_EQ(st.events[PS::Value], 5U);
+    EXPECT_EQ(st.numbers, 2U);
+    EXPECT_EQ(st.truncatedTokens, 1U);
+    EXPECT_EQ(st.truncatedKeys, 1U);
+    EXPECT_EQ(st.bufferHighWater, GOB_JSON_PARSER_BUFFER_MAX_LENGTH);
+    EXPECT_EQ(st.keyHighWater, GOB_JSON_PARSER_KEY_MAX_LENGTH + 1);
+    EXPECT_EQ(st.depthHighWater, 5); // Object, array, object, array, array
+    EXPECT_GT(st.handlerTicks, 0U);
+
+    uint64_t total{};
+    for(auto& b : st.bytes) { total += b; }
+    EXPECT_GE(total, json.size());
+    EXPECT_GT(st.bytes[10], 0U); // IN_NUMBER
+    EXPECT_STREQ(goblib::json::StreamingParser::getStateName(10), "IN_NUMBER");
+
+    // Across a wrap of the counter
+    using goblib::json::stats::tick_t;
+    EXPECT_EQ(goblib::json::stats::elapsed(static_cast<tick_t>(-3), 2), 5U);
+
+    parser.resetStats();
+    EXPECT_EQ(parser.getStats().events[PS::Value], 0U);
+}
+#endif
@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+
+#include "gob_json_test_helper.hpp"
+#include <gob_json_binary_parser.hpp>
+#include <string>
+#include <vector>
+
+using goblib::json::ElementPath;
+using goblib::json::ElementValue;
+using goblib::json::BinaryFormat;
+using goblib::json::BinaryParser;
+using goblib::json::TranscodeHandler;
+using gob_json_test::VectorSink;
+
+// TEST(BinaryParser, SameEvents)
+namespace
+{
+const char binary_json[] =
+R"***({"name":"binary","id":-42,"big":18446744073709551615,"min":-9223372036854775808,"price":0.125,"exp":-1.5e-3,
+"flags":[true,false,null],"nested":{"a":[[1,2],[3,{"b":"あ\"q\""}]],"c":{},"d":[]},
+"items":[{"id":1,"name":"x"},{"id":200,"name":"y"},{"id":70000,"name":"z"}],
+"long":"0123456789012345678901234567890123456789"}
+[1,"second document",{"k":[{}]}])***";
+
+// Typed values (Numbers without raw text)
+struct BinaryLog : public gob_json_test::LogHandler { BinaryLog() : LogHandler(Value::Typed) {} };
+
+std::vector<std::string> parseBinary(const BinaryFormat format, const std::vector<char>& bin, const size_t chunk, bool* error = nullptr)
+{
+    BinaryLog lh;
+    BinaryParser parser(format, &lh);
+    parser.setRecursively(true);
+    for(size_t i = 0; i < bin.size(); i += chunk) { parser.parse(bin.data() + i, std::min(chunk, bin.size() - i)); }
+    if(error) { *error = parser.hasError(); }
+    else { EXPECT_FALSE(parser.hasError()); }
+    return lh.log;
+}
+//
+}
+
+TEST(BinaryParser, SameEvents)
+{
+    BinaryLog direct;
+    {
+        goblib::json::StreamingParser parser(&direct);
+        parser.setRecursively(true);
+        parser.parse(binary_json, sizeof(binary_json) - 1);
+        EXPECT_FALSE(parser.hasError());
+    }
+
+    for(auto format : { BinaryFormat::CBOR, BinaryFormat::MessagePack })
+    {
+        VectorSink sink;
+        TranscodeHandler th(format, &sink);
+        goblib::json::StreamingParser parser(&th);
+        parser.setRecursively(true);
+        parser.parse(binary_json, sizeof(binary_json) - 1);
+        ASSERT_FALSE(th.hasError());
+
+        // Byte at a time, and chunks
+        const std::vector<char> bin(sink.out.begin(), sink.out.end());
+        for(size_t chunk : { (size_t)1, (size_t)7, bin.size() })
+        {
+            SCOPED_TRACE(chunk);
+            EXPECT_EQ(parseBinary(format, bin, chunk), direct.log);
+        }
+    }
+}
+
+TEST(BinaryParser, CBOR)
+{
+    // Indefinite map, chunked string, tag, half float, integer keys, undefined
+    const std::vector<char> cbor = {
+        (char)0xBF,
+        0x63, 'a', 'b', 'c', (char)0x7F, 0x62, 'x', 'y', 0x61, 'z', (char)0xFF,
+        0x01, (char)0xC1, 0x1A, 0x00, 0x00, 0x00, 0x10,
+        0x20, (char)0x9F, (char)0xF9, 0x3C, 0x00, (char)0xF9, (char)0xFC, 0x00, (char)0xF7, (char)0xFF,
+        (char)0xFF };
+    auto log = parseBinary(BinaryFormat::CBOR, cbor, 1);
+    EXPECT_EQ(log, (std::vector<std::string>{ "SD", "SO ", "V abc=sxyz", "V 1=i16", "SA -1",
+                    "V -1[0]=f1", "V -1[1]=f-inf", "V -1[2]=null", "EA -1", "EO ", "ED" }));
+
+    // Top-level scalar
+    log = parseBinary(BinaryFormat::CBOR, { 0x18, 0x64 }, 1);
+    EXPECT_EQ(log, (std::vector<std::string>{ "SD", "V =i100", "ED" }));
+
+    // Errors
+    bool error{};
+    parseBinary(BinaryFormat::CBOR, { (char)0xA1, (char)0xA0, 0x01 }, 1, &error); // Map as key
+    EXPECT_TRUE(error);
+    parseBinary(BinaryFormat::CBOR, { (char)0x81, (char)0xFF }, 1, &error); // Break in definite
+    EXPECT_TRUE(error);
+    parseBinary(BinaryFormat::CBOR, { (char)0xBF, 0x61, 'a', (char)0xFF }, 1, &error); // No value for the key
+    EXPECT_TRUE(error);
+    parseBinary(BinaryFormat::CBOR, { (char)0x1C }, 1, &error); // Reserved
+    EXPECT_TRUE(error);
+}
+
+TEST(BinaryParser, MessagePack)
+{
+    // bin8, fixext1, ext8, negative fixint key
+    const std::vector<char> mp = {
+        (char)0x84,
+        (char)0xA1, 'b', (char)0xC4, 0x02, 'h', 'i',
+        (char)0xA1, 'e', (char)0xD4, 0x01, 0x7F,
+        (char)0xA1, 'f', (char)0xC7, 0x02, 0x05, 0x00, 0x00,
+        (char)0xFF, (char)0xD1, (char)0x80, 0x00 };
+    auto log = parseBinary(BinaryFormat::MessagePack, mp, 1);
+    EXPECT_EQ(log, (std::vector<std::string>{ "SD", "SO ", "V b=shi", "V e=null", "V f=null", "V -1=i-32768", "EO ", "ED" }));
+
+    bool error{};
+    parseBinary(BinaryFormat::MessagePack, { (char)0x91, (char)0xC1 }, 1, &error); // Never used
+    EXPECT_TRUE(error);
+}
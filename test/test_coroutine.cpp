@@ -0,0 +1,210 @@
+#include <gtest/gtest.h>
+
+#include <gob_json_coroutine.hpp>
+
+#if GOB_JSON_HAS_COROUTINE
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using goblib::json::ElementPath;
+using goblib::json::ElementValue;
+using namespace goblib::json::coro;
+
+// TEST(Coroutine, Streams)
+namespace
+{
+const char stream_json[] =
+R"***({"id":12,"name":"stream","values":[1,2,3,4,5,6,7,8,9,10],"nested":{"ok":true,"price":0.25}})***";
+
+struct CountHandler : public goblib::json::Handler
+{
+    virtual void startDocument() override {}
+    virtual void endDocument() override { ++documents; }
+    virtual void startObject(const ElementPath& ) override {}
+    virtual void endObject(const ElementPath& ) override {}
+    virtual void startArray(const ElementPath& ) override {}
+    virtual void endArray(const ElementPath& ) override {}
+    virtual void whitespace(const char/*ch*/) override {}
+    virtual void value(const ElementPath& , const ElementValue& v) override
+    {
+        ++values;
+        if(v.isInt()) { sum += v.getInt(); }
+    }
+    int values{}, documents{};
+    uint64_t sum{};
+};
+
+struct Stream
+{
+    int fds[2]{-1, -1};
+    CountHandler handler{};
+    std::unique_ptr<AsyncSource> src{};
+    std::unique_ptr<AsyncParser> parser{};
+    ~Stream() { for(auto fd : fds) { if(fd >= 0) { close(fd); } } }
+};
+
+bool writeAll(const int fd, const char* s, size_t len)
+{
+    while(len)
+    {
+        auto sz = write(fd, s, len);
+        if(sz <= 0) { return false; }
+        s += sz;
+        len -= sz;
+    }
+    return true;
+}
+
+std::string text(const ElementValue& v)
+{
+    if(v.hasRaw())    { return v.getRaw(); }
+    if(v.isString())  { return v.getString(); }
+    if(v.isBool())    { return v.getBool() ? "true" : "false"; }
+    return "null";
+}
+
+Task<int> collect(AsyncParser& ap, std::vector<std::string>& out, std::vector<std::string>* ends = nullptr)
+{
+    int count{};
+    while(auto ev = co_await ap.next())
+    {
+        if(ev->kind == AsyncParser::Kind::Value) { out.push_back(ev->path->toString() + "=" + text(ev->value)); }
+        if(ends && (ev->kind == AsyncParser::Kind::EndArray || ev->kind == AsyncParser::Kind::EndObject))
+        {
+            ends->push_back(ev->path->toString());
+        }
+        ++count;
+    }
+    co_return count;
+}
+
+Task<bool> awaitReadable(EventLoop& loop, const int fd)
+{
+    co_return co_await loop.readable(fd);
+}
+//
+}
+
+TEST(Coroutine, Streams)
+{
+    constexpr int N = 200;
+    const size_t half = sizeof(stream_json) / 2;
+    EventLoop loop;
+    std::vector<std::unique_ptr<Stream>> streams;
+    std::vector<Task<bool>> tasks;
+    for(int i = 0; i < N; ++i)
+    {
+        auto s = std::unique_ptr<Stream>(new Stream);
+        ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, s->fds), 0);
+        s->src.reset(new AsyncSource(loop, s->fds[0]));
+        s->parser.reset(new AsyncParser(*s->src));
+        tasks.push_back(s->parser->parse(s->handler));
+        tasks.back().start();
+        streams.push_back(std::move(s));
+    }
+    // All streams are waiting for input
+    EXPECT_EQ(loop.waiting(), (size_t)N);
+
+    // Half of the input, the parsers suspend again in the middle of the document.
+    for(auto& s : streams) { ASSERT_TRUE(writeAll(s->fds[1], stream_json, half)); }
+    while(loop.runOnce(0) > 0) {}
+    EXPECT_EQ(loop.waiting(), (size_t)N);
+    for(auto& t : tasks) { EXPECT_FALSE(t.done()); }
+
+    // Rest and EOF
+    for(auto& s : streams)
+    {
+        ASSERT_TRUE(writeAll(s->fds[1], stream_json + half, sizeof(stream_json) - 1 - half));
+        shutdown(s->fds[1], SHUT_WR);
+    }
+    loop.run();
+
+    for(int i = 0; i < N; ++i)
+    {
+        ASSERT_TRUE(tasks[i].done());
+        EXPECT_TRUE(tasks[i].result());
+        EXPECT_EQ(streams[i]->handler.documents, 1);
+        EXPECT_EQ(streams[i]->handler.values, 14);
+        EXPECT_EQ(streams[i]->handler.sum, 12U + 55U);
+    }
+}
+
+TEST(Coroutine, Next)
+{
+    EventLoop loop;
+    int fds[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    AsyncSource src(loop, fds[0]);
+    AsyncParser ap(src);
+    std::vector<std::string> out, ends;
+    auto task = collect(ap, out, &ends);
+    task.start();
+    EXPECT_FALSE(task.done());
+
+    // Byte by byte
+    for(const char* p = stream_json; *p; ++p)
+    {
+        ASSERT_TRUE(writeAll(fds[1], p, 1));
+        while(loop.runOnce(0) > 0) {}
+    }
+    shutdown(fds[1], SHUT_WR);
+    loop.run();
+
+    ASSERT_TRUE(task.done());
+    EXPECT_EQ(task.result(), 14 + 8); // Values + start/end of document, 2 objects, array
+    ASSERT_EQ(out.size(), 14U);
+    EXPECT_EQ(out[0], "id=12");
+    EXPECT_EQ(out[1], "name=stream");
+    EXPECT_EQ(out[2], "values[0]=1");
+    EXPECT_EQ(out[12], "nested.ok=true");
+    EXPECT_EQ(out[11], "values[9]=10"); // Path of the value closed by ']' in the same character
+    EXPECT_EQ(out[13], "nested.price=0.25");
+    EXPECT_EQ(ends, (std::vector<std::string>{"values", "nested", ""}));
+    EXPECT_FALSE(ap.hasError());
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST(Coroutine, Chunk)
+{
+    // Whole document in a read, events are views until the next call
+    EventLoop loop;
+    int fds[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    ASSERT_TRUE(writeAll(fds[1], stream_json, sizeof(stream_json) - 1));
+    shutdown(fds[1], SHUT_WR);
+    AsyncSource src(loop, fds[0]);
+    AsyncParser ap(src);
+    std::vector<std::string> out;
+    auto task = collect(ap, out);
+    task.start();
+    loop.run();
+    ASSERT_TRUE(task.done());
+    ASSERT_EQ(out.size(), 14U);
+    EXPECT_EQ(out[11], "values[9]=10");
+    EXPECT_EQ(out[13], "nested.price=0.25");
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST(Coroutine, WatchError)
+{
+    // A regular file cannot be watched by epoll, the awaiter returns false without suspending.
+    EventLoop loop;
+    char path[] = "/tmp/gob_json_coro_XXXXXX";
+    const int fd = mkstemp(path);
+    ASSERT_GE(fd, 0);
+    unlink(path);
+    auto task = awaitReadable(loop, fd);
+    task.start();
+    ASSERT_TRUE(task.done());
+    EXPECT_FALSE(task.result());
+    EXPECT_EQ(loop.waiting(), 0U);
+    close(fd);
+}
+
+#endif
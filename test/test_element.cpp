@@ -4,6 +4,7 @@
 #include <gob_json.hpp>
 #include <gob_json_element.hpp>
 #include <gob_json_delegate_handler.hpp>
+#include <gob_json_arena.hpp>
 
 // TEST(Element, Basic)
 namespace
@@ -180,6 +181,94 @@ TEST(Element, Basic)
     }
 }
 
+TEST(Element, Serialize)
+{
+    // Parse, write by the same Elements, and parse the output again.
+    TestHandler src;
+    goblib::json::StreamingParser parser(&src);
+    for(auto& e: test_json) { parser.parse(e); }
+    EXPECT_FALSE(parser.hasError());
+
+    Element<decltype(src.b)>   e_b   { "boolean", &src.b };
+    Element<decltype(src.ba0)> e_ba0 { "boolean_array0", &src.ba0 };
+    Element<decltype(src.ba1)> e_ba1 { "boolean_array1", &src.ba1 };
+    Element<decltype(src.ba2)> e_ba2 { "boolean_array2", &src.ba2 };
+    Element<decltype(src.i)>   e_i   { "integer", &src.i };
+    Element<decltype(src.ia0)> e_ia0 { "integer_array0", &src.ia0 };
+    Element<decltype(src.ia1)> e_ia1 { "integer_array1", &src.ia1 };
+    Element<decltype(src.ia2)> e_ia2 { "integer_array2", &src.ia2 };
+    Element<decltype(src.f)>   e_f   { "float", &src.f };
+    Element<decltype(src.fa0)> e_fa0 { "float_array0", &src.fa0 };
+    Element<decltype(src.fa1)> e_fa1 { "float_array1", &src.fa1 };
+    Element<decltype(src.fa2)> e_fa2 { "float_array2", &src.fa2 };
+    Element<decltype(src.s)>   e_s   { "string", &src.s };
+    Element<decltype(src.sa0)> e_sa0 { "string_array0", &src.sa0 };
+    Element<decltype(src.sa1)> e_sa1 { "string_array1", &src.sa1 };
+    Element<decltype(src.sa2)> e_sa2 { "string_array2", &src.sa2 };
+
+    char out[1024];
+    goblib::json::FixedBufferSink sink(out, sizeof(out));
+    goblib::json::StreamingWriter writer(&sink);
+    goblib::json::writeObject(writer,
+                              e_b, e_ba0, e_ba1, e_ba2, e_i, e_ia0, e_ia1, e_ia2,
+                              e_f, e_fa0, e_fa1, e_fa2, e_s, e_sa0, e_sa1, e_sa2);
+    EXPECT_TRUE(writer.flush());
+    EXPECT_TRUE(writer.isComplete());
+
+    TestHandler dst;
+    goblib::json::StreamingParser parser2(&dst);
+    parser2.parse(out, sink.size());
+    EXPECT_FALSE(parser2.hasError());
+
+    EXPECT_EQ(dst.b, src.b);
+    for(int i = 0; i < 3; ++i)
+    {
+        EXPECT_EQ(dst.ba0[i], src.ba0[i]);
+        EXPECT_EQ(dst.ba1[i], src.ba1[i]);
+        EXPECT_EQ(dst.ia0[i], src.ia0[i]);
+        EXPECT_EQ(dst.ia1[i], src.ia1[i]);
+        EXPECT_FLOAT_EQ(dst.fa0[i], src.fa0[i]);
+        EXPECT_FLOAT_EQ(dst.fa1[i], src.fa1[i]);
+        EXPECT_EQ(dst.sa0[i], src.sa0[i]);
+        EXPECT_EQ(dst.sa1[i], src.sa1[i]);
+    }
+    EXPECT_EQ(dst.ba2, src.ba2);
+    EXPECT_EQ(dst.i, src.i);
+    EXPECT_EQ(dst.ia2, src.ia2);
+    EXPECT_FLOAT_EQ(dst.f, src.f);
+    EXPECT_EQ(dst.fa2, src.fa2);
+    EXPECT_EQ(dst.s, src.s);
+    EXPECT_EQ(dst.sa2, src.sa2);
+
+    // Whole-valued floats stay floating-point
+    std::vector<float> wf{ 1.0f, 2.0f, -3.0f, 0.5f }, rf;
+    Element<decltype(wf)> e_wf { "whole", &wf };
+    sink.clear();
+    writer.reset();
+    goblib::json::writeObject(writer, e_wf);
+    EXPECT_TRUE(writer.flush());
+    EXPECT_STREQ(out, R"({"whole":[1.0,2.0,-3.0,0.5]})");
+    struct FloatHandler : public TestHandler
+    {
+        virtual void value(const ElementPath& path, const ElementValue& v) override { if(path.getIndex() >= 0) { e->store(v, path.getIndex()); } }
+        ElementBase* e{};
+    } fh;
+    Element<decltype(rf)> e_rf { "whole", &rf };
+    fh.e = &e_rf;
+    goblib::json::StreamingParser parser3(&fh);
+    parser3.parse(out, sink.size());
+    EXPECT_FALSE(parser3.hasError());
+    EXPECT_EQ(rf, wf);
+
+    // Table version
+    ElementBase* tbl[] = { &e_b, &e_i, &e_ia0, &e_s };
+    sink.clear();
+    writer.reset();
+    goblib::json::writeObject(writer, tbl);
+    EXPECT_TRUE(writer.flush());
+    EXPECT_STREQ(out, R"({"boolean":true,"integer":123456789,"integer_array0":[9,8,-7],"string":"あいうABC"})");
+}
+
 // TEST(Element, Custom)
 namespace
 {
@@ -337,5 +426,222 @@ TEST(Element, Custom)
         EXPECT_EQ(tmp.tm_hour,13);
         EXPECT_EQ(tmp.tm_min, 57);        
         EXPECT_EQ(tmp.tm_sec, 0);;
+
+        // No _write for custom types, written as null to keep the JSON valid
+        CustomElement<RGBA> e_rgba { "rgba", &cs.rgba };
+        int i{};
+        Element<int> e_i { "i", &i };
+        char out[64];
+        goblib::json::FixedBufferSink sink(out, sizeof(out));
+        goblib::json::StreamingWriter writer(&sink);
+        goblib::json::writeObject(writer, e_rgba, e_i);
+        EXPECT_TRUE(writer.flush());
+        EXPECT_STREQ(out, R"({"rgba":null,"i":0})");
+    }
+    // Subclass without write() override
+    {
+        struct StoreOnly : public ElementBase
+        {
+            StoreOnly() : ElementBase("store_only") {}
+            virtual void store(const ElementValue&, const int) override {}
+        } e;
+        char out[64];
+        goblib::json::FixedBufferSink sink(out, sizeof(out));
+        goblib::json::StreamingWriter writer(&sink);
+        goblib::json::writeObject(writer, e);
+        EXPECT_TRUE(writer.flush());
+        EXPECT_STREQ(out, R"({"store_only":null})");
+    }
+}
+
+// TEST(Element, Allocator)
+namespace
+{
+const char allocator_json[] =
+R"***(
+{
+  "values": [1, 2, 3, 4, 5, 6, 7, 8],
+  "names": ["alpha", "bravo", "charlie is longer than small string buffer"],
+  "name": "delta is also longer than small string buffer"
+}
+)***";
+
+template<typename T> using arena_vector = std::vector<T, goblib::json::ArenaAllocator<T>>;
+using arena_string = std::basic_string<char, std::char_traits<char>, goblib::json::ArenaAllocator<char>>;
+
+struct ArenaHandler : public TestHandler
+{
+    explicit ArenaHandler(goblib::json::MonotonicArena& arena)
+            : values(goblib::json::ArenaAllocator<int>(arena)),
+              names(goblib::json::ArenaAllocator<arena_string>(arena)),
+              name(goblib::json::ArenaAllocator<char>(arena)) {}
+
+    virtual void value(const ElementPath& path, const ElementValue& value) override
+    {
+        Element<decltype(values)> e_values { "values", &values, 8 }; // Expected length
+        Element<decltype(names)>  e_names  { "names",  &names };
+        Element<decltype(name)>   e_name   { "name",   &name };
+        ElementBase* tbl[] = { &e_values, &e_names, &e_name };
+        const char* key = path.getIndex() < 0 ? path.getKey() : path.getParent()->getKey();
+        for(auto& e : tbl) { if(*e == key) { e->store(value, path.getIndex()); return; } }
     }
+    arena_vector<int> values;
+    arena_vector<arena_string> names;
+    arena_string name;
+};
+//
+}
+
+TEST(Element, Allocator)
+{
+    alignas(std::max_align_t) static uint8_t buf[1024];
+    goblib::json::MonotonicArena arena(buf, sizeof(buf));
+    {
+        ArenaHandler handler(arena);
+        goblib::json::StreamingParser parser(&handler);
+        for(auto& e: allocator_json) { parser.parse(e); }
+        EXPECT_FALSE(parser.hasError());
+
+        EXPECT_EQ(handler.values.size(), 8U);
+        EXPECT_EQ(handler.values.capacity(), 8U); // Reserved once by hint
+        EXPECT_EQ(handler.values[7], 8);
+        ASSERT_EQ(handler.names.size(), 3U);
+        EXPECT_STREQ(handler.names[2].c_str(), "charlie is longer than small string buffer");
+        EXPECT_STREQ(handler.name.c_str(), "delta is also longer than small string buffer");
+
+        // All in the arena
+        auto inArena = [](const void* p) { return p >= buf && p < buf + sizeof(buf); };
+        EXPECT_TRUE(inArena(handler.values.data()));
+        EXPECT_TRUE(inArena(handler.names.data()));
+        EXPECT_TRUE(inArena(handler.names[2].data()));
+        EXPECT_TRUE(inArena(handler.name.data()));
+        EXPECT_GT(arena.used(), 0U);
+    }
+    arena.release();
+    EXPECT_EQ(arena.used(), 0U);
+
+    // Heap blocks when exhausted
+    goblib::json::MonotonicArena small(buf, 16, 256);
+    arena_vector<int> v(goblib::json::ArenaAllocator<int>{small});
+    for(int i = 0; i < 100; ++i) { v.push_back(i); }
+    EXPECT_EQ(v[99], 99);
+
+#if GOB_JSON_HAS_MEMORY_RESOURCE
+    // std::pmr containers
+    {
+        std::pmr::vector<int> pv(&arena);
+        Element<decltype(pv)> e { "values", &pv, 4 };
+        ElementValue ev;
+        for(int i = 0; i < 4; ++i) { e.store(ev.with((ElementValue::number_t)i), i); }
+        EXPECT_EQ(pv.size(), 4U);
+        EXPECT_EQ(pv[3], 3);
+        EXPECT_TRUE(pv.data() >= (void*)buf && pv.data() < (void*)(buf + sizeof(buf)));
+    }
+    arena.release();
+#endif
+}
+
+// TEST(Element, Fixed)
+namespace
+{
+const char fixed_json[] =
+R"***(
+{
+  "name": "ABCDEFGHIJ",
+  "kanji": "漢字カナ",
+  "names": ["alpha", "bravo", "charlie", "delta"],
+  "i8": ["127", "128", "-129", "-128"],
+  "u8": ["255", "-1", "256", "abc"],
+  "i64": "-9223372036854775809",
+  "u64": "18446744073709551616",
+  "flag": "true",
+  "fp": "1.25"
+}
+)***";
+
+struct FixedHandler : public TestHandler
+{
+    virtual void value(const ElementPath& path, const ElementValue& value) override
+    {
+        Element<decltype(name)>  e_name  { "name",  &name };
+        Element<decltype(kanji)> e_kanji { "kanji", &kanji };
+        Element<decltype(names)> e_names { "names", &names };
+        Element<decltype(i8)>    e_i8    { "i8",    &i8 };
+        Element<decltype(u8)>    e_u8    { "u8",    &u8 };
+        Element<decltype(i64)>   e_i64   { "i64",   &i64 };
+        Element<decltype(u64)>   e_u64   { "u64",   &u64 };
+        Element<decltype(flag)>  e_flag  { "flag",  &flag };
+        Element<decltype(fp)>    e_fp    { "fp",    &fp };
+        ElementBase* tbl[] = { &e_name, &e_kanji, &e_names, &e_i8, &e_u8, &e_i64, &e_u64, &e_flag, &e_fp };
+        const char* key = path.getIndex() < 0 ? path.getKey() : path.getParent()->getKey();
+        for(auto& e : tbl) { if(*e == key) { e->store(value, path.getIndex()); return; } }
+    }
+    char name[8]{};
+    char kanji[8]{};
+    char names[3][6]{};
+    int8_t i8[4]{};
+    uint8_t u8[4]{};
+    int64_t i64{};
+    uint64_t u64{};
+    bool flag{};
+    float fp{};
+};
+//
+}
+
+TEST(Element, Fixed)
+{
+    FixedHandler handler;
+    goblib::json::StreamingParser parser(&handler);
+    for(auto& e: fixed_json) { parser.parse(e); }
+    EXPECT_FALSE(parser.hasError());
+
+    // Truncated
+    EXPECT_STREQ(handler.name, "ABCDEFG");
+    EXPECT_STREQ(handler.kanji, "漢字"); // Not broken UTF-8
+    EXPECT_STREQ(handler.names[0], "alpha");
+    EXPECT_STREQ(handler.names[1], "bravo");
+    EXPECT_STREQ(handler.names[2], "charl");
+    // Clamped
+    EXPECT_EQ(handler.i8[0], 127);
+    EXPECT_EQ(handler.i8[1], 127);
+    EXPECT_EQ(handler.i8[2], -128);
+    EXPECT_EQ(handler.i8[3], -128);
+    EXPECT_EQ(handler.u8[0], 255);
+    EXPECT_EQ(handler.u8[1], 0);
+    EXPECT_EQ(handler.u8[2], 255);
+    EXPECT_EQ(handler.u8[3], 0);
+    EXPECT_EQ(handler.i64, INT64_MIN);
+    EXPECT_EQ(handler.u64, UINT64_MAX);
+    EXPECT_TRUE(handler.flag);
+    EXPECT_FLOAT_EQ(handler.fp, 1.25f);
+
+    // Float out of range is clamped
+    {
+        FixedHandler handler;
+        goblib::json::StreamingParser parser(&handler);
+        const char json[] = R"({"i8":[1e30,-1e30,-3.5,12.9],"u8":[-3.5,1e300,255.9,-0.5],"i64":1e300,"u64":-1e300})";
+        parser.parse(json, sizeof(json) - 1);
+        EXPECT_FALSE(parser.hasError());
+        EXPECT_EQ(handler.i8[0], 127);
+        EXPECT_EQ(handler.i8[1], -128);
+        EXPECT_EQ(handler.i8[2], -3);
+        EXPECT_EQ(handler.i8[3], 12);
+        EXPECT_EQ(handler.u8[0], 0);
+        EXPECT_EQ(handler.u8[1], 255);
+        EXPECT_EQ(handler.u8[2], 255);
+        EXPECT_EQ(handler.u8[3], 0);
+        EXPECT_EQ(handler.i64, INT64_MAX);
+        EXPECT_EQ(handler.u64, 0U);
+    }
+
+    // Write
+    Element<decltype(handler.name)>  e_name  { "name",  &handler.name };
+    Element<decltype(handler.names)> e_names { "names", &handler.names };
+    char out[128];
+    goblib::json::FixedBufferSink sink(out, sizeof(out));
+    goblib::json::StreamingWriter writer(&sink);
+    goblib::json::writeObject(writer, e_name, e_names);
+    EXPECT_TRUE(writer.flush());
+    EXPECT_STREQ(out, R"({"name":"ABCDEFG","names":["alpha","bravo","charl"]})");
 }
@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+
+#include "gob_json_test_helper.hpp"
+#include <gob_json.hpp>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <algorithm>
+
+using gob_json_test::LogHandler;
+using goblib::json::ElementPath;
+using goblib::json::ElementValue;
+using goblib::json::StreamingParser;
+
+// TEST(Escape, Chunk)
+namespace
+{
+
+struct Result
+{
+    std::vector<std::string> log;
+    bool error{};
+#if GOB_JSON_STATS
+    goblib::json::ParserStats stats{};
+#endif
+};
+
+// Parse by the chunk, 0 means a character at a time
+Result parse(const std::string& json, const size_t chunk, const bool check = false)
+{
+    LogHandler lh;
+    StreamingParser parser(&lh);
+    parser.setValidateUtf8(check);
+    gob_json_test::feed(parser, json, chunk);
+    Result r;
+    r.log = lh.log;
+    r.error = parser.hasError();
+#if GOB_JSON_STATS
+    r.stats = parser.getStats();
+#endif
+    return r;
+}
+
+void expectSame(const Result& a, const Result& b)
+{
+    EXPECT_EQ(a.log, b.log);
+    EXPECT_EQ(a.error, b.error);
+#if GOB_JSON_STATS
+    for(size_t i = 0; i < goblib::json::ParserStats::STATE_MAX; ++i) { EXPECT_EQ(a.stats.bytes[i], b.stats.bytes[i]) << i; }
+    EXPECT_EQ(a.stats.truncatedTokens, b.stats.truncatedTokens);
+    EXPECT_EQ(a.stats.bufferHighWater, b.stats.bufferHighWater);
+#endif
+}
+
+// Text as \uXXXX (ASCII-only encoders)
+std::string escapeAll(const char32_t* s)
+{
+    std::string out;
+    char tmp[16];
+    for(; *s; ++s)
+    {
+        uint32_t cp = *s;
+        if(cp >= 0x10000)
+        {
+            cp -= 0x10000;
+            snprintf(tmp, sizeof(tmp), "\\u%04X", (unsigned)(0xD800 + (cp >> 10)));
+            out += tmp;
+            cp = 0xDC00 + (cp & 0x3FF);
+        }
+        snprintf(tmp, sizeof(tmp), "\\u%04x", (unsigned)cp);
+        out += tmp;
+    }
+    return out;
+}
+//
+}
+
+TEST(Escape, Chunk)
+{
+    const std::string text = escapeAll(U"吾輩は猫である。名前はまだ無い。\U0001F431\U00020B9F");
+    std::string longText;
+    while(longText.size() < GOB_JSON_PARSER_BUFFER_MAX_LENGTH * 2) { longText += text; }
+
+    const std::string json = "{\"" + escapeAll(U"名前") + "\":\"" + text + "\",\"long\":\"" + longText + "\"," +
+            R"("simple":"\"\\\/\b\f\n\r\t","mixed":"a\u3042b\n\uD83D\uDE00c\u0041",)" +
+            R"("lone_low":"\uDC00x","not_pair":"\uD83D\u0041","cesu":"\uD800\uDC00","upper":"\u00E9\u00e9",)" +
+            R"("s":"\ud867\ude3d\ud840\udc0b\ud842\udfb7\ud853\udd14","n":[1,2]})";
+
+    const auto expected = parse(json, 0);
+    ASSERT_FALSE(expected.error);
+    for(size_t chunk : { (size_t)1, (size_t)2, (size_t)5, (size_t)6, (size_t)7, (size_t)11, (size_t)12, (size_t)13, (size_t)64, json.size() })
+    {
+        SCOPED_TRACE(chunk);
+        expectSame(parse(json, chunk), expected);
+    }
+    // Decoded as UTF-8
+    EXPECT_NE(std::find(expected.log.begin(), expected.log.end(),
+                        "V mixed=a\xE3\x81\x82" "b\n\xF0\x9F\x98\x80" "cA"), expected.log.end());
+
+    // Errors are the same as a character at a time
+    const std::string bad[] = {
+        R"({"a":"\u12G4"})", R"({"a":"\x"})", R"({"a":"\uD83D\x0041"})", R"({"a":"\uD83D\uDE0G"})",
+        "{\"a\":\"\xE3\x81\\u3042\"}", // Truncated UTF-8 before the escape
+    };
+    for(auto& b : bad)
+    {
+        SCOPED_TRACE(b);
+        for(bool check : { false, true })
+        {
+            const auto e = parse(b, 0, check);
+            for(size_t chunk : { (size_t)1, (size_t)6, b.size() }) { expectSame(parse(b, chunk, check), e); }
+        }
+    }
+    EXPECT_TRUE(parse(bad[0], bad[0].size()).error);
+    EXPECT_TRUE(parse(bad[4], bad[4].size(), true).error);
+}
@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+
+#include "gob_json_test_helper.hpp"
+#include <gob_json.hpp>
+#include <gob_json_formatter.hpp>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+using gob_json_test::LogHandler;
+using goblib::json::ElementPath;
+using goblib::json::ElementValue;
+using goblib::json::FormatStyle;
+using goblib::json::StreamingFormatter;
+
+// TEST(Formatter, Minify)
+namespace
+{
+const char pretty_json[] =
+R"({
+  "name": "a b\tc \"quoted\" \\ あ",
+  "empty": {},
+  "list": [],
+  "nums": [
+    -1.5e+10,
+    0,
+    123456789012345678901234567890
+  ],
+  "nested": {
+    "t": true,
+    "f": false,
+    "n": null,
+    "deep": [
+      {
+        "k": [
+          [
+            "x"
+          ]
+        ]
+      }
+    ]
+  }
+})";
+
+const char minified_json[] =
+R"({"name":"a b\tc \"quoted\" \\ あ","empty":{},"list":[],"nums":[-1.5e+10,0,123456789012345678901234567890],"nested":{"t":true,"f":false,"n":null,"deep":[{"k":[["x"]]}]}})";
+
+struct StringSink : public goblib::json::Sink
+{
+    virtual bool write(const char* buf, size_t len) override { s.append(buf, len); ++writes; return true; }
+    std::string s;
+    size_t writes{};
+};
+
+// Format by the chunk, 0 means a character at a time
+std::string format(const std::string& json, const FormatStyle style, const size_t chunk = 0, bool* error = nullptr, const uint8_t indent = 2)
+{
+    StringSink sink;
+    StreamingFormatter fmt(style, &sink, indent);
+    gob_json_test::feed(fmt, json, chunk);
+    fmt.flush();
+    if(error) { *error = fmt.hasError(); }
+    else { EXPECT_FALSE(fmt.hasError()); }
+    if(!fmt.hasError()) { EXPECT_EQ(fmt.getWrittenSize(), sink.s.size()); }
+    return sink.s;
+}
+
+std::vector<std::string> events(const std::string& json)
+{
+    LogHandler lh;
+    goblib::json::StreamingParser parser(&lh);
+    parser.parse(json.data(), json.size());
+    EXPECT_FALSE(parser.hasError());
+    return lh.log;
+}
+//
+}
+
+TEST(Formatter, Minify)
+{
+    for(size_t chunk : { (size_t)0, (size_t)1, (size_t)3, (size_t)7, sizeof(pretty_json) })
+    {
+        SCOPED_TRACE(chunk);
+        EXPECT_EQ(format(pretty_json, FormatStyle::Minify, chunk), minified_json);
+        EXPECT_EQ(format(minified_json, FormatStyle::Minify, chunk), minified_json);
+    }
+    EXPECT_EQ(events(minified_json), events(pretty_json));
+
+    // Multiple documents
+    EXPECT_EQ(format(" {} [ 1 ,2 ] 3\n\"s\" true ", FormatStyle::Minify), "{}\n[1,2]\n3\n\"s\"\ntrue");
+
+    // Long string passes through
+    const std::string longText(GOB_JSON_FORMATTER_BUFFER_LENGTH * 3, 'x');
+    const std::string json = "[ \"" + longText + "\" , 1 ]";
+    EXPECT_EQ(format(json, FormatStyle::Minify, json.size()), "[\"" + longText + "\",1]");
+}
+
+TEST(Formatter, Pretty)
+{
+    for(size_t chunk : { (size_t)0, (size_t)1, (size_t)3, (size_t)7, sizeof(minified_json) })
+    {
+        SCOPED_TRACE(chunk);
+        EXPECT_EQ(format(minified_json, FormatStyle::Pretty, chunk), pretty_json);
+        EXPECT_EQ(format(pretty_json, FormatStyle::Pretty, chunk), pretty_json);
+    }
+    EXPECT_EQ(format("[1,[2]]", FormatStyle::Pretty, 0, nullptr, 4), "[\n    1,\n    [\n        2\n    ]\n]");
+    EXPECT_EQ(format("{}[]", FormatStyle::Pretty), "{}\n[]");
+}
+
+TEST(Formatter, Error)
+{
+    const char* bad[] = { "[1}", "{]", "]", "[[]]]" };
+    for(auto b : bad)
+    {
+        SCOPED_TRACE(b);
+        bool error{};
+        format(b, FormatStyle::Minify, 0, &error);
+        EXPECT_TRUE(error);
+    }
+    bool error{};
+    format(std::string(GOB_JSON_PARSER_STACK_MAX_DEPTH + 1, '['), FormatStyle::Pretty, 0, &error);
+    EXPECT_TRUE(error);
+
+    // Sink is full
+    char buf[16];
+    goblib::json::FixedBufferSink sink(buf, sizeof(buf));
+    StreamingFormatter fmt(FormatStyle::Minify, &sink);
+    fmt.parse(minified_json, sizeof(minified_json) - 1);
+    EXPECT_TRUE(fmt.hasError());
+    fmt.reset();
+    sink.clear();
+    fmt.parse("[ 1 ]", 5);
+    EXPECT_FALSE(fmt.hasError());
+    EXPECT_STREQ(buf, "[1]");
+}
+
+TEST(Formatter, Whitespace)
+{
+    LogHandler lh;
+    goblib::json::StreamingParser parser(&lh);
+    parser.parse(pretty_json, sizeof(pretty_json) - 1);
+    EXPECT_TRUE(lh.ws.empty());
+
+    // Whitespace outside strings
+    const char json[] = "{ \"a b\" :\t[1 , 2\r\n] }";
+    parser.reset();
+    parser.setEmitWhitespace(true);
+    parser.parse(json, sizeof(json) - 1);
+    EXPECT_FALSE(parser.hasError());
+    EXPECT_EQ(lh.ws, "  \t  \r\n ");
+}
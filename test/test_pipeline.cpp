@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+
+#include <gob_json.hpp>
+#include <gob_json_pipeline_handler.hpp>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+
+using goblib::json::ElementPath;
+using goblib::json::ElementValue;
+
+// TEST(Pipeline, Replay)
+namespace
+{
+const char pipeline_json[] =
+R"***(
+{
+  "name": "pipeline",
+  "nested": { "a": { "b": [1, -2, 3.5, 1e3, "str", true, false, null] } },
+  "records": [
+    { "id": 18446744073709551615, "tags": ["x", "y"], "price": 0.1 },
+    { "id": 2, "tags": [], "price": -12.75, "name": "漢字カナまじり" },
+    [[[]], {}, [{"deep": {"deeper": [0]}}]]
+  ],
+  "last": "end"
+}
+)***";
+
+// Records all events as text
+struct RecordingHandler : public goblib::json::Handler
+{
+    explicit RecordingHandler(const int slowEvery = 0) : slow(slowEvery) {}
+
+    virtual void startDocument() override { add("SD", nullptr); }
+    virtual void endDocument() override { add("ED", nullptr); }
+    virtual void startObject(const ElementPath& path) override { add("SO", &path); }
+    virtual void endObject(const ElementPath& path) override { add("EO", &path); }
+    virtual void startArray(const ElementPath& path) override { add("SA", &path); }
+    virtual void endArray(const ElementPath& path) override { add("EA", &path); }
+    virtual void whitespace(const char ch) override { add(std::string("W") + ch, nullptr); }
+    virtual void value(const ElementPath& path, const ElementValue& v) override
+    {
+        std::string s = "V" + std::to_string((int)v.getType()) + ":";
+        if(v.hasRaw()) { s += std::string(v.getRaw(), v.getRawLength()) + "/" + std::to_string(v.getNumberFlags()); }
+        else if(v.isString()) { s += v.getString(); }
+        else if(v.isBool()) { s += v.getBool() ? "true" : "false"; }
+        add(s, &path);
+    }
+
+    void add(const std::string& s, const ElementPath* path)
+    {
+        events.push_back(s + (path ? " " + path->toString() + "#" + std::to_string(path->getCount()) : std::string()));
+        if(slow && (events.size() % slow) == 0) { std::this_thread::sleep_for(std::chrono::microseconds(200)); }
+    }
+    std::vector<std::string> events;
+    int slow{};
+};
+//
+}
+
+TEST(Pipeline, Replay)
+{
+    RecordingHandler direct;
+    {
+        goblib::json::StreamingParser parser(&direct);
+        for(auto& c : pipeline_json) { parser.parse(c); }
+        EXPECT_FALSE(parser.hasError());
+    }
+
+    // Minimum capacity and slow handler to exercise wrap and backpressure.
+    RecordingHandler target(3);
+    goblib::json::PipelineHandler pipe(&target, 1);
+    EXPECT_GT(pipe.capacity(), 1U);
+    goblib::json::StreamingParser parser(&pipe);
+    std::string json;
+    for(int i = 0; i < 20; ++i) { json += pipeline_json; }
+    parser.setRecursively(true);
+    parser.parse(json.c_str(), json.size());
+    EXPECT_FALSE(parser.hasError());
+    pipe.drain();
+
+    ASSERT_EQ(target.events.size(), direct.events.size() * 20);
+    for(size_t i = 0; i < target.events.size(); ++i)
+    {
+        EXPECT_EQ(target.events[i], direct.events[i % direct.events.size()]) << i;
+    }
+    EXPECT_GT(pipe.getStallCount(), 0U);
+
+    // Remaining events are handled by stop()
+    RecordingHandler target2;
+    {
+        goblib::json::PipelineHandler pipe2(&target2);
+        goblib::json::StreamingParser parser2(&pipe2);
+        for(auto& c : pipeline_json) { parser2.parse(c); }
+    }
+    EXPECT_EQ(target2.events, direct.events);
+}
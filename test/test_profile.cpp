@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+
+#include <gob_json_profile_handler.hpp>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using goblib::json::ElementPath;
+using goblib::json::ElementValue;
+using goblib::json::ProfileHandler;
+
+// TEST(Profile, Attribution)
+namespace
+{
+constexpr int STATUSES = 20;
+constexpr int URLS = 8;
+
+std::string makeFeed()
+{
+    std::string s(R"({"meta":{"count":20},"statuses":[)");
+    for(int i = 0; i < STATUSES; ++i)
+    {
+        s += i ? "," : "";
+        s += R"({"id":)" + std::to_string(i) + R"(,"text":"hello","user":{"name":"user)" + std::to_string(i) + R"(","entities":{"urls":[)";
+        for(int u = 0; u < URLS; ++u) { s += (u ? "," : "") + std::string(R"("https://example.com/some/long/path/)") + std::to_string(u) + "\""; }
+        s += "]}}}";
+    }
+    s += "]}";
+    return s;
+}
+
+// Heavy work on the urls.
+struct FeedHandler : public goblib::json::Handler
+{
+    virtual void startDocument() override { ++events; }
+    virtual void endDocument() override { ++events; }
+    virtual void startObject(const ElementPath& ) override { ++events; }
+    virtual void endObject(const ElementPath& ) override { ++events; }
+    virtual void startArray(const ElementPath& ) override { ++events; }
+    virtual void endArray(const ElementPath& ) override { ++events; }
+    virtual void whitespace(const char) override {}
+    virtual void value(const ElementPath& path, const ElementValue& v) override
+    {
+        ++events;
+        if(path.match("statuses[*].user.entities.urls[*]"))
+        {
+            for(int i = 0; i < 2000; ++i) { hash = hash * 31 + v.getString()[i % 8]; }
+        }
+    }
+    int events{};
+    volatile uint32_t hash{};
+};
+//
+}
+
+TEST(Profile, Attribution)
+{
+    const std::string json = makeFeed();
+    FeedHandler handler;
+    goblib::json::StreamingParser parser;
+    ProfileHandler prof(&handler, &parser);
+    parser.setHandler(&prof);
+    parser.parse(json.data(), json.size());
+    EXPECT_FALSE(parser.hasError());
+
+    // All events passed to the target
+    FeedHandler plain;
+    goblib::json::StreamingParser plainParser(&plain);
+    plainParser.parse(json.data(), json.size());
+    EXPECT_EQ(handler.events, plain.events);
+
+    // Indices collapsed
+    auto urls = prof.find("statuses[*].user.entities.urls[*]");
+    ASSERT_NE(urls, nullptr);
+    EXPECT_EQ(urls->values, (uint32_t)(STATUSES * URLS));
+    EXPECT_EQ(urls->events, (uint32_t)(STATUSES * URLS));
+    EXPECT_GT(urls->handlerTicks, 0U);
+    auto texts = prof.find("statuses[*].text");
+    ASSERT_NE(texts, nullptr);
+    EXPECT_EQ(texts->values, (uint32_t)STATUSES);
+    EXPECT_EQ(prof.find("statuses[0].text"), nullptr);
+    EXPECT_LT(prof.size(), (size_t)GOB_JSON_PROFILE_MAX_PATHS);
+
+    // Inclusive
+    prof.summarize();
+    auto root = prof.find("");
+    auto user = prof.find("statuses[*].user");
+    auto entities = prof.find("statuses[*].user.entities");
+    ASSERT_NE(root, nullptr);
+    ASSERT_NE(user, nullptr);
+    ASSERT_NE(entities, nullptr);
+    EXPECT_EQ(root->events, 2U + 2U); // start/end of document and root object
+    EXPECT_GE(root->totalBytes + 1, (uint64_t)json.size()); // Last '}' is counted after the event
+    EXPECT_LE(root->totalBytes, (uint64_t)json.size());
+    EXPECT_GT(user->totalBytes, entities->totalBytes);
+    EXPECT_GT(entities->totalBytes, urls->bytes);
+    EXPECT_GT(entities->totalBytes, json.size() / 2); // Most of the feed
+    EXPECT_GE(entities->totalTicks, urls->parseTicks + urls->handlerTicks);
+    EXPECT_GT(entities->totalTicks, texts->totalTicks);
+
+    // Report sorted by inclusive ticks
+    std::vector<std::string> lines;
+    prof.dump([](const char* line, void* arg) { static_cast<std::vector<std::string>*>(arg)->push_back(line); }, &lines);
+    ASSERT_EQ(lines.size(), prof.size() + 1); // With header
+    EXPECT_NE(lines[1].find("(root)"), std::string::npos);
+    auto indexOf = [&lines](const char* pattern)
+    {
+        for(size_t i = 1; i < lines.size(); ++i)
+        {
+            auto pos = lines[i].rfind("  ");
+            if(pos != std::string::npos && lines[i].substr(pos + 2) == pattern) { return (int)i; }
+        }
+        return -1;
+    };
+    EXPECT_GT(indexOf("statuses[*].user.entities"), 0);
+    EXPECT_LT(indexOf("statuses[*].user.entities"), indexOf("statuses[*].text"));
+    EXPECT_LT(indexOf("statuses[*].user"), indexOf("statuses[*].user.entities"));
+
+    // Reset
+    prof.clear();
+    EXPECT_EQ(prof.size(), 0U);
+    parser.reset();
+    parser.parse(json.data(), json.size());
+    ASSERT_NE(prof.find("meta.count"), nullptr);
+    EXPECT_EQ(prof.find("meta.count")->values, 1U);
+}
+
+TEST(Profile, Pattern)
+{
+    struct PatternHandler : public FeedHandler
+    {
+        virtual void value(const ElementPath& path, const ElementValue& ) override
+        {
+            char buf[16];
+            auto len = path.toPattern(buf, sizeof(buf));
+            patterns.push_back(std::string(buf) + ":" + std::to_string(len));
+        }
+        std::vector<std::string> patterns;
+    };
+    PatternHandler handler;
+    goblib::json::StreamingParser parser(&handler);
+    const char json[] = R"({"a":[[1],{"b":2}],"long_key_name_over":3})";
+    parser.parse(json, sizeof(json) - 1);
+    ASSERT_EQ(handler.patterns.size(), 3U);
+    EXPECT_EQ(handler.patterns[0], "a[*][*]:7");
+    EXPECT_EQ(handler.patterns[1], "a[*].b:6");
+    EXPECT_EQ(handler.patterns[2], "long_key_name_o:15"); // Truncated
+}
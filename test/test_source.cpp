@@ -0,0 +1,226 @@
+#include <gtest/gtest.h>
+
+#include <gob_json.hpp>
+#include <gob_json_file_source.hpp>
+#include <gob_json_read_ahead.hpp>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(ARDUINO)
+#include <unistd.h>
+
+using goblib::json::ElementPath;
+using goblib::json::ElementValue;
+
+namespace
+{
+struct SumHandler : public goblib::json::Handler
+{
+    virtual void startDocument() override {}
+    virtual void endDocument() override { ++documents; }
+    virtual void startObject(const ElementPath& ) override {}
+    virtual void endObject(const ElementPath& ) override {}
+    virtual void startArray(const ElementPath& ) override {}
+    virtual void endArray(const ElementPath& ) override {}
+    virtual void whitespace(const char/*ch*/) override {}
+    virtual void value(const ElementPath& , const ElementValue& v) override
+    {
+        if(v.isInt()) { sum += v.getInt(); ++count; }
+    }
+    uint64_t sum{};
+    int count{}, documents{};
+};
+
+// {"values":[0,1,...,n-1]} and its sum
+std::string makeArrayJson(const int n, uint64_t& sum)
+{
+    std::string s = R"({"values":[)";
+    sum = 0;
+    for(int i = 0; i < n; ++i)
+    {
+        s += (i ? "," : "") + std::to_string(i);
+        sum += i;
+    }
+    s += "]}";
+    return s;
+}
+
+std::string writeTempFile(const std::string& data)
+{
+    char path[] = "/tmp/gob_json_testXXXXXX";
+    int fd = mkstemp(path);
+    if(fd < 0) { return std::string(); }
+    auto r = write(fd, data.data(), data.size());
+    close(fd);
+    return r == (ssize_t)data.size() ? std::string(path) : std::string();
+}
+//
+}
+
+// TEST(Source, MappedFile)
+TEST(Source, MappedFile)
+{
+    uint64_t sum{};
+    auto json = makeArrayJson(5000, sum); // Larger than a page
+    auto path = writeTempFile(json);
+    ASSERT_FALSE(path.empty());
+
+    // Small window that splits numbers across windows.
+    goblib::json::MappedFileSource src(1);
+    EXPECT_EQ(src.getWindowSize(), (size_t)sysconf(_SC_PAGESIZE));
+    ASSERT_TRUE(src.open(path.c_str()));
+    EXPECT_EQ(src.size(), json.size());
+    EXPECT_GT(src.size(), src.getWindowSize() * 2);
+
+    SumHandler handler;
+    goblib::json::StreamingParser parser(&handler);
+    EXPECT_TRUE(src.parse(parser));
+    EXPECT_EQ(handler.count, 5000);
+    EXPECT_EQ(handler.sum, sum);
+    EXPECT_EQ(handler.documents, 1);
+
+    // Default window
+    {
+        goblib::json::MappedFileSource src2;
+        src2.setHugePages(true);
+        SumHandler handler2;
+        goblib::json::StreamingParser parser2(&handler2);
+        ASSERT_TRUE(src2.open(path.c_str()));
+        EXPECT_TRUE(src2.parse(parser2));
+        EXPECT_EQ(handler2.sum, sum);
+    }
+    src.close();
+    EXPECT_FALSE(src.isOpen());
+    EXPECT_FALSE(src.parse(parser));
+    unlink(path.c_str());
+
+    EXPECT_FALSE(src.open("/tmp/gob_json_not_exists/not_exists.json"));
+
+    // Empty file
+    auto empty = writeTempFile("");
+    ASSERT_FALSE(empty.empty());
+    EXPECT_TRUE(src.open(empty.c_str()));
+    parser.reset();
+    EXPECT_TRUE(src.parse(parser));
+    unlink(empty.c_str());
+}
+
+// TEST(Source, ReadAhead)
+namespace
+{
+// Throttled reader over memory
+struct SlowReader
+{
+    const std::string* data;
+    size_t pos;
+    size_t maxLen;
+    static ssize_t read(void* arg, char* buf, size_t len)
+    {
+        auto self = static_cast<SlowReader*>(arg);
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+        len = std::min(std::min(len, self->maxLen), self->data->size() - self->pos);
+        std::memcpy(buf, self->data->data() + self->pos, len);
+        self->pos += len;
+        return static_cast<ssize_t>(len);
+    }
+};
+ssize_t failRead(void*, char*, size_t) { return -1; }
+//
+}
+
+TEST(Source, ReadAhead)
+{
+    uint64_t sum{};
+    auto json = makeArrayJson(3000, sum);
+
+    // Pipe with the throttled writer
+    {
+        int fds[2];
+        ASSERT_EQ(pipe(fds), 0);
+        std::thread writer([&json, &fds]()
+        {
+            for(size_t pos = 0; pos < json.size(); pos += 100)
+            {
+                auto len = std::min<size_t>(100, json.size() - pos);
+                EXPECT_EQ(write(fds[1], json.data() + pos, len), (ssize_t)len);
+                std::this_thread::sleep_for(std::chrono::microseconds(20));
+            }
+            close(fds[1]);
+        });
+        SumHandler handler;
+        goblib::json::StreamingParser parser(&handler);
+        goblib::json::ReadAheadSource src(fds[0], 256, 2);
+        EXPECT_TRUE(src.parse(parser));
+        writer.join();
+        close(fds[0]);
+        EXPECT_FALSE(src.hasError());
+        EXPECT_EQ(src.getReadSize(), json.size());
+        EXPECT_EQ(handler.count, 3000);
+        EXPECT_EQ(handler.sum, sum);
+        EXPECT_EQ(handler.documents, 1);
+    }
+    // Throttled reader, consume chunks in place
+    {
+        SlowReader sr{&json, 0, 37};
+        goblib::json::ReadAheadSource src(SlowReader::read, &sr, 64, 3);
+        EXPECT_TRUE(src.start());
+        std::string out;
+        size_t len{};
+        while(auto p = src.acquire(len))
+        {
+            EXPECT_LE(len, 37U);
+            out.append(p, len);
+            src.release();
+        }
+        EXPECT_EQ(out, json);
+    }
+    // Parse error stops the reader
+    {
+        std::string broken = "{\"values\":[1,2,}" + json;
+        SlowReader sr{&broken, 0, 8};
+        SumHandler handler;
+        goblib::json::StreamingParser parser(&handler);
+        goblib::json::ReadAheadSource src(SlowReader::read, &sr, 16, 4);
+        EXPECT_FALSE(src.parse(parser));
+        EXPECT_TRUE(parser.hasError());
+        EXPECT_LT(src.getReadSize(), broken.size());
+    }
+    // Parse error while the writer keeps the pipe open
+    {
+        int fds[2];
+        ASSERT_EQ(pipe(fds), 0);
+        ASSERT_EQ(write(fds[1], "[1,}", 4), 4);
+        std::atomic<bool> done{false}, timedOut{false};
+        std::thread watchdog([&]()
+        {
+            // Closing the writer unblocks a reader that is not interruptible
+            for(int i = 0; i < 500 && !done; ++i) { std::this_thread::sleep_for(std::chrono::milliseconds(10)); }
+            if(!done) { timedOut = true; close(fds[1]); }
+        });
+        SumHandler handler;
+        goblib::json::StreamingParser parser(&handler);
+        goblib::json::ReadAheadSource src(fds[0], 256, 2);
+        EXPECT_FALSE(src.parse(parser));
+        done = true;
+        watchdog.join();
+        EXPECT_FALSE(timedOut);
+        EXPECT_TRUE(parser.hasError());
+        if(!timedOut) { close(fds[1]); }
+        close(fds[0]);
+    }
+    // Read error
+    {
+        SumHandler handler;
+        goblib::json::StreamingParser parser(&handler);
+        goblib::json::ReadAheadSource src(failRead, nullptr);
+        EXPECT_FALSE(src.parse(parser));
+        EXPECT_TRUE(src.hasError());
+    }
+}
+
+#endif
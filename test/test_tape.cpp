@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+
+#include "gob_json_test_helper.hpp"
+#include <gob_json_tape.hpp>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+using goblib::json::ElementPath;
+using goblib::json::ElementValue;
+using goblib::json::TapeRecorder;
+using goblib::json::TapePlayer;
+
+// TEST(Tape, Replay)
+namespace
+{
+const char tape_json[] =
+R"***({"name":"tape","id":-42,"big":18446744073709551615,"price":0.125,"exp":-1.5e-3,
+"flags":[true,false,null],"nested":{"a":[[1,2],[3,{"b":"あ\"q\""}]],"c":{}},
+"items":[{"id":1,"name":"x"},{"id":2,"name":"y"},{"id":3,"name":"z"}]}
+[1,"second document"])***";
+
+// Typed values with the raw text of numbers
+struct TapeLog : public gob_json_test::LogHandler { TapeLog() : LogHandler(Value::TypedRaw) {} };
+
+std::vector<std::string> stripRaw(std::vector<std::string> v)
+{
+    for(auto& s : v) { auto pos = s.find(" raw:"); if(pos != std::string::npos) { s.erase(pos); } }
+    return v;
+}
+//
+}
+
+TEST(Tape, Replay)
+{
+    // Direct
+    TapeLog direct;
+    {
+        goblib::json::StreamingParser parser(&direct);
+        parser.setRecursively(true);
+        parser.parse(tape_json, sizeof(tape_json) - 1);
+        EXPECT_FALSE(parser.hasError());
+    }
+
+    // Record with raw numbers
+    TapeRecorder rec;
+    {
+        goblib::json::StreamingParser parser(&rec);
+        parser.setRecursively(true);
+        parser.parse(tape_json, sizeof(tape_json) - 1);
+        EXPECT_FALSE(parser.hasError());
+    }
+    EXPECT_EQ(rec.keys(), 11U); // name id big price exp flags nested a b c items
+
+    // Replay many times
+    TapePlayer player;
+    player.set(rec.data(), rec.size());
+    for(int i = 0; i < 2; ++i)
+    {
+        TapeLog replayed;
+        EXPECT_TRUE(player.replay(replayed));
+        EXPECT_FALSE(player.hasError());
+        EXPECT_EQ(replayed.log, direct.log);
+    }
+
+    // Converted numbers
+    TapeRecorder conv(true);
+    {
+        goblib::json::StreamingParser parser(&conv);
+        parser.setRecursively(true);
+        parser.parse(tape_json, sizeof(tape_json) - 1);
+    }
+    TapeLog converted;
+    player.set(conv.data(), conv.size());
+    EXPECT_TRUE(player.replay(converted));
+    EXPECT_EQ(converted.log, stripRaw(direct.log));
+    EXPECT_EQ(converted.log[4], "V big=i-1"); // Same bits as uintmax_t max
+
+    // File
+    char tmp[] = "/tmp/gob_json_tapeXXXXXX";
+    int fd = mkstemp(tmp);
+    ASSERT_GE(fd, 0);
+    close(fd);
+    ASSERT_TRUE(rec.save(tmp));
+    {
+        TapePlayer fp;
+        ASSERT_TRUE(fp.open(tmp));
+        EXPECT_EQ(fp.size(), rec.size());
+        TapeLog mapped;
+        EXPECT_TRUE(fp.replay(mapped));
+        EXPECT_EQ(mapped.log, direct.log);
+    }
+    unlink(tmp);
+
+    // Broken
+    std::vector<uint8_t> broken(rec.data(), rec.data() + rec.size());
+    broken.resize(broken.size() / 2);
+    TapeLog partial;
+    player.set(broken.data(), broken.size());
+    EXPECT_FALSE(player.replay(partial));
+    EXPECT_TRUE(player.hasError());
+    EXPECT_LT(partial.log.size(), direct.log.size());
+
+    const uint8_t notTape[] = "{}";
+    player.set(notTape, sizeof(notTape));
+    EXPECT_FALSE(player.replay(partial));
+
+    // Keys are stored once, smaller than the text for repeated records.
+    std::string records("[");
+    for(int i = 0; i < 100; ++i)
+    {
+        records += (i ? "," : "") + std::string(R"({"identifier":)") + std::to_string(i) +
+                R"(,"description":"record","enabled":true,"coordinates":[1.5,2.5]})";
+    }
+    records += "]";
+    rec.clear();
+    {
+        goblib::json::StreamingParser parser(&rec);
+        parser.parse(records.data(), records.size());
+        EXPECT_FALSE(parser.hasError());
+    }
+    EXPECT_EQ(rec.keys(), 4U);
+    EXPECT_LT(rec.size(), records.size() * 3 / 4);
+
+    // Clear
+    rec.clear();
+    EXPECT_EQ(rec.keys(), 0U);
+    TapeLog empty;
+    player.set(rec.data(), rec.size());
+    EXPECT_TRUE(player.replay(empty));
+    EXPECT_TRUE(empty.log.empty());
+}
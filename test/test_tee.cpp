@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+
+#include "gob_json_test_helper.hpp"
+#include <gob_json.hpp>
+#include <gob_json_tee_handler.hpp>
+#include <string>
+#include <vector>
+
+using gob_json_test::LogHandler;
+using goblib::json::ElementPath;
+using goblib::json::ElementValue;
+using goblib::json::TeeHandler;
+
+// TEST(Tee, Runtime)
+namespace
+{
+const char tee_json[] = R"({"name":"tee","nested":{"a":[1,2,{"b":3}],"c":"x"},"list":[10,20,30],"last":true})";
+
+// Also keeps the address of the path
+struct PathLog : public LogHandler
+{
+    virtual void startObject(const ElementPath& path) override { paths.push_back(&path); LogHandler::startObject(path); }
+    virtual void value(const ElementPath& path, const ElementValue& v) override { paths.push_back(&path); LogHandler::value(path, v); }
+    std::vector<const ElementPath*> paths;
+};
+
+// Skips "nested" object and the rest of "list" after the first element.
+template<class Tee> struct SkipHandler : public PathLog
+{
+    virtual void startObject(const ElementPath& path) override
+    {
+        PathLog::startObject(path);
+        if(path.match("nested")) { tee->skip(index); }
+    }
+    virtual void value(const ElementPath& path, const ElementValue& v) override
+    {
+        PathLog::value(path, v);
+        if(path.match("list[0]")) { tee->skip(index); }
+    }
+    Tee* tee{};
+    size_t index{};
+};
+
+std::vector<std::string> parse(goblib::json::Handler* h)
+{
+    LogHandler direct;
+    goblib::json::StreamingParser parser(h ? h : &direct);
+    parser.parse(tee_json, sizeof(tee_json) - 1);
+    EXPECT_FALSE(parser.hasError());
+    return direct.log;
+}
+
+const std::vector<std::string> skipped_log = {
+    "SD", "SO ", "V name=tee", "SO nested", "EO nested", "SA list", "V list[0]=10", "EA list", "V last=true", "EO ", "ED" };
+//
+}
+
+TEST(Tee, Runtime)
+{
+    const auto direct = parse(nullptr);
+
+    TeeHandler tee;
+    PathLog a, b;
+    SkipHandler<TeeHandler> s;
+    EXPECT_TRUE(tee.add(&a));
+    EXPECT_TRUE(tee.add(&s));
+    EXPECT_TRUE(tee.add(&b));
+    EXPECT_FALSE(tee.add(nullptr));
+    s.tee = &tee;
+    s.index = tee.indexOf(&s);
+    EXPECT_EQ(s.index, 1U);
+    EXPECT_EQ(tee.size(), 3U);
+
+    parse(&tee);
+    EXPECT_EQ(a.log, direct);
+    EXPECT_EQ(b.log, direct);
+    EXPECT_EQ(s.log, skipped_log);
+    EXPECT_FALSE(tee.isSkipping(1));
+    EXPECT_EQ(tee.getDepth(), 0);
+
+    // Same path object, no copies
+    ASSERT_EQ(a.paths.size(), b.paths.size());
+    for(size_t i = 0; i < a.paths.size(); ++i) { EXPECT_EQ(a.paths[i], b.paths[i]); }
+
+    // Mute
+    a.log.clear();
+    b.log.clear();
+    tee.mute(0);
+    EXPECT_TRUE(tee.isMuted(0));
+    parse(&tee);
+    EXPECT_TRUE(a.log.empty());
+    EXPECT_EQ(b.log, direct);
+    tee.mute(0, false);
+
+    // Capacity
+    tee.clear();
+    EXPECT_EQ(tee.size(), 0U);
+    for(int i = 0; i < GOB_JSON_TEE_MAX_HANDLERS; ++i) { EXPECT_TRUE(tee.add(&a)); }
+    EXPECT_FALSE(tee.add(&b));
+}
+
+TEST(Tee, Static)
+{
+    const auto direct = parse(nullptr);
+
+    PathLog a;
+    using Skip = SkipHandler<goblib::json::TeeControl<2>>;
+    Skip s;
+    auto tee = goblib::json::makeTeeHandler(a, s);
+    static_assert(decltype(tee)::size() == 2, "Size");
+    s.tee = &tee;
+    s.index = 1;
+
+    parse(&tee);
+    EXPECT_EQ(a.log, direct);
+    EXPECT_EQ(s.log, skipped_log);
+}
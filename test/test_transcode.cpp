@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+
+#include "gob_json_test_helper.hpp"
+#include <gob_json.hpp>
+#include <gob_json_transcoder.hpp>
+#include <gob_json_binary_parser.hpp>
+#include <string>
+#include <vector>
+
+using goblib::json::BinaryFormat;
+using goblib::json::TranscodeHandler;
+using gob_json_test::VectorSink;
+
+// TEST(Transcode, CBOR)
+namespace
+{
+std::vector<uint8_t> transcode(const BinaryFormat format, const std::string& json, bool* error = nullptr)
+{
+    VectorSink sink;
+    TranscodeHandler th(format, &sink);
+    goblib::json::StreamingParser parser(&th);
+    parser.setRecursively(true);
+    parser.parse(json.data(), json.size());
+    EXPECT_FALSE(parser.hasError());
+    if(error) { *error = th.hasError(); }
+    else
+    {
+        EXPECT_FALSE(th.hasError());
+        EXPECT_EQ(th.getWrittenSize(), sink.out.size());
+    }
+    return sink.out;
+}
+
+std::string makeRecords(const int num)
+{
+    std::string s("[");
+    for(int i = 0; i < num; ++i)
+    {
+        s += (i ? "," : "") + std::string(R"({"id":)") + std::to_string(i * 1000) +
+                R"(,"name":"sensor","active":true,"value":-12.5})";
+    }
+    return s + "]";
+}
+
+const char small_json[] = R"({"a":[1,-2,3.5,"xy",true,null],"b":{}})";
+//
+}
+
+TEST(Transcode, CBOR)
+{
+    EXPECT_EQ(transcode(BinaryFormat::CBOR, small_json),
+              (std::vector<uint8_t>{ 0xA2, 0x61, 'a', 0x86, 0x01, 0x21, 0xFA, 0x40, 0x60, 0x00, 0x00,
+                          0x62, 'x', 'y', 0xF5, 0xF6, 0x61, 'b', 0xA0 }));
+
+    // Numbers
+    EXPECT_EQ(transcode(BinaryFormat::CBOR, "[24,-25,65536,18446744073709551615,-9223372036854775808,0.125,0.1]"),
+              (std::vector<uint8_t>{ 0x87, 0x18, 0x18, 0x38, 0x18, 0x1A, 0x00, 0x01, 0x00, 0x00,
+                          0x1B, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                          0x3B, 0x7F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                          0xFA, 0x3E, 0x00, 0x00, 0x00,
+                          0xFB, 0x3F, 0xB9, 0x99, 0x99, 0x99, 0x99, 0x99, 0x9A }));
+
+    // Sequence of documents
+    EXPECT_EQ(transcode(BinaryFormat::CBOR, "[] {}"), (std::vector<uint8_t>{ 0x80, 0xA0 }));
+
+    // Outer container flushed before closing is indefinite, inner ones definite.
+    const std::string records = makeRecords(200);
+    auto cbor = transcode(BinaryFormat::CBOR, records);
+    ASSERT_GT(records.size(), (size_t)GOB_JSON_TRANSCODER_BUFFER_LENGTH);
+    EXPECT_EQ(cbor.front(), 0x9F);
+    EXPECT_EQ(cbor.back(), 0xFF);
+    EXPECT_EQ(cbor[1], 0xA4);
+    EXPECT_LT(cbor.size(), records.size() * 7 / 10);
+}
+
+TEST(Transcode, MessagePack)
+{
+    EXPECT_EQ(transcode(BinaryFormat::MessagePack, small_json),
+              (std::vector<uint8_t>{ 0x82, 0xA1, 'a', 0x96, 0x01, 0xFE, 0xCA, 0x40, 0x60, 0x00, 0x00,
+                          0xA2, 'x', 'y', 0xC3, 0xC0, 0xA1, 'b', 0x80 }));
+
+    EXPECT_EQ(transcode(BinaryFormat::MessagePack, "[127,128,-33,-129,70000,18446744073709551615]"),
+              (std::vector<uint8_t>{ 0x96, 0x7F, 0xCC, 0x80, 0xD0, 0xDF, 0xD1, 0xFF, 0x7F,
+                          0xCE, 0x00, 0x01, 0x11, 0x70,
+                          0xCF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF }));
+
+    // array16 and str8
+    std::string json("[");
+    for(int i = 0; i < 20; ++i) { json += (i ? "," : "") + std::to_string(i); }
+    json += R"(,"0123456789012345678901234567890123456789"])";
+    auto mp = transcode(BinaryFormat::MessagePack, json);
+    ASSERT_GE(mp.size(), 3U + 20U + 2U + 40U);
+    EXPECT_EQ(mp[0], 0xDC);
+    EXPECT_EQ(mp[1], 0x00);
+    EXPECT_EQ(mp[2], 21);
+    EXPECT_EQ(mp[3 + 20], 0xD9);
+    EXPECT_EQ(mp[3 + 21], 40);
+    EXPECT_EQ(mp.size(), 3U + 20U + 2U + 40U);
+
+    const std::string records = makeRecords(5);
+    mp = transcode(BinaryFormat::MessagePack, records);
+    EXPECT_EQ(mp[0], 0x95);
+    EXPECT_LT(mp.size(), records.size() * 7 / 10);
+}
+
+TEST(Transcode, MessagePackStreaming)
+{
+    // Larger than the buffer, headers of flushed containers are patched in the sink.
+    std::string json = "{\"records\":" + makeRecords(200) + ",\"nested\":[" + makeRecords(100) + "," + makeRecords(3) + "],\"last\":1}";
+    ASSERT_GT(json.size(), (size_t)GOB_JSON_TRANSCODER_BUFFER_LENGTH * 8);
+
+    gob_json_test::LogHandler direct(gob_json_test::LogHandler::Value::Typed);
+    {
+        goblib::json::StreamingParser parser(&direct);
+        parser.parse(json.data(), json.size());
+        ASSERT_FALSE(parser.hasError());
+    }
+    auto check = [&direct](const uint8_t* mp, const size_t len)
+    {
+        EXPECT_EQ(mp[0], 0xDF); // map32 kept
+        EXPECT_EQ(mp[4], 3);
+        gob_json_test::LogHandler lh(gob_json_test::LogHandler::Value::Typed);
+        goblib::json::BinaryParser parser(BinaryFormat::MessagePack, &lh);
+        parser.parse(reinterpret_cast<const char*>(mp), len);
+        EXPECT_FALSE(parser.hasError());
+        EXPECT_EQ(lh.log, direct.log);
+    };
+
+    auto mp = transcode(BinaryFormat::MessagePack, json);
+    check(mp.data(), mp.size());
+
+    // In place in FixedBufferSink
+    std::vector<char> buf(json.size());
+    goblib::json::FixedBufferSink fsink(buf.data(), buf.size());
+    TranscodeHandler th(BinaryFormat::MessagePack, &fsink);
+    goblib::json::StreamingParser parser(&th);
+    gob_json_test::feed(parser, json, 100);
+    EXPECT_FALSE(th.hasError());
+    EXPECT_EQ(fsink.size(), mp.size());
+    check(reinterpret_cast<const uint8_t*>(fsink.data()), fsink.size());
+
+    // The sink cannot patch, the outermost container must fit in the buffer.
+    goblib::json::CallbackSink csink([](const char*, size_t, void*) { return true; });
+    TranscodeHandler th2(BinaryFormat::MessagePack, &csink);
+    goblib::json::StreamingParser parser2(&th2);
+    parser2.parse(json.data(), json.size());
+    EXPECT_TRUE(th2.hasError());
+}
@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+
+#include "gob_json_test_helper.hpp"
+#include <gob_json.hpp>
+#include <internal/gob_json_utf8.hpp>
+#include <string>
+#include <vector>
+
+using gob_json_test::LogHandler;
+using goblib::json::ElementPath;
+using goblib::json::ElementValue;
+using goblib::json::StreamingParser;
+namespace utf8 = goblib::json::utf8;
+
+// TEST(UTF8, Validator)
+namespace
+{
+const char* valid_texts[] =
+{
+    "", "ascii only text", "\xC2\x80", "\xDF\xBF", "\xE0\xA0\x80", "\xE3\x81\x82", "\xED\x9F\xBF", "\xEE\x80\x80", "\xEF\xBF\xBF",
+    "\xF0\x90\x80\x80", "\xF0\x9F\x98\x80", "\xF4\x8F\xBF\xBF", "mixed \xE3\x81\x82 text \xF0\x9F\x98\x80 long enough for words",
+};
+const char* invalid_texts[] =
+{
+    "\x80", "\xBF", "\xC0\x80", "\xC1\xBF", "\xE0\x80\x80", "\xE0\x9F\xBF", "\xED\xA0\x80", "\xED\xBF\xBF",
+    "\xF0\x80\x80\x80", "\xF0\x8F\xBF\xBF", "\xF4\x90\x80\x80", "\xF5\x80\x80\x80", "\xFF",
+    "\xE3\x81", "\xE3\x81" "a", "\xC2", "abcdefgh\xC2" "abcdefgh",
+};
+
+// Parse by the chunk, 0 means a character at a time
+std::vector<std::string> parse(const std::string& json, const bool check, const size_t chunk, bool* error)
+{
+    LogHandler lh;
+    StreamingParser parser(&lh);
+    parser.setValidateUtf8(check);
+    gob_json_test::feed(parser, json, chunk);
+    *error = parser.hasError();
+    return lh.log;
+}
+//
+}
+
+TEST(UTF8, Validator)
+{
+    for(auto s : valid_texts)
+    {
+        SCOPED_TRACE(s);
+        EXPECT_TRUE(utf8::isValid(s, strlen(s)));
+        // A byte at a time
+        utf8::Validator v;
+        bool ok = true;
+        for(auto p = s; *p; ++p) { ok &= v.step((uint8_t)*p); }
+        EXPECT_TRUE(ok && v.complete());
+    }
+    for(auto s : invalid_texts)
+    {
+        SCOPED_TRACE(s);
+        EXPECT_FALSE(utf8::isValid(s, strlen(s)));
+    }
+    // Position of the invalid byte
+    const char text[] = "abcdefghijk\xE3\x81\x82\xE3" "z";
+    utf8::Validator v;
+    EXPECT_EQ(v.validate(text, text + sizeof(text) - 1), text + 15);
+}
+
+TEST(UTF8, Parser)
+{
+    // Long string exceeds the token buffer, split sequences at chunk boundaries
+    std::string longText;
+    while(longText.size() < GOB_JSON_PARSER_BUFFER_MAX_LENGTH * 2) { longText += "\xE3\x81\x82 text \xF0\x9F\x98\x80 "; }
+    const std::string json = "{\"\xE3\x82\xAD\":\"\xE5\x80\xA4\",\"long\":\"" + longText + "\",\"esc\":\"\\u3042\\n\xC3\xA9\",\"n\":[1,2]}";
+
+    bool error{};
+    const auto expected = parse(json, false, 0, &error);
+    ASSERT_FALSE(error);
+    for(bool check : { false, true })
+    {
+        for(size_t chunk : { (size_t)0, (size_t)1, (size_t)3, (size_t)7, (size_t)64, json.size() })
+        {
+            SCOPED_TRACE(chunk);
+            EXPECT_EQ(parse(json, check, chunk, &error), expected);
+            EXPECT_FALSE(error);
+        }
+    }
+
+    // Invalid sequences are errors only if validating.
+    const std::string bad[] = {
+        "{\"a\":\"\xC0\xAF\"}",               // Overlong
+        "{\"a\":\"\xED\xA0\x80\"}",           // Surrogate
+        "{\"a\":\"\xE3\x81\"}",               // Truncated by '"'
+        "{\"\xFF\":1}",                       // In key
+        "{\"a\":\"abcdefghijklmnop\xE3\x81\\n\"}", // Truncated by escape
+    };
+    for(auto& b : bad)
+    {
+        SCOPED_TRACE(b);
+        for(size_t chunk : { (size_t)0, (size_t)1, (size_t)5, b.size() })
+        {
+            parse(b, false, chunk, &error);
+            EXPECT_FALSE(error);
+            parse(b, true, chunk, &error);
+            EXPECT_TRUE(error);
+        }
+        size_t pos{};
+        EXPECT_FALSE(StreamingParser::validate(b.data(), b.size(), &pos));
+    }
+    size_t pos{};
+    EXPECT_FALSE(StreamingParser::validate(bad[0].data(), bad[0].size(), &pos));
+    EXPECT_EQ(pos, 6U);
+    EXPECT_TRUE(StreamingParser::validate(json.data(), json.size()));
+}
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+
+#include "gob_json_test_helper.hpp"
+#include <gob_json.hpp>
+#include <string>
+#include <cstring>
+#include <utility>
+
+using goblib::json::StreamingParser;
+
+// TEST(Validate, Valid)
+namespace
+{
+bool validate(const std::string& s, size_t* pos = nullptr) { return StreamingParser::validate(s.data(), s.size(), pos); }
+
+const char* valid_docs[] =
+{
+    "{}", "[]", " \t\r\n[ ]\n", R"({"a":1})", R"([1,-1,0,-0,0.5,-0.5e10,1E+2,1e-2,123456789012345678901234567890])",
+    R"({"s":"\"\\\/\b\f\n\r\t\u0041\uD83D\uDE00","t":true,"f":false,"n":null,"o":{"a":[{}]}})",
+    R"(  {  "key"  :  [  1  ,  2  ]  ,  "k2" : { } }  )",
+    "\"top-level string\"", "123", "-0.0e0", "true", "null",
+    R"(["あいう","\u3042"])",
+    "[\"\x7f\"]", // DEL is not a control character in RFC 8259
+};
+
+// Text and the offset of the error
+const std::pair<const char*, size_t> invalid_docs[] =
+{
+    { "", 0 }, { "   ", 3 }, { "{", 1 }, { "[1,", 3 }, { "[1,]", 3 }, { "[,1]", 1 }, { "{,}", 1 },
+    { R"({"a":1,})", 7 }, { R"({"a" 1})", 5 }, { R"({"a":})", 5 }, { R"({1:2})", 1 },
+    { R"({"a":1 "b":2})", 7 }, { R"({"a":1]})", 6 }, { "[1}", 2 }, { "[1 2]", 3 },
+    { "[01]", 2 }, { "[-]", 2 }, { "[1.]", 3 }, { "[.5]", 1 }, { "[1e]", 3 }, { "[1e+]", 4 }, { "[+1]", 1 }, { "[0x10]", 2 },
+    { "[tru]", 4 }, { "[nul", 4 }, { "[True]", 1 }, { "[nan]", 2 },
+    { "[\"abc]", 6 }, { "[\"a\\x\"]", 4 }, { "[\"\\u12G4\"]", 6 }, { "[\"\\u12", 6 }, { "[\"\t\"]", 2 },
+    { "{} {}", 3 }, { "[] x", 3 }, { "1 2", 2 },
+};
+//
+}
+
+TEST(Validate, Valid)
+{
+    for(auto s : valid_docs)
+    {
+        SCOPED_TRACE(s);
+        size_t pos{};
+        EXPECT_TRUE(validate(s, &pos));
+        EXPECT_EQ(pos, strlen(s));
+    }
+
+    for(auto& t : invalid_docs)
+    {
+        SCOPED_TRACE(t.first);
+        size_t pos{};
+        EXPECT_FALSE(validate(t.first, &pos));
+        EXPECT_EQ(pos, t.second);
+    }
+    EXPECT_FALSE(StreamingParser::validate(nullptr, 0));
+
+    // Depth
+    std::string deep(GOB_JSON_PARSER_STACK_MAX_DEPTH, '[');
+    deep += std::string(GOB_JSON_PARSER_STACK_MAX_DEPTH, ']');
+    EXPECT_TRUE(validate(deep));
+    EXPECT_FALSE(validate("[" + deep + "]"));
+
+    // A key or string takes a level as well, same as parse()
+    const auto nest = [](const std::string& v, const int n) { return std::string(n, '[') + v + std::string(n, ']'); };
+    const std::pair<std::string, bool> levels[] = {
+        { nest("\"s\"", GOB_JSON_PARSER_STACK_MAX_DEPTH - 1), true },
+        { nest("\"s\"", GOB_JSON_PARSER_STACK_MAX_DEPTH), false },
+        { nest("1", GOB_JSON_PARSER_STACK_MAX_DEPTH), true },
+        { nest("{\"k\":1}", GOB_JSON_PARSER_STACK_MAX_DEPTH - 2), true },
+        { nest("{\"k\":1}", GOB_JSON_PARSER_STACK_MAX_DEPTH - 1), false },
+    };
+    for(auto& l : levels)
+    {
+        SCOPED_TRACE(l.first);
+        EXPECT_EQ(validate(l.first), l.second);
+        gob_json_test::LogHandler lh;
+        StreamingParser parser(&lh);
+        parser.parse(l.first.data(), l.first.size());
+        EXPECT_EQ(parser.hasError(), !l.second);
+    }
+}
+
+TEST(Validate, Large)
+{
+    // Long runs for the word-at-a-time paths
+    std::string s("{\n");
+    for(int i = 0; i < 200; ++i)
+    {
+        s += (i ? ",\n" : "") + std::string("        \"key") + std::to_string(i) + "\" : [ 12345678901234567890, -98765432109876.54321e-10, " +
+                "\"" + std::string(40, 'x') + "\\n\" ]";
+    }
+    s += "\n}";
+    EXPECT_TRUE(validate(s));
+    // Every truncation is invalid
+    for(size_t len = 0; len < 300; ++len)
+    {
+        EXPECT_FALSE(StreamingParser::validate(s.data(), len)) << len;
+    }
+    // Broken in the middle of the long run
+    auto pos = s.find("xxxxxxxx");
+    s[pos + 20] = '\x01';
+    size_t epos{};
+    EXPECT_FALSE(validate(s, &epos));
+    EXPECT_EQ(epos, pos + 20);
+}
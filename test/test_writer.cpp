@@ -0,0 +1,165 @@
+
+#include <gtest/gtest.h>
+
+#include <gob_json.hpp>
+#include <gob_json_writer.hpp>
+#include <cmath>
+#include <limits>
+
+using goblib::json::StreamingWriter;
+using goblib::json::FixedBufferSink;
+using goblib::json::CallbackSink;
+
+TEST(Writer, Basic)
+{
+    char out[256];
+    FixedBufferSink sink(out, sizeof(out));
+    StreamingWriter writer(&sink);
+
+    writer.beginObject()
+            .key("bool").value(true)
+            .key("null").value(nullptr)
+            .key("int").value(-123)
+            .key("uint").value(4294967295U)
+            .key("int64").value(INTMAX_C(-9223372036854775807) - 1)
+            .key("uint64").value(UINTMAX_C(18446744073709551615))
+            .key("float").value(1.1f)
+            .key("double").value(0.1)
+            .key("nan").value(std::nan(""))
+            .key("array").beginArray().value(1).beginArray().endArray().beginObject().endObject().value("A").endArray()
+            .key("string").value("あいうABC")
+            .endObject();
+
+    EXPECT_FALSE(writer.hasError());
+    EXPECT_TRUE(writer.isComplete());
+    EXPECT_EQ(writer.getDepth(), 0);
+    EXPECT_TRUE(writer.flush());
+    EXPECT_STREQ(out,
+                 R"({"bool":true,"null":null,"int":-123,"uint":4294967295,)"
+                 R"("int64":-9223372036854775808,"uint64":18446744073709551615,)"
+                 R"("float":1.1,"double":0.1,"nan":null,"array":[1,[],{},"A"],"string":"あいうABC"})");
+}
+
+TEST(Writer, Escape)
+{
+    char out[256];
+    FixedBufferSink sink(out, sizeof(out));
+    StreamingWriter writer(&sink);
+
+    writer.beginArray()
+            .value("quote\" backslash\\ slash/")
+            .value("\b\f\n\r\t\x01\x1f")
+            .value("long string without any special characters.\"")
+            .endArray();
+    EXPECT_TRUE(writer.flush());
+    EXPECT_STREQ(out,
+                 R"(["quote\" backslash\\ slash/","\b\f\n\r\t\u0001\u001f",)"
+                 R"("long string without any special characters.\""])");
+}
+
+TEST(Writer, Number)
+{
+    // Shortest text that round-trips
+    const double dv[] = { 0.0, 1.5, -2.25, 123.456, 1e-300, 1.7976931348623157e+308, 5e-324, 0.30000000000000004 };
+    for(auto& v : dv)
+    {
+        char out[64];
+        FixedBufferSink sink(out, sizeof(out));
+        StreamingWriter writer(&sink);
+        writer.beginArray().value(v).endArray();
+        EXPECT_TRUE(writer.flush());
+        EXPECT_EQ(std::strtod(out + 1, nullptr), v) << out;
+    }
+    const float fv[] = { 0.1f, -3.402823e+38f, 1.17549435e-38f, 16777216.0f };
+    for(auto& v : fv)
+    {
+        char out[64];
+        FixedBufferSink sink(out, sizeof(out));
+        StreamingWriter writer(&sink);
+        writer.beginArray().value(v).endArray();
+        EXPECT_TRUE(writer.flush());
+        EXPECT_EQ(std::strtof(out + 1, nullptr), v) << out;
+    }
+
+    char out[64];
+    FixedBufferSink sink(out, sizeof(out));
+    StreamingWriter writer(&sink);
+    writer.beginArray().value(0.1).value(0.1f).value(100.0).value(-0.5f).endArray();
+    EXPECT_TRUE(writer.flush());
+    EXPECT_STREQ(out, "[0.1,0.1,100,-0.5]");
+}
+
+TEST(Writer, Flush)
+{
+    // Output larger than inner buffer.
+    std::string out;
+    CallbackSink sink([](const char* buf, size_t len, void* arg)
+    {
+        static_cast<std::string*>(arg)->append(buf, len);
+        return true;
+    }, &out);
+    StreamingWriter writer(&sink);
+
+    std::string expected("[");
+    writer.beginArray();
+    for(int i = 0; i < 1000; ++i)
+    {
+        writer.value(i);
+        expected += std::to_string(i);
+        expected += (i < 999) ? "," : "";
+    }
+    std::string ls(GOB_JSON_WRITER_BUFFER_LENGTH * 3, 'x');
+    writer.value(ls);
+    expected += ",\"" + ls + "\"]";
+    writer.endArray();
+    EXPECT_TRUE(writer.flush());
+    EXPECT_FALSE(writer.hasError());
+    EXPECT_EQ(writer.getWrittenSize(), expected.size());
+    EXPECT_EQ(out, expected);
+
+    // Sink is full
+    char small[8];
+    FixedBufferSink ssink(small, sizeof(small));
+    StreamingWriter w2(&ssink);
+    w2.beginArray().value(ls).endArray();
+    EXPECT_FALSE(w2.flush());
+    EXPECT_TRUE(w2.hasError());
+}
+
+TEST(Writer, Error)
+{
+    char out[256];
+    FixedBufferSink sink(out, sizeof(out));
+    {
+        StreamingWriter writer(&sink);
+        writer.beginObject().value(1);  // Value without key
+        EXPECT_TRUE(writer.hasError());
+    }
+    {
+        StreamingWriter writer(&sink);
+        writer.beginArray().key("k");  // Key in array
+        EXPECT_TRUE(writer.hasError());
+    }
+    {
+        StreamingWriter writer(&sink);
+        writer.beginArray().endObject();  // Mismatch
+        EXPECT_TRUE(writer.hasError());
+    }
+    {
+        StreamingWriter writer(&sink);
+        writer.beginObject().key("k").endObject();  // Missing value
+        EXPECT_TRUE(writer.hasError());
+    }
+    {
+        StreamingWriter writer(&sink);
+        writer.beginArray().endArray().beginArray();  // Second document
+        EXPECT_TRUE(writer.hasError());
+    }
+    {
+        StreamingWriter writer(&sink);
+        for(int i = 0; i < GOB_JSON_PARSER_STACK_MAX_DEPTH; ++i) { writer.beginArray(); }
+        EXPECT_FALSE(writer.hasError());
+        writer.beginArray(); // Too deep
+        EXPECT_TRUE(writer.hasError());
+    }
+}
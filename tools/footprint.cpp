@@ -0,0 +1,134 @@
+/*
+  Footprint report and recommendation of the capacity macros.
+
+  pio run -e native_footprint
+  .pio/build/native_footprint/program sample1.json sample2.json ...
+
+  1. sizeof breakdown of StreamingParser and ElementPath in this build
+  2. High-water marks of token buffer, key and depth over the documents (GOB_JSON_STATS)
+  3. Truncation counts
+  4. Recommended GOB_JSON_PARSER_BUFFER_MAX_LENGTH / KEY_MAX_LENGTH / STACK_MAX_DEPTH and the size with them
+
+  Build with large capacities (see native_footprint env) so that the measurement is not clipped.
+ */
+#include <gob_json.hpp>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+#if !GOB_JSON_STATS
+# error "Build with GOB_JSON_STATS=1"
+#endif
+
+using goblib::json::ElementPath;
+using goblib::json::ElementSelector;
+using goblib::json::ElementValue;
+using goblib::json::ParserStats;
+using goblib::json::StreamingParser;
+
+namespace
+{
+// Access to the members for sizeof.
+struct Probe : public StreamingParser
+{
+    static void report()
+    {
+        const size_t total = sizeof(StreamingParser);
+        const size_t parts[] =
+        {
+            sizeof(buffer), sizeof(stack), sizeof(path), sizeof(elementValue),
+            sizeof(unicodeEscapeBuffer) + sizeof(unicodeBuffer), sizeof(numberSinks), sizeof(stats),
+        };
+        const char* names[] =
+        {
+            "buffer (BUFFER_MAX_LENGTH)", "stack (STACK_MAX_DEPTH)", "path (KEY_MAX_LENGTH x STACK_MAX_DEPTH)",
+            "elementValue", "unicode buffers", "numberSinks (NUMBER_SINK_MAX)", "stats (GOB_JSON_STATS only)",
+        };
+        size_t sum{};
+        std::printf("sizeof(StreamingParser) = %zu\n", total);
+        for(size_t i = 0; i < sizeof(parts) / sizeof(parts[0]); ++i)
+        {
+            std::printf("  %-42s %6zu\n", names[i], parts[i]);
+            sum += parts[i];
+        }
+        std::printf("  %-42s %6zu\n", "others", total - sum);
+        std::printf("sizeof(ElementPath)     = %zu (ElementSelector %zu x %d)\n",
+                    sizeof(ElementPath), sizeof(ElementSelector), GOB_JSON_PARSER_STACK_MAX_DEPTH);
+    }
+
+    // Estimated size with other capacities. (Without stats, approximate by padding)
+    static size_t estimate(const size_t bufLen, const size_t keyLen, const size_t depth)
+    {
+        auto align = [](size_t v, size_t a) { return (v + a - 1) / a * a; };
+        const size_t selector = align(sizeof(int) + keyLen, alignof(ElementSelector));
+        const size_t pathSize = align(sizeof(ElementPath) - sizeof(ElementSelector) * GOB_JSON_PARSER_STACK_MAX_DEPTH
+                                      + selector * depth, alignof(ElementPath));
+        const size_t fixed = sizeof(StreamingParser) - sizeof(buffer) - sizeof(stack) - sizeof(path) - sizeof(stats);
+        return align(fixed + bufLen + depth * sizeof(Stack) + pathSize, alignof(StreamingParser));
+    }
+};
+
+struct NullHandler : public goblib::json::Handler
+{
+    virtual void startDocument() override {}
+    virtual void endDocument() override {}
+    virtual void startObject(const ElementPath& ) override {}
+    virtual void endObject(const ElementPath& ) override {}
+    virtual void startArray(const ElementPath& ) override {}
+    virtual void endArray(const ElementPath& ) override {}
+    virtual void value(const ElementPath& , const ElementValue& ) override {}
+    virtual void whitespace(const char) override {}
+};
+//
+}
+
+int main(int argc, char* argv[])
+{
+    std::printf("== Footprint (BUFFER=%d KEY=%d DEPTH=%d)\n",
+                GOB_JSON_PARSER_BUFFER_MAX_LENGTH, GOB_JSON_PARSER_KEY_MAX_LENGTH, GOB_JSON_PARSER_STACK_MAX_DEPTH);
+    Probe::report();
+    if(argc < 2) { return 0; }
+
+    NullHandler handler;
+    StreamingParser parser(&handler);
+    parser.setRecursively(true);
+    int buf{}, key{}, depth{};
+    uint32_t truncTokens{}, truncKeys{};
+
+    std::printf("\n== High-water marks\n%-32s %8s %6s %6s %6s %6s\n", "file", "bytes", "token", "key", "depth", "trunc");
+    for(int i = 1; i < argc; ++i)
+    {
+        FILE* fp = std::fopen(argv[i], "rb");
+        if(!fp) { std::fprintf(stderr, "Failed to open %s\n", argv[i]); continue; }
+        parser.reset();
+        parser.resetStats();
+        char chunk[4096];
+        size_t sz, total{};
+        while((sz = std::fread(chunk, 1, sizeof(chunk), fp)) > 0) { parser.parse(chunk, sz); total += sz; }
+        std::fclose(fp);
+
+        auto& st = parser.getStats();
+        std::printf("%-32s %8zu %6d %6d %6d %6u%s\n", argv[i], total, st.bufferHighWater, st.keyHighWater,
+                    st.depthHighWater, st.truncatedTokens + st.truncatedKeys, parser.hasError() ? " (parse error)" : "");
+        buf = std::max(buf, st.bufferHighWater);
+        key = std::max(key, st.keyHighWater);
+        depth = std::max(depth, st.depthHighWater);
+        truncTokens += st.truncatedTokens;
+        truncKeys += st.truncatedKeys;
+    }
+    if(truncTokens || truncKeys)
+    {
+        std::printf("\nWarning: %u tokens and %u keys were truncated in this build. Increase the capacities and measure again.\n",
+                    truncTokens, truncKeys);
+    }
+
+    // Room for the terminator.
+    const int rbuf = buf + 1, rkey = key + 1, rdepth = std::max(depth, 1);
+    std::printf("\n== Recommendation\n");
+    std::printf("-D GOB_JSON_PARSER_BUFFER_MAX_LENGTH=%d\n", rbuf);
+    std::printf("-D GOB_JSON_PARSER_KEY_MAX_LENGTH=%d\n", rkey);
+    std::printf("-D GOB_JSON_PARSER_STACK_MAX_DEPTH=%d\n", rdepth);
+    std::printf("Estimated sizeof(StreamingParser): about %zu (default 256/32/20: about %zu)\n",
+                Probe::estimate(rbuf, rkey, rdepth), Probe::estimate(256, 32, 20));
+    return 0;
+}
@@ -0,0 +1,381 @@
+/*
+  Instruction count regression suite. (Linux)
+
+  pio run -e native_icount
+  .pio/build/native_icount/program [--baseline=FILE] [--update] [--threshold=PCT] [--iterations=N]
+
+  Each component runs over a fixed synthetic corpus and is measured by perf_event_open (user space only).
+  - tokenize : strings and literals (scanning, escapes)
+  - number   : integers and floats with conversion (getInt/getFloat)
+  - path     : nested objects with keys (ElementPath maintenance)
+  - records  : records with a null handler
+  - element  : same records bound to Element table (element_store = element - records)
+
+  Reports instructions/byte, branch misses and cache misses per KiB.
+  With --baseline, instructions/byte are compared with the file, and exits with 1 if any exceeds the threshold.
+  --update writes the results to the baseline file.
+
+  When perf_event_open is not available (container, perf_event_paranoid), ticks are measured instead.
+  Ticks are not deterministic, so they are only reported; --baseline is refused (exit 2).
+  Under valgrind, the components are separated by CALLGRIND_DUMP_STATS_AT if valgrind/callgrind.h exists.
+  valgrind --tool=callgrind --collect-atstart=no .pio/build/native_icount/program --iterations=1
+ */
+#include <gob_json.hpp>
+#include <gob_json_element.hpp>
+#include <internal/gob_json_stats.hpp>
+#include "../bench/bench_common.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cinttypes>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#if defined(__linux__)
+# include <linux/perf_event.h>
+# include <sys/ioctl.h>
+# include <sys/syscall.h>
+# include <unistd.h>
+# define ICOUNT_PERF 1
+#else
+# define ICOUNT_PERF 0
+#endif
+
+#if defined(__has_include)
+# if __has_include(<valgrind/callgrind.h>)
+#   include <valgrind/callgrind.h>
+#   define ICOUNT_CALLGRIND 1
+# endif
+#endif
+
+using goblib::json::ElementPath;
+using goblib::json::ElementValue;
+using goblib::json::Element;
+using goblib::json::ElementBase;
+
+namespace
+{
+// ----------------------------------------------------------------------------
+// Counters
+enum Counter : int { Instructions, BranchMisses, CacheMisses, CounterMax };
+
+class Counters
+{
+  public:
+    Counters()
+    {
+#if ICOUNT_PERF
+        const uint64_t configs[CounterMax] =
+        {
+            PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_HW_CACHE_MISSES,
+        };
+        for(int i = 0; i < CounterMax; ++i)
+        {
+            perf_event_attr attr{};
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = configs[i];
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            _fd[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+            if(_fd[i] < 0 && i == Instructions)
+            {
+                std::fprintf(stderr, "perf_event_open unavailable (%s), measure ticks instead\n", std::strerror(errno));
+                return;
+            }
+        }
+#endif
+    }
+    ~Counters()
+    {
+#if ICOUNT_PERF
+        for(auto fd : _fd) { if(fd >= 0) { close(fd); } }
+#endif
+    }
+
+    // Instruction counts available? (Otherwise ticks)
+    bool available() const { return _fd[Instructions] >= 0; }
+    bool available(const Counter c) const { return _fd[c] >= 0; }
+    const char* kind() const { return available() ? "instructions" : "ticks"; }
+
+    void start()
+    {
+#if ICOUNT_PERF
+        for(auto fd : _fd) { if(fd >= 0) { ioctl(fd, PERF_EVENT_IOC_RESET, 0); ioctl(fd, PERF_EVENT_IOC_ENABLE, 0); } }
+#endif
+        _tick = goblib::json::stats::ticks();
+    }
+    void stop(uint64_t (&v)[CounterMax])
+    {
+        const auto tick = goblib::json::stats::ticks();
+#if ICOUNT_PERF
+        for(int i = 0; i < CounterMax; ++i)
+        {
+            v[i] = 0;
+            if(_fd[i] < 0) { continue; }
+            ioctl(_fd[i], PERF_EVENT_IOC_DISABLE, 0);
+            if(read(_fd[i], &v[i], sizeof(v[i])) != sizeof(v[i])) { v[i] = 0; }
+        }
+#endif
+        if(!available()) { v[Instructions] = goblib::json::stats::elapsed(_tick, tick); }
+    }
+
+  private:
+    int _fd[CounterMax]{-1, -1, -1};
+    goblib::json::stats::tick_t _tick{};
+};
+
+// ----------------------------------------------------------------------------
+// Corpora (Fixed, do not change without updating the baseline)
+constexpr size_t CORPUS_SIZE = 256 * 1024;
+
+std::string makeTokens()
+{
+    std::string s("[");
+    for(unsigned i = 0; s.size() < CORPUS_SIZE; ++i)
+    {
+        s += i ? "," : "";
+        switch(i % 4)
+        {
+        case 0: s += R"("The quick brown fox jumps over the lazy dog")"; break;
+        case 1: s += R"("escaped \"quote\" and \\ back\/slash\n\t")"; break;
+        case 2: s += "true,false"; break;
+        default: s += "null"; break;
+        }
+    }
+    return s + "]";
+}
+
+std::string makeNumbers()
+{
+    std::string s("[");
+    for(unsigned i = 0; s.size() < CORPUS_SIZE; ++i)
+    {
+        s += i ? "," : "";
+        switch(i % 4)
+        {
+        case 0: s += std::to_string(i * 7919u); break;
+        case 1: s += "-" + std::to_string(i); break;
+        case 2: s += std::to_string(i % 1000) + ".125"; break;
+        default: s += "1.5e-" + std::to_string(i % 30); break;
+        }
+    }
+    return s + "]";
+}
+
+std::string makePaths()
+{
+    std::string s("[");
+    for(unsigned i = 0; s.size() < CORPUS_SIZE; ++i)
+    {
+        s += i ? "," : "";
+        s += R"({"alpha":{"beta":{"gamma":{"delta":1,"epsilon":2},"zeta":[3,{"eta":4}]},"theta":5},"iota":6})";
+    }
+    return s + "]";
+}
+
+// ----------------------------------------------------------------------------
+// Handlers
+struct NumberHandler : public bench::NullHandler
+{
+    virtual void value(const ElementPath& , const ElementValue& v) override
+    {
+        if(v.isInt()) { isum += v.getInt(); }
+        else if(v.isFloat()) { fsum += v.getFloat(); }
+    }
+    int64_t isum{};
+    double fsum{};
+};
+
+struct ElementHandler : public bench::NullHandler
+{
+    virtual void value(const ElementPath& path, const ElementValue& value) override
+    {
+        Element<decltype(id)>     e_id     { "id", &id };
+        Element<decltype(name)>   e_name   { "name", &name };
+        Element<decltype(price)>  e_price  { "price", &price };
+        Element<decltype(tags)>   e_tags   { "tags", &tags };
+        Element<decltype(active)> e_active { "active", &active };
+        ElementBase* tbl[] = { &e_id, &e_name, &e_price, &e_tags, &e_active };
+        const char* key = path.getIndex() < 0 ? path.getKey() : (path.getParent() ? path.getParent()->getKey() : "");
+        for(auto& e : tbl) { if(*e == key) { e->store(value, path.getIndex()); return; } }
+    }
+    uint64_t id{};
+    char name[16]{};
+    float price{};
+    char tags[2][4]{};
+    bool active{};
+};
+
+// ----------------------------------------------------------------------------
+struct Result
+{
+    std::string name;
+    size_t bytes;
+    uint64_t v[CounterMax];
+    double perByte() const { return bytes ? static_cast<double>(v[Instructions]) / bytes : 0.0; }
+    double perKiB(const Counter c) const { return bytes ? v[c] * 1024.0 / bytes : 0.0; }
+};
+
+template<class H> Result measure(Counters& counters, const char* name, const std::string& json, const int iterations)
+{
+    Result r{name, json.size(), {}};
+    for(int i = 0; i < iterations; ++i)
+    {
+        H handler;
+        goblib::json::StreamingParser parser(&handler);
+        uint64_t v[CounterMax];
+#if defined(ICOUNT_CALLGRIND)
+        CALLGRIND_ZERO_STATS;
+        CALLGRIND_TOGGLE_COLLECT;
+#endif
+        counters.start();
+        parser.parse(json.data(), json.size());
+        counters.stop(v);
+#if defined(ICOUNT_CALLGRIND)
+        CALLGRIND_TOGGLE_COLLECT;
+        CALLGRIND_DUMP_STATS_AT(name);
+#endif
+        if(parser.hasError()) { std::fprintf(stderr, "%s: parse error\n", name); std::exit(2); }
+        // Minimum of the iterations (Warm caches)
+        for(int c = 0; c < CounterMax; ++c) { r.v[c] = i ? std::min(r.v[c], v[c]) : v[c]; }
+    }
+    return r;
+}
+
+// Baseline: "kind name per_byte" per line, '#' is comment.
+struct Baseline { std::string kind, name; double perByte; };
+
+std::vector<Baseline> loadBaseline(const char* path)
+{
+    std::vector<Baseline> v;
+    FILE* fp = std::fopen(path, "r");
+    if(!fp) { return v; }
+    char line[256], kind[32], name[64];
+    double pb;
+    while(std::fgets(line, sizeof(line), fp))
+    {
+        if(line[0] == '#') { continue; }
+        if(std::sscanf(line, "%31s %63s %lf", kind, name, &pb) == 3) { v.push_back(Baseline{kind, name, pb}); }
+    }
+    std::fclose(fp);
+    return v;
+}
+
+bool saveBaseline(const char* path, const char* kind, const std::vector<Result>& results)
+{
+    FILE* fp = std::fopen(path, "w");
+    if(!fp) { return false; }
+    std::fprintf(fp, "# kind component per_byte (tools/icount.cpp --update)\n");
+    for(auto& r : results) { std::fprintf(fp, "%s %s %.4f\n", kind, r.name.c_str(), r.perByte()); }
+    return std::fclose(fp) == 0;
+}
+
+const char* optionValue(const char* arg, const char* name)
+{
+    const size_t len = std::strlen(name);
+    return (std::strncmp(arg, name, len) == 0 && arg[len] == '=') ? arg + len + 1 : nullptr;
+}
+//
+}
+
+int main(int argc, char* argv[])
+{
+    const char* baseline{};
+    bool update{};
+    double threshold{2.0};
+    int iterations{5};
+    for(int i = 1; i < argc; ++i)
+    {
+        const char* v;
+        if((v = optionValue(argv[i], "--baseline"))) { baseline = v; }
+        else if((v = optionValue(argv[i], "--threshold"))) { threshold = std::atof(v); }
+        else if((v = optionValue(argv[i], "--iterations"))) { iterations = std::max(1, std::atoi(v)); }
+        else if(std::strcmp(argv[i], "--update") == 0) { update = true; }
+        else
+        {
+            std::fprintf(stderr, "Usage: %s [--baseline=FILE] [--update] [--threshold=PCT] [--iterations=N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    Counters counters;
+    const std::string tokens = makeTokens(), numbers = makeNumbers(), paths = makePaths();
+    const std::string records = bench::makeRecords(CORPUS_SIZE);
+
+    std::vector<Result> results;
+    results.push_back(measure<bench::NullHandler>(counters, "tokenize", tokens, iterations));
+    results.push_back(measure<NumberHandler>(counters, "number", numbers, iterations));
+    results.push_back(measure<bench::NullHandler>(counters, "path", paths, iterations));
+    results.push_back(measure<bench::NullHandler>(counters, "records", records, iterations));
+    results.push_back(measure<ElementHandler>(counters, "element", records, iterations));
+    {
+        Result store = results.back();
+        store.name = "element_store";
+        for(int c = 0; c < CounterMax; ++c)
+        {
+            const auto raw = results[results.size() - 2].v[c];
+            store.v[c] = store.v[c] > raw ? store.v[c] - raw : 0;
+        }
+        results.push_back(store);
+    }
+
+    const bool perf = counters.available();
+    std::printf("%-14s %10s %14s %14s %14s\n", "component", "bytes",
+                perf ? "instr/byte" : "ticks/byte", "br-miss/KiB", "cache-miss/KiB");
+    for(auto& r : results)
+    {
+        char br[32] = "-", cm[32] = "-";
+        if(counters.available(BranchMisses)) { snprintf(br, sizeof(br), "%.2f", r.perKiB(BranchMisses)); }
+        if(counters.available(CacheMisses)) { snprintf(cm, sizeof(cm), "%.2f", r.perKiB(CacheMisses)); }
+        std::printf("%-14s %10zu %14.3f %14s %14s\n", r.name.c_str(), r.bytes, r.perByte(), br, cm);
+    }
+
+    if(!baseline) { return 0; }
+    if(!perf)
+    {
+        std::fprintf(stderr, "Ticks are not deterministic, report only. (--baseline needs instruction counts)\n");
+        return 2;
+    }
+    if(update)
+    {
+        if(!saveBaseline(baseline, counters.kind(), results))
+        {
+            std::fprintf(stderr, "Failed to write %s\n", baseline);
+            return 2;
+        }
+        std::printf("Baseline updated: %s (%s)\n", baseline, counters.kind());
+        return 0;
+    }
+
+    auto base = loadBaseline(baseline);
+    if(base.empty())
+    {
+        std::fprintf(stderr, "No baseline in %s\n", baseline);
+        return 2;
+    }
+    int regressions{}, compared{};
+    std::printf("\nCompare with %s (threshold %.2f%%)\n", baseline, threshold);
+    for(auto& r : results)
+    {
+        auto it = std::find_if(base.begin(), base.end(), [&](const Baseline& b)
+        {
+            return b.kind == counters.kind() && b.name == r.name;
+        });
+        if(it == base.end() || it->perByte <= 0.0) { continue; }
+        ++compared;
+        const double diff = (r.perByte() / it->perByte - 1.0) * 100.0;
+        const bool bad = diff > threshold;
+        regressions += bad;
+        std::printf("%-14s %14.3f -> %14.3f %+7.2f%% %s\n", r.name.c_str(), it->perByte, r.perByte(), diff, bad ? "REGRESSION" : "ok");
+    }
+    if(!compared)
+    {
+        std::printf("No %s baseline to compare, skipped.\n", counters.kind());
+        return 0;
+    }
+    return regressions ? 1 : 0;
+}